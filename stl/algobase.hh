@@ -5,11 +5,13 @@
 #ifndef MINISTL_ALGOBASE_HH
 #define MINISTL_ALGOBASE_HH
 
-#include <utility>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 
 #include "construct.hh"
 #include "iterator.hh"
+#include "type_traits.hh"
 
 namespace stl
 {
@@ -41,14 +43,76 @@ namespace stl
     }
 
     /* Modifying sequence operations */
+
+    // 源与目的都是同一类型的指针，并且该类型是平凡可复制的，可以按字节复制
+    // 只看赋值是否平凡不够：自定义了复制构造或析构的类型按字节复制属于未定义行为
     template <typename InputIt, typename OutputIt>
-    OutputIt copy(InputIt first, InputIt last, OutputIt d_first)
+    struct is_memmove_copyable
+    {
+        using type = __false_type;
+    };
+
+    template <typename T>
+    struct is_memmove_copyable<T *, T *>
+    {
+        using type = typename bool_type<std::is_trivially_copyable<T>::value>::type;
+    };
+
+    template <typename T>
+    struct is_memmove_copyable<const T *, T *>
+    {
+        using type = typename bool_type<std::is_trivially_copyable<T>::value>::type;
+    };
+
+    // 目的是指针，并且填充的值与元素同一类型、平凡可复制且复制赋值是平凡的，可以按字节填充
+    template <typename OutputIt, typename T>
+    struct is_memset_fillable
+    {
+        using type = __false_type;
+    };
+
+    template <typename T>
+    struct is_memset_fillable<T *, T>
+    {
+        using type = typename bool_type<std::is_trivially_copyable<T>::value &&
+                                        std::is_trivially_copy_assignable<T>::value>::type;
+    };
+
+    // value的每个字节都相同时取得该字节，此时可以用memset填充
+    template <typename T>
+    inline bool uniform_byte(const T &value, unsigned char &byte)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(&value);
+        for (std::size_t i = 1; i < sizeof(T); ++i)
+            if (p[i] != p[0])
+                return false;
+        byte = p[0];
+        return true;
+    }
+
+    template <typename InputIt, typename OutputIt>
+    inline OutputIt copy_aux(InputIt first, InputIt last, OutputIt d_first, __false_type)
     {
         while (first != last)
             *d_first++ = *first++;
         return d_first;
     }
 
+    template <typename InputIt, typename T>
+    inline T *copy_aux(InputIt first, InputIt last, T *d_first, __true_type)
+    {
+        const std::ptrdiff_t n = last - first;
+        if (n > 0)
+            memmove(d_first, first, n * sizeof(T));
+        return d_first + n;
+    }
+
+    template <typename InputIt, typename OutputIt>
+    OutputIt copy(InputIt first, InputIt last, OutputIt d_first)
+    {
+        return copy_aux(first, last, d_first, typename is_memmove_copyable<InputIt, OutputIt>::type());
+    }
+
     template <typename InputIt, typename OutputIt, typename UnaryPredictate>
     OutputIt copy(InputIt first, InputIt last, OutputIt d_first, UnaryPredictate pred)
     {
@@ -65,40 +129,97 @@ namespace stl
     }
 
     template <typename BidirIt1, typename BidirIt2>
-    BidirIt2 copy_backward(BidirIt1 first, BidirIt1 last, BidirIt2 d_last)
+    inline BidirIt2 copy_backward_aux(BidirIt1 first, BidirIt1 last, BidirIt2 d_last, __false_type)
     {
-        while (--last >= first)
-        {
-            --d_last;
-            stl::construct(&*d_last, *last);
-        }
-
+        while (first != last)
+            *--d_last = *--last;
         return d_last;
     }
 
+    template <typename BidirIt1, typename T>
+    inline T *copy_backward_aux(BidirIt1 first, BidirIt1 last, T *d_last, __true_type)
+    {
+        const std::ptrdiff_t n = last - first;
+        if (n > 0)
+            memmove(d_last - n, first, n * sizeof(T));
+        return d_last - n;
+    }
+
+    // 从后向前把[first, last)赋值到以d_last结尾的区间，目的区间可以与源区间的后半部分重叠
+    template <typename BidirIt1, typename BidirIt2>
+    BidirIt2 copy_backward(BidirIt1 first, BidirIt1 last, BidirIt2 d_last)
+    {
+        return copy_backward_aux(first, last, d_last, typename is_memmove_copyable<BidirIt1, BidirIt2>::type());
+    }
+
     template <typename InputIt, typename Size, typename OutputIt>
-    OutputIt copy_n(InputIt first, Size count, OutputIt result)
+    inline OutputIt copy_n_aux(InputIt first, Size count, OutputIt result, __false_type)
     {
         while (count--)
             *result++ = *first++;
         return result;
     }
 
+    template <typename InputIt, typename Size, typename T>
+    inline T *copy_n_aux(InputIt first, Size count, T *result, __true_type)
+    {
+        if (count <= 0)
+            return result;
+        return copy_aux(first, first + count, result, __true_type());
+    }
+
+    template <typename InputIt, typename Size, typename OutputIt>
+    OutputIt copy_n(InputIt first, Size count, OutputIt result)
+    {
+        return copy_n_aux(first, count, result, typename is_memmove_copyable<InputIt, OutputIt>::type());
+    }
+
     template <typename ForwardIt, typename T>
-    void fill(ForwardIt first, ForwardIt last, const T &value)
+    inline void fill_aux(ForwardIt first, ForwardIt last, const T &value, __false_type)
     {
         while (first != last)
             *first++ = value;
     }
 
+    template <typename T>
+    inline void fill_aux(T *first, T *last, const T &value, __true_type)
+    {
+        unsigned char byte;
+        if (first != last && uniform_byte(value, byte))
+            memset(first, byte, (last - first) * sizeof(T));
+        else
+            fill_aux(first, last, value, __false_type());
+    }
+
+    template <typename ForwardIt, typename T>
+    void fill(ForwardIt first, ForwardIt last, const T &value)
+    {
+        fill_aux(first, last, value, typename is_memset_fillable<ForwardIt, T>::type());
+    }
+
     template <typename OutputIt, typename Size, typename T>
-    OutputIt fill_n(OutputIt first, Size count, const T &value)
+    inline OutputIt fill_n_aux(OutputIt first, Size count, const T &value, __false_type)
     {
         while (count--)
             *first++ = value;
         return first;
     }
 
+    template <typename T, typename Size>
+    inline T *fill_n_aux(T *first, Size count, const T &value, __true_type)
+    {
+        if (count <= 0)
+            return first;
+        fill_aux(first, first + count, value, __true_type());
+        return first + count;
+    }
+
+    template <typename OutputIt, typename Size, typename T>
+    OutputIt fill_n(OutputIt first, Size count, const T &value)
+    {
+        return fill_n_aux(first, count, value, typename is_memset_fillable<OutputIt, T>::type());
+    }
+
     template <class T>
     void swap(T &a, T &b) noexcept
     {
@@ -5,35 +5,238 @@
 #ifndef MINISTL_ALLOC_HH
 #define MINISTL_ALLOC_HH
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <exception>
 #include <cstring>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace stl
 {
+    // 配置器是否提供按指定对齐分配的allocate(n, align)与deallocate(p, n, align)
+    template<typename Alloc, typename = void>
+    struct has_aligned_allocate : std::false_type
+    {
+    };
+
+    template<typename Alloc>
+    struct has_aligned_allocate<Alloc, std::void_t<decltype(std::declval<Alloc &>().allocate(size_t(), size_t()))>>
+        : std::true_type
+    {
+    };
+
+    // 按align对齐分配，配置器不支持对齐分配时退化为普通的allocate，由配置器自身保证对齐
+    template<typename Alloc>
+    void *allocate_aligned(Alloc &a, size_t n, size_t align)
+    {
+        if constexpr (has_aligned_allocate<Alloc>::value)
+            return a.allocate(n, align);
+        else
+            return a.allocate(n);
+    }
+
+    template<typename Alloc>
+    void deallocate_aligned(Alloc &a, void *p, size_t n, size_t align)
+    {
+        if constexpr (has_aligned_allocate<Alloc>::value)
+            a.deallocate(p, n, align);
+        else
+            a.deallocate(p, n);
+    }
+
+    // 配置器是否提供成批分配与回收的allocate_batch(n, count)与deallocate_batch(first, n, count)
+    template<typename Alloc, typename = void>
+    struct has_batch_allocate : std::false_type
+    {
+    };
+
+    template<typename Alloc>
+    struct has_batch_allocate<Alloc, std::void_t<decltype(std::declval<Alloc &>().allocate_batch(size_t(), size_t()))>>
+        : std::true_type
+    {
+    };
+
+    // 配置器是否提供保留内容、可能就地扩展的reallocate(p, old_sz, new_sz)
+    template<typename Alloc, typename = void>
+    struct has_reallocate : std::false_type
+    {
+    };
+
+    template<typename Alloc>
+    struct has_reallocate<Alloc, std::void_t<decltype(std::declval<Alloc &>().reallocate(nullptr, size_t(), size_t()))>>
+        : std::true_type
+    {
+    };
+
+    /*
+     * 容器与配置器之间的接口，把以字节为单位的配置器包装成以元素个数为单位
+     * 配置器既可以只有静态成员（如Default_alloc），也可以是持有状态的实例（如polymorphic_alloc），
+     * 两者都通过配置器实例调用，因此容器继承simple_alloc以保存配置器实例，
+     * 配置器为空类时借助空基类优化，容器的大小不变
+     * 分配总是按alignof(T)对齐，需要更大的对齐时使用Aligned_alloc
+     * */
     template<typename T, typename Alloc>
-    class simple_alloc
+    class simple_alloc : private Alloc
     {
     public:
-        static T *allocate(size_t n)
+        simple_alloc() = default;
+
+        simple_alloc(const Alloc &a) : Alloc(a) {}
+
+        // 同一配置器为其他类型服务的simple_alloc
+        template<typename U>
+        simple_alloc(const simple_alloc<U, Alloc> &other) : Alloc(other.get_alloc()) {}
+
+        T *allocate(size_t n)
+        {
+            return n ? (T *) allocate_aligned(get_alloc(), n * sizeof(T), alignof(T)) : nullptr;
+        }
+
+        T *allocate()
+        {
+            return (T *) allocate_aligned(get_alloc(), sizeof(T), alignof(T));
+        }
+
+        void deallocate(T *p, size_t n)
+        {
+            deallocate_aligned(get_alloc(), p, n * sizeof(T), alignof(T));
+        }
+
+        void deallocate(T *p)
+        {
+            deallocate_aligned(get_alloc(), p, sizeof(T), alignof(T));
+        }
+
+        // 把n个元素的区块调整为new_n个，保留前面的内容，只能用于可以按字节搬移的T
+        // 配置器提供reallocate时交给它，可能就地扩展；大的区块由realloc通过mremap重新映射页面，不必复制
+        T *reallocate(T *p, size_t n, size_t new_n)
+        {
+            if (!p)
+                return allocate(new_n);
+            if (!new_n)
+            {
+                deallocate(p, n);
+                return nullptr;
+            }
+            if constexpr (has_reallocate<Alloc>::value && alignof(T) <= alignof(T *))
+                return (T *) get_alloc().reallocate(p, n * sizeof(T), new_n * sizeof(T));
+
+            T *new_p = allocate(new_n);
+            memcpy(static_cast<void *>(new_p), static_cast<const void *>(p), (n < new_n ? n : new_n) * sizeof(T));
+            deallocate(p, n);
+            return new_p;
+        }
+
+        // 成批分配的区块以起始处的指针串成链表，节点在构造元素之前由batch_link取得下一个
+        static T *&batch_link(T *p)
+        {
+            static_assert(sizeof(T) >= sizeof(T *), "node too small to be linked");
+            return *reinterpret_cast<T **>(p);
+        }
+
+        // 一次分配n个节点，返回由batch_link串起的链表
+        // 配置器不支持成批分配，或者T要求超过指针的对齐时逐个分配
+        T *allocate_batch(size_t n)
+        {
+            if (!n)
+                return nullptr;
+            if constexpr (has_batch_allocate<Alloc>::value && alignof(T) <= alignof(T *))
+                return (T *) get_alloc().allocate_batch(sizeof(T), n);
+
+            T *first = nullptr;
+            while (n--)
+            {
+                T *p = allocate();
+                batch_link(p) = first;
+                first = p;
+            }
+            return first;
+        }
+
+        // 回收由batch_link串起的n个节点，节点中的元素已经析构
+        void deallocate_batch(T *first, size_t n)
+        {
+            if constexpr (has_batch_allocate<Alloc>::value && alignof(T) <= alignof(T *))
+            {
+                if (n)
+                    get_alloc().deallocate_batch(first, sizeof(T), n);
+                return;
+            }
+
+            while (n--)
+            {
+                T *next = batch_link(first);
+                deallocate(first);
+                first = next;
+            }
+        }
+
+        Alloc &get_alloc() noexcept
         {
-            return n ? (T *) Alloc::allocate(n * sizeof(T)) : nullptr;
+            return *this;
         }
 
-        static T *allocate()
+        const Alloc &get_alloc() const noexcept
+        {
+            return *this;
+        }
+    };
+
+
+    /*
+     * 一串尚未构造元素的节点
+     * 容器插入一段区间时先成批分配，再逐个取用，用完之后退化为逐个分配；
+     * 销毁大量节点时把它们逐个放回，析构时成批归还配置器
+     * */
+    template<typename T, typename Alloc>
+    class node_batch
+    {
+    private:
+        using allocator = simple_alloc<T, Alloc>;
+
+        allocator &node_alloc;
+        T *head;
+        size_t count;
+
+    public:
+        node_batch(allocator &a, size_t n) : node_alloc(a), head(a.allocate_batch(n)), count(n) {}
+
+        node_batch(const node_batch &) = delete;
+
+        node_batch &operator=(const node_batch &) = delete;
+
+        ~node_batch()
         {
-            return (T *) Alloc::allocate(sizeof(T));
+            node_alloc.deallocate_batch(head, count);
         }
 
-        static void deallocate(T *p, size_t n)
+        T *take()
         {
-            Alloc::deallocate(p, n * sizeof(T));
+            if (!count)
+                return node_alloc.allocate();
+            T *p = head;
+            head = allocator::batch_link(p);
+            --count;
+            return p;
         }
 
-        static void deallocate(T *p)
+        // p中的元素已经析构
+        void put_back(T *p)
         {
-            Alloc::deallocate(p, sizeof(T));
+            allocator::batch_link(p) = head;
+            head = p;
+            ++count;
         }
     };
 
@@ -48,8 +251,12 @@ namespace stl
 
         static void *oom_realloc(void *, size_t);
 
+        static void *oom_memalign(size_t, size_t);
+
         static void (*malloc_alloc_oom_handler)();
 
+        static std::atomic<size_t> oom_calls;
+
     public:
         static void *allocate(size_t n)
         {
@@ -64,6 +271,21 @@ namespace stl
             free(p);
         }
 
+        // 按align（2的幂次）对齐分配，malloc本身能满足的对齐不需要posix_memalign
+        static void *allocate(size_t n, size_t align)
+        {
+            if (align <= alignof(std::max_align_t))
+                return allocate(n);
+            void *result;
+            return posix_memalign(&result, align, n) ? oom_memalign(n, align) : result;
+        }
+
+        static void deallocate(void *p, size_t n, size_t align)
+        {
+            (void) align;
+            deallocate(p, n);
+        }
+
         static void *reallocate(void *p, size_t old_sz, size_t new_sz)
         {
             (void) old_sz;
@@ -77,9 +299,16 @@ namespace stl
             malloc_alloc_oom_handler = f;
             return old;
         }
+
+        // 内存不足处理函数被调用的次数
+        static size_t oom_handler_calls()
+        {
+            return oom_calls.load(std::memory_order_relaxed);
+        }
     };
 
     void (*Malloc_alloc::malloc_alloc_oom_handler)(){};
+    std::atomic<size_t> Malloc_alloc::oom_calls{};
 
     void *Malloc_alloc::oom_malloc(size_t n)
     {
@@ -91,6 +320,7 @@ namespace stl
             my_malloc_handler = malloc_alloc_oom_handler;
             if (!my_malloc_handler)
                 throw std::bad_alloc();
+            oom_calls.fetch_add(1, std::memory_order_relaxed);
             my_malloc_handler();
             result = malloc(n);
             if (result)
@@ -108,6 +338,7 @@ namespace stl
             my_malloc_handler = malloc_alloc_oom_handler;
             if (!my_malloc_handler)
                 throw std::bad_alloc();
+            oom_calls.fetch_add(1, std::memory_order_relaxed);
             my_malloc_handler();
             result = realloc(p, n);
             if (result)
@@ -115,9 +346,130 @@ namespace stl
         }
     }
 
+    void *Malloc_alloc::oom_memalign(size_t n, size_t align)
+    {
+        void (*my_malloc_handler)();
+        void *result;
+
+        while (true)
+        {
+            my_malloc_handler = malloc_alloc_oom_handler;
+            if (!my_malloc_handler)
+                throw std::bad_alloc();
+            oom_calls.fetch_add(1, std::memory_order_relaxed);
+            my_malloc_handler();
+            if (!posix_memalign(&result, align, n))
+                return result;
+        }
+    }
+
+
+    /*
+     * 无锁栈（Treiber stack），栈顶指针带有版本号以避免ABA问题
+     * 栈顶是一个64位的字：低48位为指针，高16位为版本号，每次修改栈顶都会使版本号加一，
+     * 因此即使某个节点被弹出后又被压回栈顶，持有旧栈顶的CAS也会失败
+     * 节点的内存必须始终可读（节点只会在不同的栈之间流转，不会被归还给操作系统），
+     * 因为pop在CAS之前需要读取栈顶节点的链接
+     * */
+    template <typename Node, Node *Node::*Link>
+    class tagged_stack
+    {
+    private:
+        static_assert(sizeof(void *) == 8, "tagged_stack packs a 48-bit pointer and a 16-bit tag");
+
+        static constexpr int PTR_BITS = 48;
+        static constexpr uint64_t PTR_MASK = (uint64_t(1) << PTR_BITS) - 1;
+
+        std::atomic<uint64_t> head{};
+
+        static Node *ptr(uint64_t v)
+        {
+            return reinterpret_cast<Node *>(static_cast<uintptr_t>(v & PTR_MASK));
+        }
+
+        static uint64_t next_tag(uint64_t v)
+        {
+            return (v >> PTR_BITS) + 1;
+        }
+
+        static uint64_t make(Node *p, uint64_t tag)
+        {
+            return (tag << PTR_BITS) | reinterpret_cast<uintptr_t>(p);
+        }
+
+        /*
+         * pop在CAS之前读取栈顶节点的链接，此时该节点可能已被其他线程弹出并改写了链接
+         * 这种情况下栈顶的版本号必然已经改变，随后的CAS一定失败，读到的过时值不会被使用；
+         * 节点的内存始终可读，读取本身也不会出错。因此这次竞争是无害的，不对它做ThreadSanitizer检查
+         * 链接是节点中的普通成员（free list的区块在分配后就是用户的内存），不能改为std::atomic
+         * */
+        __attribute__((no_sanitize("thread"))) static Node *link_of(Node *n)
+        {
+            return n->*Link;
+        }
+
+    public:
+        // 把已经链接好的一串节点[first, last]压入栈中
+        void push(Node *first, Node *last)
+        {
+            uint64_t old = head.load(std::memory_order_relaxed);
+            do
+                last->*Link = ptr(old);
+            while (!head.compare_exchange_weak(old, make(first, next_tag(old)),
+                                               std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        Node *pop()
+        {
+            uint64_t old = head.load(std::memory_order_acquire);
+            Node *top;
+            do
+            {
+                top = ptr(old);
+                if (!top)
+                    return nullptr;
+            } while (!head.compare_exchange_weak(old, make(link_of(top), next_tag(old)),
+                                                 std::memory_order_acquire, std::memory_order_acquire));
+            return top;
+        }
+
+        // 一次性取走整个栈
+        Node *pop_all()
+        {
+            uint64_t old = head.load(std::memory_order_acquire);
+            while (ptr(old) && !head.compare_exchange_weak(old, make(nullptr, next_tag(old)),
+                                                           std::memory_order_acquire, std::memory_order_acquire))
+                ;
+            return ptr(old);
+        }
+
+        bool empty() const
+        {
+            return !ptr(head.load(std::memory_order_relaxed));
+        }
+    };
 
     /*
     * 第二级配置器
+    * 由两层组成：
+    * 1. 线程本地缓存（thread cache）：每个线程为每个size class持有一条私有的free list，
+    *    分配与回收的快速路径只访问本线程的缓存，不需要任何原子操作或加锁
+    * 2. 中心池（central pool）：所有线程共享的free list以及内存池，线程缓存以批为单位
+    *    从中心池取得区块，或者把多余的区块成批归还给中心池
+    *    中心池是无锁的：每个size class的free list是一个带版本号的Treiber栈，
+    *    内存池（chunk）的切分通过CAS推进切分位置，申请新chunk的线程不会阻塞其他线程
+    *
+    * size class：
+    * 1. 不超过SMALL_BYTES的区块按ALIGN对齐，共SMALL_BYTES / ALIGN个size class
+    * 2. 更大的区块按几何级数划分，每个2的幂次区间内等分为CLASSES_PER_DOUBLING个size class，
+    *    直到MAX_BYTES，因此每个区块的内部碎片不超过其大小的1/CLASSES_PER_DOUBLING
+    * 所有的区块都从按页对齐的大块内存（chunk）中切分而来
+    *
+    * 内存归还：
+    * 所有chunk都登记在一条只增不减的链表中，trim()统计中心池里每个chunk的空闲字节数，
+    * 对已经切分完毕且全部区块都空闲的chunk调用madvise(MADV_DONTNEED)把物理页归还给操作系统
+    * 这里不使用munmap：其他线程的无锁pop可能仍会读取这些区块的链接，地址空间必须保持可读
+    * 被归还的chunk进入备用chunk栈，再次使用时重新切分
     * */
     enum
     {
@@ -125,19 +477,142 @@ namespace stl
     };
     enum
     {
-        MAX_BYTES = 128
+        SMALL_BYTES = 128
+    };
+    enum
+    {
+        MAX_BYTES = 32 * 1024
+    };
+    enum
+    {
+        CLASSES_PER_DOUBLING = 4
+    };
+    enum
+    {
+        // 128字节以内16个，(128, 32K]之间每个2的幂次区间4个
+        NFREELISTS = SMALL_BYTES / ALIGN + 8 * CLASSES_PER_DOUBLING
+    };
+    enum
+    {
+        BATCH_SIZE = 20                 // 线程缓存与中心池之间一次搬运的最大区块数
+    };
+    enum
+    {
+        BATCH_BYTES = 64 * 1024         // 较大的size class每批搬运的字节数上限
     };
     enum
     {
-        NFREELISTS = MAX_BYTES / ALIGN
+        MIN_CHUNK_BYTES = 64 * 1024     // 每次向系统申请的chunk的最小字节数
+    };
+
+    // 每个size class的区块大小以及一批搬运的区块数
+    struct size_class_table
+    {
+        size_t size[NFREELISTS]{};
+        int batch[NFREELISTS]{};
+
+        constexpr size_class_table()
+        {
+            size_t i = 0;
+            for (size_t bytes = ALIGN; bytes <= SMALL_BYTES; bytes += ALIGN)
+                size[i++] = bytes;
+            for (size_t base = SMALL_BYTES; base < MAX_BYTES; base *= 2)
+                for (size_t k = 1; k <= CLASSES_PER_DOUBLING; ++k)
+                    size[i++] = base + k * (base / CLASSES_PER_DOUBLING);
+
+            for (i = 0; i < NFREELISTS; ++i)
+            {
+                size_t n = BATCH_BYTES / size[i];
+                batch[i] = n > BATCH_SIZE ? BATCH_SIZE : (n < 2 ? 2 : static_cast<int>(n));
+            }
+        }
+    };
+
+    // Default_alloc的统计信息快照，各项计数分别读取，彼此之间不保证严格一致
+    struct alloc_stats
+    {
+        struct class_stats
+        {
+            size_t size;           // 区块大小
+            size_t allocs;         // 分配次数
+            size_t frees;          // 回收次数
+            size_t refills;        // 线程缓存从中心池取回区块的次数
+            size_t chunk_allocs;   // 中心池为该size class切分chunk的次数
+            size_t thread_cached;  // 缓存在各线程缓存中的区块数
+            size_t central_cached; // 缓存在中心池中的区块数
+
+            size_t in_use() const
+            {
+                return allocs - frees;
+            }
+        };
+
+        class_stats classes[NFREELISTS];
+        size_t large_allocs;           // 交给第一级配置器的分配次数
+        size_t large_frees;
+        size_t large_bytes_allocated;  // 交给第一级配置器的累计字节数
+        size_t large_bytes_freed;
+        size_t oom_handler_calls;      // 第一级配置器调用内存不足处理函数的次数
+        size_t heap_size;              // 当前持有的chunk的字节数
+        size_t peak_heap_size;
+        size_t chunks;                 // 累计申请的chunk数
+        size_t trimmed_bytes;          // trim()累计归还给操作系统的字节数
+
+        // 仍在使用中的区块的字节数（按size class的大小计算，不含第一级配置器）
+        size_t in_use_bytes() const
+        {
+            size_t bytes = 0;
+            for (auto &c : classes)
+                bytes += c.in_use() * c.size;
+            return bytes;
+        }
+
+        // 缓存在free list中的字节数
+        size_t cached_bytes() const
+        {
+            size_t bytes = 0;
+            for (auto &c : classes)
+                bytes += (c.thread_cached + c.central_cached) * c.size;
+            return bytes;
+        }
     };
 
     class Default_alloc
     {
     private:
+        static constexpr size_class_table classes{};
+
         static size_t ROUND_UP(size_t bytes)
         {
-            return (bytes + ALIGN - 1) & (~(ALIGN - 1));
+            return classes.size[FREELIST_INDEX(bytes)];
+        }
+
+        static size_t FREELIST_INDEX(size_t bytes)
+        {
+            if (bytes <= SMALL_BYTES)
+                return (bytes + ALIGN - 1) / ALIGN - 1;
+
+            static_assert(SMALL_BYTES == 128 && CLASSES_PER_DOUBLING == 4, "FREELIST_INDEX assumes 128 / 4");
+            // bytes位于(2^(k-1), 2^k]区间内，该区间的每个size class跨度为2^(k-1) / CLASSES_PER_DOUBLING
+            int k = 64 - __builtin_clzl(bytes - 1);
+            int shift = k - 1 - 2; // log2(2^(k-1) / CLASSES_PER_DOUBLING)
+            return SMALL_BYTES / ALIGN + (k - 8) * CLASSES_PER_DOUBLING +
+                   ((bytes - 1 - (size_t(1) << (k - 1))) >> shift);
+        }
+
+        // 不超过bytes的最大的size class
+        static size_t ROUND_DOWN(size_t bytes)
+        {
+            if (bytes >= MAX_BYTES)
+                return MAX_BYTES;
+            size_t index = FREELIST_INDEX(bytes);
+            return classes.size[index] > bytes ? classes.size[index - 1] : classes.size[index];
+        }
+
+        static size_t PAGE_ROUND_UP(size_t bytes)
+        {
+            static const size_t page = sysconf(_SC_PAGESIZE);
+            return (bytes + page - 1) & ~(page - 1);
         }
 
         struct obj
@@ -145,172 +620,1016 @@ namespace stl
             obj *free_list_link;
         };
 
-        static obj *volatile free_list[NFREELISTS];
+        // 每个chunk的起始处存放其头部，[cur, end)为尚未切分的部分
+        // 头部所在的页永远不会被归还，因此头部总是可以访问的
+        struct chunk_header
+        {
+            std::atomic<char *> cur;
+            char *end;
+            chunk_header *next_spare;
+            chunk_header *next_chunk; // 所有chunk的登记链表
+            // 物理页已归还；由弹出备用chunk的线程清除，trim会并发读取，
+            // 因此先重置cur再以release清除，trim以acquire读到false时一定看到重置后的cur
+            std::atomic<bool> released;
+        };
 
-        static size_t FREELIST_INDEX(size_t bytes)
+        enum
         {
-            return (bytes + ALIGN - 1) / ALIGN - 1;
-        }
+            CHUNK_HEADER_SIZE = (sizeof(chunk_header) + ALIGN - 1) & ~(ALIGN - 1)
+        };
+
+        using central_list = tagged_stack<obj, &obj::free_list_link>;
+        using spare_list = tagged_stack<chunk_header, &chunk_header::next_spare>;
+
+        // 线程缓存的状态，快速路径只在Active状态下工作
+        enum class cache_state : unsigned char
+        {
+            Unregistered, // 尚未注册线程退出时的回收动作
+            Active,
+            Dead          // 线程正在退出，缓存已归还中心池
+        };
+
+        // 只由所属线程修改、可以被其他线程读取的计数器，修改不需要原子的读-改-写指令
+        struct local_counter
+        {
+            std::atomic<size_t> value;
+
+            size_t get() const
+            {
+                return value.load(std::memory_order_relaxed);
+            }
+
+            void set(size_t n)
+            {
+                value.store(n, std::memory_order_relaxed);
+            }
+
+            void add(size_t n)
+            {
+                set(get() + n);
+            }
+
+            void sub(size_t n)
+            {
+                set(get() - n);
+            }
+        };
+
+        // 线程缓存必须是trivially destructible的，这样访问它不需要经过TLS的初始化检查
+        struct thread_cache
+        {
+            obj *free_list[NFREELISTS];
+            local_counter length[NFREELISTS];
+            local_counter allocs[NFREELISTS];
+            local_counter frees[NFREELISTS];
+            local_counter large_allocs, large_frees;
+            local_counter large_bytes_allocated, large_bytes_freed;
+            thread_cache *prev, *next; // 已注册的线程缓存链表，供统计使用
+            cache_state state;
+        };
+
+        // 所有线程共享的计数器
+        // allocs、frees等同时保存已退出线程的计数，以及线程缓存失效之后发生的操作的计数
+        struct shared_counters
+        {
+            std::atomic<size_t> allocs[NFREELISTS];
+            std::atomic<size_t> frees[NFREELISTS];
+            std::atomic<size_t> refills[NFREELISTS];
+            std::atomic<size_t> chunk_allocs[NFREELISTS];
+            std::atomic<size_t> central_length[NFREELISTS];
+            std::atomic<size_t> large_allocs, large_frees;
+            std::atomic<size_t> large_bytes_allocated, large_bytes_freed;
+            std::atomic<size_t> peak_heap_size, chunks, trimmed_bytes;
+        };
+
+        // 线程退出时负责把线程缓存中的区块全部归还中心池
+        struct cache_reaper
+        {
+            ~cache_reaper();
+        };
+
+        static thread_local thread_cache tcache;
+        static thread_local cache_reaper reaper;
+        static std::mutex registry_mutex;
+        static thread_cache *registry; // 已注册的线程缓存
+        static shared_counters counters;
+
+        // 后台定期调用trim()的线程
+        struct background_trimmer
+        {
+            std::thread worker;
+            std::mutex mtx;
+            std::condition_variable cv;
+            bool stop = false;
+
+            ~background_trimmer();
+        };
+
+        // trim()时每个chunk的统计信息
+        struct chunk_usage
+        {
+            chunk_header *chunk;
+            size_t free_bytes;
+            bool idle;
+        };
+
+        // 中心池，只有慢速路径才会访问
+        static central_list free_list[NFREELISTS];
+        static std::atomic<chunk_header *> current_chunk; // 正在切分的chunk
+        static spare_list spare_chunks;                   // 竞争失败的线程申请到的、暂时未使用的chunk
+        static std::atomic<chunk_header *> all_chunks;    // 所有通过mmap得到的chunk
+        static std::atomic<size_t> heap_size;
+        static std::atomic<bool> trimming;
+        static background_trimmer trimmer;
 
         static void *refill(size_t n);
+        static void release(size_t n);
+        static void register_cache();
+        static void count_large_alloc(size_t n);
+        static void count_large_free(size_t n);
+        static obj *fetch_from_central(size_t n, int &nobjs);
+        static void release_to_central(obj *first, obj *last, size_t n, size_t count);
+        static void flush_cache(thread_cache &tc);
         static char *chunk_alloc(size_t size, int &nobjs);
-
-        static char *start_free;
-        static char *end_free;
-        static size_t heap_size;
+        static char *carve(chunk_header *chunk, size_t size, int &nobjs);
+        static char *borrow(size_t size, int &nobjs);
+        static void release_range(char *first, char *last);
+        static void retire_chunk(chunk_header *chunk);
+        static void grow_heap(size_t bytes);
+        static void register_chunk(chunk_header *chunk);
+        static chunk_usage *find_chunk(chunk_usage *usage, size_t n, void *p);
+        static size_t release_chunk(chunk_header *chunk);
 
     public:
         static void *allocate(size_t n);
         static void deallocate(void *p, size_t n);
         static void *reallocate(void *p, size_t old_sz, size_t new_sz);
+
+        // 按align（2的幂次）对齐分配，不超过ALIGN的对齐走普通路径
+        // 更大的对齐交给第一级配置器，计入large_*统计，回收时必须传入相同的align
+        static void *allocate(size_t n, size_t align)
+        {
+            if (align <= ALIGN)
+                return allocate(n);
+            void *result = Malloc_alloc::allocate(n, align);
+            count_large_alloc(n);
+            return result;
+        }
+
+        static void deallocate(void *p, size_t n, size_t align)
+        {
+            if (align <= ALIGN)
+                return deallocate(p, n);
+            count_large_free(n);
+            Malloc_alloc::deallocate(p, n, align);
+        }
+
+        // 一次分配count个大小为n的区块，以区块起始处的指针串成链表返回
+        // 线程缓存中的区块整段摘下，不足的部分直接向中心池成批索取
+        static void *allocate_batch(size_t n, size_t count);
+        // 回收由起始处的指针串起的count个大小为n的区块
+        static void deallocate_batch(void *first, size_t n, size_t count);
+
+        // 把完全空闲的chunk归还给操作系统，返回归还的字节数
+        // 只统计中心池以及调用线程自己的缓存，其他线程缓存中的区块不会被归还
+        static size_t trim();
+        // 启动后台线程，每隔interval调用一次trim()，已经启动时只修改间隔
+        static void start_background_trim(std::chrono::milliseconds interval);
+        static void stop_background_trim();
+
+        static alloc_stats stats();
     };
 
-    char *Default_alloc::start_free{};
-    char *Default_alloc::end_free{};
-    size_t Default_alloc::heap_size{};
-    Default_alloc::obj * volatile Default_alloc::free_list[NFREELISTS]{};
+    std::atomic<size_t> Default_alloc::heap_size{};
+    Default_alloc::central_list Default_alloc::free_list[NFREELISTS]{};
+    std::atomic<Default_alloc::chunk_header *> Default_alloc::current_chunk{};
+    Default_alloc::spare_list Default_alloc::spare_chunks{};
+    std::atomic<Default_alloc::chunk_header *> Default_alloc::all_chunks{};
+    std::atomic<bool> Default_alloc::trimming{};
+    Default_alloc::background_trimmer Default_alloc::trimmer{};
+    thread_local Default_alloc::thread_cache Default_alloc::tcache{};
+    thread_local Default_alloc::cache_reaper Default_alloc::reaper{};
+    std::mutex Default_alloc::registry_mutex{};
+    Default_alloc::thread_cache *Default_alloc::registry{};
+    Default_alloc::shared_counters Default_alloc::counters{};
 
     void *Default_alloc::allocate(size_t n)
     {
-        // 大于128字节，从第一级配置器中分配
+        // 大于MAX_BYTES，从第一级配置器中分配
         if (n > MAX_BYTES)
-            return Malloc_alloc::allocate(n);
+        {
+            void *result = Malloc_alloc::allocate(n);
+            count_large_alloc(n);
+            return result;
+        }
         else
         {
-            obj * result;
-
-            obj * volatile * my_free_list = free_list + FREELIST_INDEX(n);
-            result = *my_free_list;
+            thread_cache &tc = tcache;
+            size_t index = FREELIST_INDEX(n);
+            obj *result = tc.free_list[index];
 
             if (!result)
                 return refill(ROUND_UP(n));
-            *my_free_list = result->free_list_link;
+            tc.free_list[index] = result->free_list_link;
+            tc.length[index].sub(1);
+            tc.allocs[index].add(1);
             return result;
         }
     }
 
     void Default_alloc::deallocate(void *p, size_t n)
     {
-        // 大于128字节，从第一级配置器中分配
+        // 大于MAX_BYTES，从第一级配置器中分配
         if (n > MAX_BYTES)
+        {
+            count_large_free(n);
             return Malloc_alloc::deallocate(p, n);
+        }
         else
         {
+            thread_cache &tc = tcache;
             obj *q = reinterpret_cast<obj *>(p);
-            obj * volatile * my_free_list = free_list + FREELIST_INDEX(n);
-            q->free_list_link = *my_free_list;
-            *my_free_list = q;
+            size_t index = FREELIST_INDEX(n);
+
+            if (tc.state != cache_state::Active)
+            {
+                if (tc.state == cache_state::Dead)
+                {
+                    // 线程缓存已经失效，直接归还中心池
+                    counters.frees[index].fetch_add(1, std::memory_order_relaxed);
+                    q->free_list_link = nullptr;
+                    release_to_central(q, q, ROUND_UP(n), 1);
+                    return;
+                }
+                register_cache();
+            }
+
+            q->free_list_link = tc.free_list[index];
+            tc.free_list[index] = q;
+            tc.frees[index].add(1);
+            tc.length[index].add(1);
+            // 线程缓存中单个size class最多保留两批区块
+            if (tc.length[index].get() > 2 * size_t(classes.batch[index]))
+                release(ROUND_UP(n));
         }
     }
 
     void *Default_alloc::reallocate(void *p, size_t old_sz, size_t new_sz)
     {
-        char * new_p;
+        if (old_sz <= MAX_BYTES && new_sz <= MAX_BYTES && ROUND_UP(old_sz) == ROUND_UP(new_sz))
+            return p;
 
-        if (new_sz > MAX_BYTES)
-            new_p = (char *)Malloc_alloc::allocate(new_sz);
-        else
+        // 两端都由第一级配置器管理，交给realloc，可以就地扩展或者重新映射页面
+        if (old_sz > MAX_BYTES && new_sz > MAX_BYTES)
+        {
+            void *result = Malloc_alloc::reallocate(p, old_sz, new_sz);
+            count_large_free(old_sz);
+            count_large_alloc(new_sz);
+            return result;
+        }
+
+        char *new_p = reinterpret_cast<char *>(allocate(new_sz));
+        memmove(new_p, p, old_sz < new_sz ? old_sz : new_sz);
+        deallocate(p, old_sz);
+        return new_p;
+    }
+
+    void *Default_alloc::allocate_batch(size_t n, size_t count)
+    {
+        thread_cache &tc = tcache;
+
+        if (n > MAX_BYTES || tc.state != cache_state::Active)
+        {
+            obj *first = nullptr;
+            while (count--)
+            {
+                obj *p = reinterpret_cast<obj *>(allocate(n));
+                p->free_list_link = first;
+                first = p;
+            }
+            return first;
+        }
+
+        size_t index = FREELIST_INDEX(n);
+        obj *first = tc.free_list[index];
+        obj *last = nullptr;
+        size_t taken = 0;
+
+        for (obj *p = first; p && taken < count; p = p->free_list_link)
+        {
+            last = p;
+            ++taken;
+        }
+        if (last)
+        {
+            tc.free_list[index] = last->free_list_link;
+            tc.length[index].sub(taken);
+        }
+
+        // 线程缓存已经取空
+        while (taken < count)
         {
-            if (old_sz <= MAX_BYTES && ROUND_UP(old_sz) == ROUND_UP(new_sz))
-                return p;
+            int nobjs = classes.batch[index];
+            obj *run = fetch_from_central(ROUND_UP(n), nobjs);
+            obj *run_last = run;
+            int k = 1;
+
+            counters.refills[index].fetch_add(1, std::memory_order_relaxed);
+            while (k < nobjs && taken + k < count)
+            {
+                run_last = run_last->free_list_link;
+                ++k;
+            }
+            // 多取的区块留在线程缓存
+            if (run_last->free_list_link)
+            {
+                tc.free_list[index] = run_last->free_list_link;
+                tc.length[index].set(nobjs - k);
+            }
+
+            if (last)
+                last->free_list_link = run;
             else
-                new_p = reinterpret_cast<char *>(allocate(new_sz));
+                first = run;
+            last = run_last;
+            taken += k;
+        }
+
+        last->free_list_link = nullptr;
+        tc.allocs[index].add(count);
+        return first;
+    }
+
+    void Default_alloc::deallocate_batch(void *first, size_t n, size_t count)
+    {
+        thread_cache &tc = tcache;
+        obj *p = reinterpret_cast<obj *>(first);
+
+        if (n > MAX_BYTES || tc.state != cache_state::Active)
+        {
+            while (count--)
+            {
+                obj *next = p->free_list_link;
+                deallocate(p, n);
+                p = next;
+            }
+            return;
+        }
+
+        size_t index = FREELIST_INDEX(n);
+        obj *last = p;
+        for (size_t i = 1; i < count; ++i)
+            last = last->free_list_link;
+
+        tc.frees[index].add(count);
+        // 超过一批的区块直接归还中心池，避免之后再逐批搬运
+        if (count >= size_t(classes.batch[index]))
+        {
+            release_to_central(p, last, ROUND_UP(n), count);
+            return;
         }
-        memmove(new_p, p, old_sz);
 
-        if (old_sz > MAX_BYTES)
-            Malloc_alloc::deallocate(p, old_sz);
+        last->free_list_link = tc.free_list[index];
+        tc.free_list[index] = p;
+        tc.length[index].add(count);
+        while (tc.length[index].get() > 2 * size_t(classes.batch[index]))
+            release(ROUND_UP(n));
+    }
+
+    // 第一次使用线程缓存时注册线程退出时的回收动作，并把线程缓存加入统计用的链表
+    void Default_alloc::register_cache()
+    {
+        (void) &reaper; // odr-use，使reaper在本线程中被构造，退出时被析构
+
+        thread_cache &tc = tcache;
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        tc.prev = nullptr;
+        tc.next = registry;
+        if (registry)
+            registry->prev = &tc;
+        registry = &tc;
+        tc.state = cache_state::Active;
+    }
+
+    // 交给第一级配置器的分配与回收，线程缓存失效之后计入共享的计数器
+    void Default_alloc::count_large_alloc(size_t n)
+    {
+        thread_cache &tc = tcache;
+
+        if (tc.state == cache_state::Unregistered)
+            register_cache();
+        if (tc.state == cache_state::Active)
+        {
+            tc.large_allocs.add(1);
+            tc.large_bytes_allocated.add(n);
+        }
         else
-            deallocate(p, old_sz);
-        return new_p;
+        {
+            counters.large_allocs.fetch_add(1, std::memory_order_relaxed);
+            counters.large_bytes_allocated.fetch_add(n, std::memory_order_relaxed);
+        }
     }
 
-    void * Default_alloc::refill(size_t n)
+    void Default_alloc::count_large_free(size_t n)
     {
-        int nobjs = 20;
-        char * chunk = chunk_alloc(n, nobjs);
+        thread_cache &tc = tcache;
+
+        if (tc.state == cache_state::Unregistered)
+            register_cache();
+        if (tc.state == cache_state::Active)
+        {
+            tc.large_frees.add(1);
+            tc.large_bytes_freed.add(n);
+        }
+        else
+        {
+            counters.large_frees.fetch_add(1, std::memory_order_relaxed);
+            counters.large_bytes_freed.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    Default_alloc::cache_reaper::~cache_reaper()
+    {
+        thread_cache &tc = tcache;
 
-        if (nobjs == 1)
-            return chunk;
+        tc.state = cache_state::Dead;
+        flush_cache(tc);
+
+        // 计数并入共享的计数器，并把线程缓存移出链表
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (size_t i = 0; i < NFREELISTS; ++i)
+        {
+            counters.allocs[i].fetch_add(tc.allocs[i].get(), std::memory_order_relaxed);
+            counters.frees[i].fetch_add(tc.frees[i].get(), std::memory_order_relaxed);
+        }
+        counters.large_allocs.fetch_add(tc.large_allocs.get(), std::memory_order_relaxed);
+        counters.large_frees.fetch_add(tc.large_frees.get(), std::memory_order_relaxed);
+        counters.large_bytes_allocated.fetch_add(tc.large_bytes_allocated.get(), std::memory_order_relaxed);
+        counters.large_bytes_freed.fetch_add(tc.large_bytes_freed.get(), std::memory_order_relaxed);
+
+        if (tc.prev)
+            tc.prev->next = tc.next;
         else
+            registry = tc.next;
+        if (tc.next)
+            tc.next->prev = tc.prev;
+    }
+
+    // 把线程缓存中的区块全部归还中心池
+    void Default_alloc::flush_cache(thread_cache &tc)
+    {
+        for (size_t i = 0; i < NFREELISTS; ++i)
         {
-            obj * volatile * my_free_list = free_list + FREELIST_INDEX(n);
-            void * result = chunk;
+            obj *first = tc.free_list[i];
+            if (!first)
+                continue;
+
+            obj *last = first;
+            while (last->free_list_link)
+                last = last->free_list_link;
+            release_to_central(first, last, classes.size[i], tc.length[i].get());
+            tc.free_list[i] = nullptr;
+            tc.length[i].set(0);
+        }
+    }
 
-            obj * current_obj = reinterpret_cast<obj *>(chunk + n);
-            *my_free_list = current_obj;
+    // 线程缓存中没有可用区块，从中心池取一批，返回其中一个，其余留在线程缓存
+    void * Default_alloc::refill(size_t n)
+    {
+        thread_cache &tc = tcache;
+        size_t index = FREELIST_INDEX(n);
+        int nobjs = classes.batch[index];
+        obj *chunk = fetch_from_central(n, nobjs);
 
-            for (int i = 2; i < nobjs; ++i)
+        counters.refills[index].fetch_add(1, std::memory_order_relaxed);
+        if (tc.state != cache_state::Active)
+        {
+            if (tc.state == cache_state::Dead)
             {
-                current_obj->free_list_link = reinterpret_cast<obj *>(chunk + i * n);
-                current_obj = current_obj->free_list_link;
+                // 线程缓存已失效，多余的区块退回中心池
+                counters.allocs[index].fetch_add(1, std::memory_order_relaxed);
+                if (chunk->free_list_link)
+                {
+                    obj *last = chunk->free_list_link;
+                    while (last->free_list_link)
+                        last = last->free_list_link;
+                    release_to_central(chunk->free_list_link, last, n, nobjs - 1);
+                }
+                return chunk;
             }
-            current_obj->free_list_link = nullptr;
+            register_cache();
+        }
+
+        tc.free_list[index] = chunk->free_list_link;
+        tc.length[index].set(nobjs - 1);
+        tc.allocs[index].add(1);
+
+        return chunk;
+    }
+
+    // 线程缓存过长，把其中一批区块归还中心池
+    void Default_alloc::release(size_t n)
+    {
+        thread_cache &tc = tcache;
+        size_t index = FREELIST_INDEX(n);
+        int nobjs = classes.batch[index];
+        obj *first = tc.free_list[index];
+        obj *last = first;
+
+        for (int i = 1; i < nobjs; ++i)
+            last = last->free_list_link;
+
+        tc.free_list[index] = last->free_list_link;
+        tc.length[index].sub(nobjs);
+        release_to_central(first, last, n, nobjs);
+    }
+
+    // 从中心池取出至多nobjs个大小为n的区块，以链表形式返回，nobjs被修改为实际取得的个数
+    Default_alloc::obj * Default_alloc::fetch_from_central(size_t n, int &nobjs)
+    {
+        size_t index = FREELIST_INDEX(n);
+        central_list &my_free_list = free_list[index];
+        obj *result = my_free_list.pop();
+
+        if (result)
+        {
+            obj *last = result;
+            int count = 1;
+
+            while (count < nobjs)
+            {
+                obj *next = my_free_list.pop();
+                if (!next)
+                    break;
+                last->free_list_link = next;
+                last = next;
+                ++count;
+            }
+            last->free_list_link = nullptr;
+            nobjs = count;
+            counters.central_length[index].fetch_sub(count, std::memory_order_relaxed);
 
             return result;
         }
+
+        counters.chunk_allocs[index].fetch_add(1, std::memory_order_relaxed);
+        char * chunk = chunk_alloc(n, nobjs);
+        obj * current_obj = reinterpret_cast<obj *>(chunk);
+
+        for (int i = 1; i < nobjs; ++i)
+        {
+            current_obj->free_list_link = reinterpret_cast<obj *>(chunk + i * n);
+            current_obj = current_obj->free_list_link;
+        }
+        current_obj->free_list_link = nullptr;
+
+        return reinterpret_cast<obj *>(chunk);
     }
 
-    char * Default_alloc::chunk_alloc(size_t size, int &nobjs)
+    // 把[first, last]这一串共count个大小为n的区块归还中心池
+    void Default_alloc::release_to_central(obj *first, obj *last, size_t n, size_t count)
     {
-        size_t total_bytes = size * nobjs;
-        size_t free_bytes = end_free - start_free;
+        size_t index = FREELIST_INDEX(n);
+
+        // 先计数后入栈，使计数不会少于栈中实际的区块数
+        counters.central_length[index].fetch_add(count, std::memory_order_relaxed);
+        free_list[index].push(first, last);
+    }
 
-        if (total_bytes <= free_bytes) // 可以满足分配要求
+    // 从chunk中切出至多nobjs个大小为size的区块，一个都切不出时返回nullptr
+    char * Default_alloc::carve(chunk_header *chunk, size_t size, int &nobjs)
+    {
+        char *cur = chunk->cur.load(std::memory_order_relaxed);
+
+        while (true)
         {
-            char * chunk = start_free;
-            start_free += total_bytes;
-            return chunk;
+            size_t free_bytes = chunk->end - cur;
+            if (free_bytes < size)
+                return nullptr;
+
+            // 可以满足分配要求，或者至少可以分配一个
+            int n = free_bytes >= size * nobjs ? nobjs : static_cast<int>(free_bytes / size);
+            if (chunk->cur.compare_exchange_weak(cur, cur + n * size, std::memory_order_relaxed))
+            {
+                nobjs = n;
+                return cur;
+            }
         }
-        else if (free_bytes >= size) // 至少可以分配一个
+    }
+
+    // 把[first, last)切分成尽可能大的区块，归还相应的free list
+    void Default_alloc::release_range(char *first, char *last)
+    {
+        while (last - first >= ALIGN)
         {
-            nobjs = static_cast<int>(free_bytes / size);
-            total_bytes = nobjs * size;
-            char * chunk = start_free;
-            start_free += total_bytes;
-            return chunk;
+            size_t bytes = ROUND_DOWN(last - first);
+            obj *head = reinterpret_cast<obj *>(first);
+            release_to_central(head, head, bytes, 1);
+            first += bytes;
         }
-        else
+    }
+
+    // 将chunk中剩余的可利用的内存分配给相应的free list
+    void Default_alloc::retire_chunk(chunk_header *chunk)
+    {
+        // 一次取走剩余部分，此后其他线程在该chunk上的切分都会失败
+        char *cur = chunk->cur.exchange(chunk->end, std::memory_order_relaxed);
+        release_range(cur, chunk->end);
+    }
+
+    // 申请不到新的chunk时，暂时利用较大的free list中的区块
+    char * Default_alloc::borrow(size_t size, int &nobjs)
+    {
+        for (size_t i = FREELIST_INDEX(size); i < NFREELISTS; ++i)
+        {
+            obj *chunk = free_list[i].pop();
+            if (chunk)
+            {
+                counters.central_length[i].fetch_sub(1, std::memory_order_relaxed);
+                size_t bytes = classes.size[i];
+                char *start = reinterpret_cast<char *>(chunk);
+                int n = static_cast<int>(bytes / size);
+
+                nobjs = n < nobjs ? n : nobjs;
+                // 剩余部分归还相应的free list
+                release_range(start + nobjs * size, start + bytes);
+                return start;
+            }
+        }
+        return nullptr;
+    }
+
+    char * Default_alloc::chunk_alloc(size_t size, int &nobjs)
+    {
+        while (true)
         {
-            size_t bytes_to_get = 2 * total_bytes + ROUND_UP(heap_size>>4);
+            chunk_header *chunk = current_chunk.load(std::memory_order_acquire);
+
+            if (chunk)
+            {
+                char *result = carve(chunk, size, nobjs);
+                if (result)
+                    return result;
+            }
 
-            // 将剩余的可利用的内存分配给相应的free list
-            if (free_bytes > 0)
+            // 当前chunk已经耗尽，优先换上一个备用的chunk，否则申请新的chunk
+            chunk_header *fresh = spare_chunks.pop();
+            char *result = nullptr;
+
+            if (fresh)
             {
-                obj * volatile * my_free_list = free_list + FREELIST_INDEX(free_bytes);
-                obj * head = reinterpret_cast<obj *>(start_free);
-                head->free_list_link = *my_free_list;
-                *my_free_list = head;
+                if (fresh->released.load(std::memory_order_relaxed))
+                {
+                    // 物理页已经归还过的chunk，从头开始重新切分
+                    fresh->cur.store(reinterpret_cast<char *>(fresh) + CHUNK_HEADER_SIZE, std::memory_order_relaxed);
+                    fresh->released.store(false, std::memory_order_release);
+                    grow_heap(fresh->end - reinterpret_cast<char *>(fresh));
+                }
+                result = carve(fresh, size, nobjs);
             }
+            else
+            {
+                size_t total_bytes = size * nobjs;
+                size_t bytes_to_get = CHUNK_HEADER_SIZE + 2 * total_bytes +
+                                      (heap_size.load(std::memory_order_relaxed) >> 4);
+                bytes_to_get = PAGE_ROUND_UP(bytes_to_get < MIN_CHUNK_BYTES ? MIN_CHUNK_BYTES : bytes_to_get);
+
+                // chunk直接向系统映射，保证按页对齐
+                char *mem = (char *)mmap(nullptr, bytes_to_get, PROT_READ | PROT_WRITE,
+                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                bool mapped = mem != MAP_FAILED;
 
-            start_free = (char *)malloc(bytes_to_get);
+                if (!mapped)
+                {
+                    result = borrow(size, nobjs);
+                    if (result)
+                        return result;
+                    mem = (char *)Malloc_alloc::allocate(bytes_to_get);
+                }
+                grow_heap(bytes_to_get);
+                counters.chunks.fetch_add(1, std::memory_order_relaxed);
+
+                // 新chunk尚未被其他线程看到，先私有地切出本次所需的区块
+                fresh = new (mem) chunk_header;
+                fresh->end = mem + bytes_to_get;
+                fresh->next_spare = nullptr;
+                fresh->next_chunk = nullptr;
+                fresh->released.store(false, std::memory_order_relaxed);
+                result = mem + CHUNK_HEADER_SIZE;
+                fresh->cur.store(result + total_bytes, std::memory_order_relaxed);
+                // 只有映射得到的chunk才能归还物理页
+                if (mapped)
+                    register_chunk(fresh);
+            }
 
-            if (!start_free)
+            // 已经切分完毕的chunk直接丢弃，不再换上或留作备用，trim()依赖这一点判断chunk不会再被切分
+            if (fresh->cur.load(std::memory_order_relaxed) != fresh->end)
             {
-                // 暂时利用较大的free list中的区块
-                for (size_t i = FREELIST_INDEX(size); i < NFREELISTS; ++i)
+                if (current_chunk.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel))
                 {
-                    if (free_list[i])
-                    {
-                        obj * chunk = free_list[i];
-                        free_list[i] = chunk->free_list_link;
-                        start_free = reinterpret_cast<char *>(chunk);
-                        end_free = reinterpret_cast<char *>(chunk) + (i + 1) * 8;
-
-                        return chunk_alloc(size, nobjs);
-                    }
+                    // 换下的chunk只会被一个线程回收
+                    if (chunk)
+                        retire_chunk(chunk);
                 }
+                else
+                    spare_chunks.push(fresh, fresh); // 其他线程已经换上了新的chunk，留作备用
+            }
+
+            if (result)
+                return result;
+        }
+    }
+
+    void Default_alloc::grow_heap(size_t bytes)
+    {
+        size_t size = heap_size.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t peak = counters.peak_heap_size.load(std::memory_order_relaxed);
+
+        while (peak < size && !counters.peak_heap_size.compare_exchange_weak(peak, size, std::memory_order_relaxed))
+            ;
+    }
+
+    // 把新的chunk加入登记链表，链表只增不减
+    void Default_alloc::register_chunk(chunk_header *chunk)
+    {
+        chunk_header *head = all_chunks.load(std::memory_order_relaxed);
+        do
+            chunk->next_chunk = head;
+        while (!all_chunks.compare_exchange_weak(head, chunk, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // usage按chunk的地址升序排列，二分查找p所在的chunk，不属于任何已登记的chunk时返回nullptr
+    Default_alloc::chunk_usage *Default_alloc::find_chunk(chunk_usage *usage, size_t n, void *p)
+    {
+        char *addr = static_cast<char *>(p);
+        size_t lo = 0, hi = n;
+
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            char *start = reinterpret_cast<char *>(usage[mid].chunk);
+            if (addr < start)
+                hi = mid;
+            else if (addr >= usage[mid].chunk->end)
+                lo = mid + 1;
+            else
+                return usage + mid;
+        }
+        return nullptr;
+    }
+
+    // 归还chunk除头部所在页以外的物理页，返回归还的字节数
+    size_t Default_alloc::release_chunk(chunk_header *chunk)
+    {
+        char *start = reinterpret_cast<char *>(chunk);
+        char *first = start + PAGE_ROUND_UP(CHUNK_HEADER_SIZE);
+        size_t bytes = chunk->end > first ? chunk->end - first : 0;
+
+        if (bytes)
+            madvise(first, bytes, MADV_DONTNEED);
+        chunk->released.store(true, std::memory_order_relaxed);
+        heap_size.fetch_sub(chunk->end - start, std::memory_order_relaxed);
+        spare_chunks.push(chunk, chunk);
+        return bytes;
+    }
+
+    size_t Default_alloc::trim()
+    {
+        // 同一时刻只允许一个线程执行trim
+        if (trimming.exchange(true, std::memory_order_acquire))
+            return 0;
+
+        thread_cache &tc = tcache;
+        if (tc.state == cache_state::Active)
+            flush_cache(tc);
+
+        // 备用chunk剩余的部分交给free list，使其有机会被整体归还
+        chunk_header *spare = spare_chunks.pop_all();
+        while (spare)
+        {
+            chunk_header *next = spare->next_spare;
+            if (spare->released.load(std::memory_order_relaxed))
+                spare_chunks.push(spare, spare);
+            else
+                retire_chunk(spare);
+            spare = next;
+        }
+
+        // 登记链表的快照，按地址排序以便查找区块所属的chunk
+        size_t nchunks = 0;
+        chunk_header *head = all_chunks.load(std::memory_order_acquire);
+        for (chunk_header *c = head; c; c = c->next_chunk)
+            ++nchunks;
+        if (!nchunks)
+        {
+            trimming.store(false, std::memory_order_release);
+            return 0;
+        }
+
+        chunk_usage *usage = static_cast<chunk_usage *>(Malloc_alloc::allocate(nchunks * sizeof(chunk_usage)));
+        size_t k = 0;
+        for (chunk_header *c = head; k < nchunks; c = c->next_chunk)
+            usage[k++] = {c, 0, false};
+        qsort(usage, nchunks, sizeof(chunk_usage), [](const void *a, const void *b) -> int
+        {
+            uintptr_t x = reinterpret_cast<uintptr_t>(static_cast<const chunk_usage *>(a)->chunk);
+            uintptr_t y = reinterpret_cast<uintptr_t>(static_cast<const chunk_usage *>(b)->chunk);
+            return x < y ? -1 : x > y;
+        });
+
+        // 取走中心池中所有的区块，统计每个chunk的空闲字节数
+        // 这期间其他线程会暂时看不到这些区块，必要时转而切分chunk
+        obj *lists[NFREELISTS];
+        for (size_t i = 0; i < NFREELISTS; ++i)
+        {
+            size_t count = 0;
+            lists[i] = free_list[i].pop_all();
+            for (obj *p = lists[i]; p; p = p->free_list_link, ++count)
+            {
+                chunk_usage *u = find_chunk(usage, nchunks, p);
+                if (u)
+                    u->free_bytes += classes.size[i];
+            }
+            counters.central_length[i].fetch_sub(count, std::memory_order_relaxed);
+        }
+
+        // 已经切分完毕、所有区块都空闲、且不是当前正在切分的chunk可以被归还
+        // 切分完毕的chunk不会再被换上，因此之后也不会再有线程在其中切分
+        chunk_header *current = current_chunk.load(std::memory_order_acquire);
+        for (size_t j = 0; j < nchunks; ++j)
+        {
+            chunk_header *c = usage[j].chunk;
+            char *base = reinterpret_cast<char *>(c) + CHUNK_HEADER_SIZE;
+            // 先读released再读cur，见chunk_header::released
+            usage[j].idle = c != current && !c->released.load(std::memory_order_acquire) &&
+                            c->cur.load(std::memory_order_relaxed) == c->end &&
+                            usage[j].free_bytes == size_t(c->end - base);
+        }
+
+        // 其余的区块放回中心池
+        for (size_t i = 0; i < NFREELISTS; ++i)
+        {
+            obj *first = nullptr, *last = nullptr;
+            size_t count = 0;
+            for (obj *p = lists[i], *next; p; p = next)
+            {
+                next = p->free_list_link;
+                chunk_usage *u = find_chunk(usage, nchunks, p);
+                if (u && u->idle)
+                    continue;
+                p->free_list_link = first;
+                first = p;
+                if (!last)
+                    last = p;
+                ++count;
+            }
+            if (first)
+                release_to_central(first, last, classes.size[i], count);
+        }
+
+        size_t released = 0;
+        for (size_t j = 0; j < nchunks; ++j)
+            if (usage[j].idle)
+                released += release_chunk(usage[j].chunk);
+
+        Malloc_alloc::deallocate(usage, nchunks * sizeof(chunk_usage));
+        counters.trimmed_bytes.fetch_add(released, std::memory_order_relaxed);
+        trimming.store(false, std::memory_order_release);
+        return released;
+    }
+
+    void Default_alloc::start_background_trim(std::chrono::milliseconds interval)
+    {
+        static std::chrono::milliseconds period;
+        std::unique_lock<std::mutex> lock(trimmer.mtx);
 
-                end_free = nullptr;
-                start_free = (char *)Malloc_alloc::allocate(bytes_to_get);
+        period = interval;
+        if (trimmer.worker.joinable())
+        {
+            trimmer.cv.notify_one();
+            return;
+        }
+        trimmer.stop = false;
+        trimmer.worker = std::thread([]()
+        {
+            std::unique_lock<std::mutex> lock(trimmer.mtx);
+            while (!trimmer.stop)
+            {
+                if (trimmer.cv.wait_for(lock, period) == std::cv_status::timeout)
+                {
+                    lock.unlock();
+                    trim();
+                    lock.lock();
+                }
             }
+        });
+    }
 
-            end_free = start_free + bytes_to_get;
-            return chunk_alloc(size, nobjs);
+    void Default_alloc::stop_background_trim()
+    {
+        std::thread worker;
+        {
+            std::lock_guard<std::mutex> lock(trimmer.mtx);
+            trimmer.stop = true;
+            worker = std::move(trimmer.worker);
         }
+        trimmer.cv.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    alloc_stats Default_alloc::stats()
+    {
+        alloc_stats result{};
+        std::lock_guard<std::mutex> lock(registry_mutex);
+
+        for (size_t i = 0; i < NFREELISTS; ++i)
+        {
+            alloc_stats::class_stats &c = result.classes[i];
+            c.size = classes.size[i];
+            c.allocs = counters.allocs[i].load(std::memory_order_relaxed);
+            c.frees = counters.frees[i].load(std::memory_order_relaxed);
+            c.refills = counters.refills[i].load(std::memory_order_relaxed);
+            c.chunk_allocs = counters.chunk_allocs[i].load(std::memory_order_relaxed);
+            c.central_cached = counters.central_length[i].load(std::memory_order_relaxed);
+        }
+        result.large_allocs = counters.large_allocs.load(std::memory_order_relaxed);
+        result.large_frees = counters.large_frees.load(std::memory_order_relaxed);
+        result.large_bytes_allocated = counters.large_bytes_allocated.load(std::memory_order_relaxed);
+        result.large_bytes_freed = counters.large_bytes_freed.load(std::memory_order_relaxed);
+
+        for (thread_cache *tc = registry; tc; tc = tc->next)
+        {
+            for (size_t i = 0; i < NFREELISTS; ++i)
+            {
+                alloc_stats::class_stats &c = result.classes[i];
+                c.allocs += tc->allocs[i].get();
+                c.frees += tc->frees[i].get();
+                c.thread_cached += tc->length[i].get();
+            }
+            result.large_allocs += tc->large_allocs.get();
+            result.large_frees += tc->large_frees.get();
+            result.large_bytes_allocated += tc->large_bytes_allocated.get();
+            result.large_bytes_freed += tc->large_bytes_freed.get();
+        }
+
+        result.oom_handler_calls = Malloc_alloc::oom_handler_calls();
+        result.heap_size = heap_size.load(std::memory_order_relaxed);
+        result.peak_heap_size = counters.peak_heap_size.load(std::memory_order_relaxed);
+        result.chunks = counters.chunks.load(std::memory_order_relaxed);
+        result.trimmed_bytes = counters.trimmed_bytes.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    Default_alloc::background_trimmer::~background_trimmer()
+    {
+        stop_background_trim();
     }
 
     using alloc = Default_alloc;
+
+    /*
+     * 为每次分配指定最小对齐的配置器适配器，例如SIMD的对齐加载或者避免伪共享的每线程槽位：
+     *     stl::vector<float, stl::Aligned_alloc<32>> v;
+     * 元素类型本身要求的对齐更大时以alignof(T)为准
+     * */
+    template<size_t Align, typename Alloc = alloc>
+    class Aligned_alloc : private Alloc
+    {
+        static_assert(Align && !(Align & (Align - 1)), "Align must be a power of 2");
+        static_assert(has_aligned_allocate<Alloc>::value, "Alloc must support allocate(n, align)");
+
+    private:
+        static size_t round_align(size_t align)
+        {
+            return align < Align ? Align : align;
+        }
+
+    public:
+        Aligned_alloc() = default;
+
+        Aligned_alloc(const Alloc &a) : Alloc(a) {}
+
+        void *allocate(size_t n)
+        {
+            return Alloc::allocate(n, Align);
+        }
+
+        void *allocate(size_t n, size_t align)
+        {
+            return Alloc::allocate(n, round_align(align));
+        }
+
+        void deallocate(void *p, size_t n)
+        {
+            Alloc::deallocate(p, n, Align);
+        }
+
+        void deallocate(void *p, size_t n, size_t align)
+        {
+            Alloc::deallocate(p, n, round_align(align));
+        }
+    };
 }
 
 #endif //MINISTL_ALLOC_HH
@@ -0,0 +1,256 @@
+//
+// Created by rda on 2024/3/9.
+//
+
+#ifndef MINISTL_ARENA_HH
+#define MINISTL_ARENA_HH
+
+#include <cstring>
+#include <new>
+
+#include "alloc.hh"
+
+namespace stl
+{
+    /*
+     * 单调（monotonic）内存池
+     * 分配只是推进当前内存块中的指针，回收什么也不做，所有内存在reset()或release()时一次性释放
+     * 适合生命周期相同的一组对象，例如一次请求中构建、随请求一起销毁的若干容器
+     * 内存块向第一级配置器申请，容量不足时按几何级数增长
+     * */
+    class arena
+    {
+    private:
+        struct block
+        {
+            block *next;
+            size_t size; // 整个内存块（包括头部）的字节数
+        };
+
+        enum
+        {
+            BLOCK_HEADER_SIZE = (sizeof(block) + ALIGN - 1) & ~(ALIGN - 1)
+        };
+
+        block *blocks;       // 已申请的内存块，最新的在链表头部
+        char *cur;           // 当前内存块中尚未分配的部分为[cur, end)
+        char *end;
+        char *last;          // 最近一次分配的起始位置，reallocate可以就地扩展它
+        size_t next_size;    // 下一次申请的内存块的大小
+        size_t used_bytes;
+
+        void *allocate_slow(size_t n, size_t align);
+
+    public:
+        explicit arena(size_t initial_size = 4096);
+
+        arena(const arena &) = delete;
+
+        arena &operator=(const arena &) = delete;
+
+        ~arena()
+        {
+            release();
+        }
+
+        // 分配n个字节，按align（2的幂次）对齐
+        void *allocate(size_t n, size_t align = ALIGN)
+        {
+            char *p = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(align - 1));
+            // 内存块的末尾不一定对齐，对齐之后p可能已经越过end
+            if (p > end || n > size_t(end - p))
+                return allocate_slow(n, align);
+            cur = p + n;
+            last = p;
+            used_bytes += n;
+            return p;
+        }
+
+        // 什么也不做，内存随arena一起释放
+        void deallocate(void *p, size_t n)
+        {
+            (void) p;
+            (void) n;
+        }
+
+        // p是最近一次分配的区块且当前内存块足够时就地扩展或收缩，否则分配新的区块并复制
+        void *reallocate(void *p, size_t old_sz, size_t new_sz);
+
+        // 释放所有分配，只保留最大的（最近申请的）内存块供之后使用
+        void reset();
+
+        // 释放所有分配以及所有内存块
+        void release();
+
+        // 已分配给使用者的字节数
+        size_t used() const
+        {
+            return used_bytes;
+        }
+
+        // 持有的内存块的总字节数
+        size_t capacity() const;
+    };
+
+    arena::arena(size_t initial_size)
+        : blocks(nullptr), cur(nullptr), end(nullptr), last(nullptr),
+          next_size(initial_size < 2 * BLOCK_HEADER_SIZE ? 2 * BLOCK_HEADER_SIZE : initial_size),
+          used_bytes(0)
+    {
+    }
+
+    void *arena::allocate_slow(size_t n, size_t align)
+    {
+        // 新内存块至少能容纳本次分配，并且大小按几何级数增长
+        size_t need = BLOCK_HEADER_SIZE + n + align;
+        size_t size = next_size < need ? need : next_size;
+        block *b = static_cast<block *>(Malloc_alloc::allocate(size));
+
+        b->next = blocks;
+        b->size = size;
+        blocks = b;
+        cur = reinterpret_cast<char *>(b) + BLOCK_HEADER_SIZE;
+        end = reinterpret_cast<char *>(b) + size;
+        next_size = size * 2;
+
+        return allocate(n, align);
+    }
+
+    void *arena::reallocate(void *p, size_t old_sz, size_t new_sz)
+    {
+        if (p && p == last && new_sz <= size_t(end - last))
+        {
+            cur = last + new_sz;
+            used_bytes = used_bytes - old_sz + new_sz;
+            return p;
+        }
+
+        void *new_p = allocate(new_sz);
+        if (p)
+            memcpy(new_p, p, old_sz < new_sz ? old_sz : new_sz);
+        return new_p;
+    }
+
+    void arena::reset()
+    {
+        if (!blocks)
+            return;
+
+        // 最近申请的内存块是最大的，保留它
+        block *b = blocks->next;
+        while (b)
+        {
+            block *next = b->next;
+            Malloc_alloc::deallocate(b, b->size);
+            b = next;
+        }
+        blocks->next = nullptr;
+        cur = reinterpret_cast<char *>(blocks) + BLOCK_HEADER_SIZE;
+        end = reinterpret_cast<char *>(blocks) + blocks->size;
+        last = nullptr;
+        used_bytes = 0;
+    }
+
+    void arena::release()
+    {
+        reset();
+        if (blocks)
+        {
+            next_size = blocks->size;
+            Malloc_alloc::deallocate(blocks, blocks->size);
+        }
+        blocks = nullptr;
+        cur = end = nullptr;
+    }
+
+    size_t arena::capacity() const
+    {
+        size_t bytes = 0;
+        for (block *b = blocks; b; b = b->next)
+            bytes += b->size;
+        return bytes;
+    }
+
+
+    /*
+     * 以arena为后端的静态配置器，可以作为各个容器的Alloc模板参数
+     * 配置器本身不持有arena，而是由arena_scope为当前线程指定：作用域内分配的内存都来自该arena
+     * 需要让容器各自持有arena时使用memory_resource.hh中的polymorphic_alloc与arena_resource
+     * deallocate什么也不做，因此容器可以在作用域之外被销毁，但必须在arena被reset或销毁之前
+     * */
+    class Arena_alloc
+    {
+    private:
+        static thread_local arena *current;
+
+        friend class arena_scope;
+
+    public:
+        static void *allocate(size_t n)
+        {
+            // 没有指定arena时无处分配
+            if (!current)
+                throw std::bad_alloc();
+            return current->allocate(n);
+        }
+
+        static void *allocate(size_t n, size_t align)
+        {
+            if (!current)
+                throw std::bad_alloc();
+            return current->allocate(n, align < ALIGN ? ALIGN : align);
+        }
+
+        static void deallocate(void *p, size_t n)
+        {
+            (void) p;
+            (void) n;
+        }
+
+        static void deallocate(void *p, size_t n, size_t align)
+        {
+            (void) p;
+            (void) n;
+            (void) align;
+        }
+
+        static void *reallocate(void *p, size_t old_sz, size_t new_sz)
+        {
+            if (!current)
+                throw std::bad_alloc();
+            return current->reallocate(p, old_sz, new_sz);
+        }
+
+        // 当前线程正在使用的arena
+        static arena *get_arena()
+        {
+            return current;
+        }
+    };
+
+    thread_local arena *Arena_alloc::current = nullptr;
+
+    // 在作用域内把当前线程的Arena_alloc指向给定的arena，离开时恢复之前的arena，可以嵌套
+    class arena_scope
+    {
+    private:
+        arena *prev;
+
+    public:
+        explicit arena_scope(arena &a) : prev(Arena_alloc::current)
+        {
+            Arena_alloc::current = &a;
+        }
+
+        arena_scope(const arena_scope &) = delete;
+
+        arena_scope &operator=(const arena_scope &) = delete;
+
+        ~arena_scope()
+        {
+            Arena_alloc::current = prev;
+        }
+    };
+}
+
+#endif //MINISTL_ARENA_HH
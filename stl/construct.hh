@@ -13,7 +13,7 @@
 namespace stl
 {
     template<typename T1, typename... Args>
-    inline void construct(T1 * p, Args&&... val) noexcept
+    inline void construct(T1 * p, Args&&... val)
     {
         new (p) T1(std::forward<Args>(val)...);
     }
@@ -199,7 +199,7 @@ namespace stl
 
     /* Deque */
     template <typename T, typename Alloc = alloc>
-    class deque
+    class deque : protected simple_alloc<T, Alloc>
     {
     public:
         /* Member types */
@@ -225,6 +225,12 @@ namespace stl
 
         using map_pointer = pointer *;
 
+        // 中控器与缓冲区使用同一个配置器实例
+        map_allocator get_map_allocator() const
+        {
+            return map_allocator(data_allocator::get_alloc());
+        }
+
         iterator start{};  // 指向第一个元素
         iterator finish{}; // 指向最后一个元素的下一个位置
 
@@ -279,7 +285,7 @@ namespace stl
                     deallocate_node(cur);
 
                 // 释放中继器
-                map_allocator::deallocate(map);
+                get_map_allocator().deallocate(map, map_size);
                 map_size = 0;
                 map = nullptr;
 
@@ -295,14 +301,14 @@ namespace stl
 
         void allocate_map(size_type map_size)
         {
-            map = map_allocator::allocate(map_size);
+            map = get_map_allocator().allocate(map_size);
             memset(map, 0, map_size * sizeof(*map)); // 初始时清空map
         }
 
         // 分配一块新的缓冲区，将其位置保存在map中的指定位置
         // 除非shrink fit，否则一般弹出元素也不会释放其占有的内存，而是以备添加元素的需求
         // 因此有可能mp处本来就有一块缓冲区，此时不会分配新的缓冲区
-        static void allocate_node(map_pointer mp)
+        void allocate_node(map_pointer mp)
         {
             if (!*mp)
                 *mp = data_allocator::allocate(BUFFER_SIZE);
@@ -313,7 +319,7 @@ namespace stl
         {
             if (*mp)
             {
-                data_allocator::deallocate(*mp);
+                data_allocator::deallocate(*mp, BUFFER_SIZE);
                 *mp = nullptr; // 标注该指针为空
             }
         }
@@ -352,13 +358,13 @@ namespace stl
             {
                 stl::destroy(*mp, *mp + (mp == finish.node ? length % BUFFER_SIZE : BUFFER_SIZE));
                 if (release_all)
-                    data_allocator::deallocate(*mp);
+                    data_allocator::deallocate(*mp, BUFFER_SIZE);
             }
 
             if (release_all)
             {
                 // 释放中控器
-                map_allocator::deallocate(map);
+                get_map_allocator().deallocate(map, map_size);
                 map_size = 0;
                 map = nullptr;
 
@@ -398,6 +404,7 @@ namespace stl
             else
             {
                 size_type new_map_size = map_size + std::max(map_size, nodes_to_add) + 2;
+                map_pointer old_map = map;
 
                 allocate_map(new_map_size);
 
@@ -406,6 +413,8 @@ namespace stl
 
                 stl::copy(start.node, finish.node + 1, new_nstart);
 
+                // 归还旧的中控器
+                get_map_allocator().deallocate(old_map, map_size);
                 map_size = new_map_size;
             }
 
@@ -474,10 +483,12 @@ namespace stl
          * */
         deque();
 
-        explicit deque(size_type count, const T &value = T());
+        explicit deque(const Alloc &a);
+
+        explicit deque(size_type count, const T &value = T(), const Alloc &a = Alloc());
 
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        deque(InputIt first, InputIt last)
+        deque(InputIt first, InputIt last, const Alloc &a = Alloc()) : data_allocator(a)
         {
             // 分配中控器和默认大小的相应的缓冲区
             create_map_and_nodes(stl::distance(first, last));
@@ -487,7 +498,7 @@ namespace stl
 
         deque(const deque &other);
         deque(deque &&other);
-        deque(std::initializer_list<T> init);
+        deque(std::initializer_list<T> init, const Alloc &a = Alloc());
 
         /*
          * Destructor
@@ -650,6 +661,11 @@ namespace stl
         void resize(size_type count, const value_type &value);
 
         void swap(deque &other) noexcept;
+
+        allocator_type get_allocator() const noexcept
+        {
+            return data_allocator::get_alloc();
+        }
     };
 
     /*
@@ -662,13 +678,19 @@ namespace stl
     }
 
     template <typename T, typename Alloc>
-    deque<T, Alloc>::deque(size_type count, const T &value)
+    deque<T, Alloc>::deque(const Alloc &a) : data_allocator(a)
+    {
+        fill_initialize(0);
+    }
+
+    template <typename T, typename Alloc>
+    deque<T, Alloc>::deque(size_type count, const T &value, const Alloc &a) : data_allocator(a)
     {
         fill_initialize(count, value);
     }
 
     template <typename T, typename Alloc>
-    deque<T, Alloc>::deque(const deque &other)
+    deque<T, Alloc>::deque(const deque &other) : data_allocator(other.get_alloc())
     {
         // 创建足够的map结构和缓冲区
         create_map_and_nodes(other.size());
@@ -677,7 +699,7 @@ namespace stl
     }
 
     template <typename T, typename Alloc>
-    deque<T, Alloc>::deque(deque &&other)
+    deque<T, Alloc>::deque(deque &&other) : data_allocator(other.get_alloc())
     {
         // 接管other的元素
         map = other.map;
@@ -690,8 +712,8 @@ namespace stl
     }
 
     template <typename T, typename Alloc>
-    deque<T, Alloc>::deque(std::initializer_list<T> init)
-        : deque(init.begin(), init.end()) {}
+    deque<T, Alloc>::deque(std::initializer_list<T> init, const Alloc &a)
+        : deque(init.begin(), init.end(), a) {}
 
     /*
      * Destructor
@@ -721,7 +743,8 @@ namespace stl
         // 释放原有的控制数据结构和元素
         release_storage(true);
 
-        // 接管other的元素
+        // 接管other的元素及配置器
+        data_allocator::get_alloc() = other.get_alloc();
         map = other.map;
         start = other.start;
         finish = other.finish;
@@ -1263,6 +1286,7 @@ namespace stl
         stl::swap(finish, other.finish);
         stl::swap(map_size, other.map_size);
         stl::swap(length, other.length);
+        stl::swap(data_allocator::get_alloc(), other.get_alloc());
     }
 
 } // namespace stl
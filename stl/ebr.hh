@@ -0,0 +1,308 @@
+//
+// Created by rda on 2024/5/18.
+//
+
+#ifndef MINISTL_EBR_HH
+#define MINISTL_EBR_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.hh"
+#include "construct.hh"
+#include "retired_list.hh"
+
+namespace stl
+{
+    /*
+     * 基于epoch的内存回收（EBR），供并发容器延迟释放已摘下的节点
+     * 全局epoch单调递增，线程访问容器之前用epoch_guard公布自己看到的epoch；
+     * 节点摘下后记录当时的全局epoch e，等到全局epoch达到e + 2时，所有可能看到它的线程都已离开，可以释放
+     * 只有当所有活跃线程都公布了当前epoch时全局epoch才能前进，因此长时间停留的读者会推迟回收
+     * 读者进出临界区只写自己的记录，没有共享的引用计数
+     * */
+    class epoch_domain
+    {
+    private:
+        // 每个线程一条记录，state为0表示不在临界区，否则为(epoch << 1) | 1
+        struct thread_record
+        {
+            std::atomic<uint64_t> state{};
+            std::atomic<bool> in_use{};
+            unsigned nesting{}; // 只由所属线程访问
+            thread_record *next{};
+        };
+
+        // 线程退出时归还记录，记录本身永不释放，之后由新线程复用
+        struct thread_slot
+        {
+            thread_record *rec;
+
+            ~thread_slot()
+            {
+                rec->state.store(0, std::memory_order_release);
+                rec->in_use.store(false, std::memory_order_release);
+            }
+        };
+
+        static inline std::atomic<uint64_t> global_epoch{0};
+        static inline std::atomic<thread_record *> records{nullptr};
+
+        static thread_record *acquire_record()
+        {
+            for (thread_record *r = records.load(std::memory_order_acquire); r; r = r->next)
+            {
+                bool expected = false;
+                if (!r->in_use.load(std::memory_order_relaxed) &&
+                    r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return r;
+            }
+
+            auto r = new thread_record;
+            r->in_use.store(true, std::memory_order_relaxed);
+            r->next = records.load(std::memory_order_relaxed);
+            while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+                ;
+            return r;
+        }
+
+        static thread_record *local()
+        {
+            thread_local thread_slot slot{acquire_record()};
+            return slot.rec;
+        }
+
+    public:
+        // 进入临界区，可以嵌套
+        static void enter()
+        {
+            thread_record *r = local();
+            if (r->nesting++ == 0)
+            {
+                r->state.store(global_epoch.load(std::memory_order_seq_cst) << 1 | 1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        static void leave()
+        {
+            thread_record *r = local();
+            if (--r->nesting == 0)
+                r->state.store(0, std::memory_order_release);
+        }
+
+        static uint64_t current()
+        {
+            return global_epoch.load(std::memory_order_seq_cst);
+        }
+
+        // 所有活跃线程都已公布当前epoch时把它加一，返回之后的全局epoch
+        static uint64_t try_advance()
+        {
+            uint64_t e = global_epoch.load(std::memory_order_seq_cst);
+            for (thread_record *r = records.load(std::memory_order_acquire); r; r = r->next)
+            {
+                uint64_t st = r->state.load(std::memory_order_seq_cst);
+                if ((st & 1) && (st >> 1) != e)
+                    return e;
+            }
+            global_epoch.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+            return global_epoch.load(std::memory_order_seq_cst);
+        }
+    };
+
+    class epoch_guard
+    {
+    public:
+        epoch_guard()
+        {
+            epoch_domain::enter();
+        }
+
+        epoch_guard(const epoch_guard &) = delete;
+
+        epoch_guard &operator=(const epoch_guard &) = delete;
+
+        ~epoch_guard()
+        {
+            epoch_domain::leave();
+        }
+
+        // 与hazard_guard的接口一致，EBR保护整个临界区，不需要逐个公布节点
+        void protect(size_t, const void *) {}
+    };
+
+    // 需要延迟释放的节点的基类，记录摘下时的epoch
+    struct epoch_node
+    {
+        epoch_node *retired_next{};
+        uint64_t retire_epoch{};
+    };
+
+    /*
+     * 一个容器中等待释放的节点，可以被多个线程同时放入
+     * 每放入THRESHOLD个节点尝试推进epoch，把已经安全的节点析构后通过simple_alloc成批归还，
+     * 因此每个节点的回收代价均摊为O(1)
+     * 待释放的节点按容器而不是按线程存放，容器析构时可以用自己的配置器释放全部节点
+     * */
+    template <typename Node, typename Alloc>
+    class epoch_limbo
+    {
+        static_assert(std::is_base_of<epoch_node, Node>::value, "epoch_limbo requires Node derived from epoch_node");
+
+    public:
+        using allocator = simple_alloc<Node, Alloc>;
+
+        static constexpr size_t THRESHOLD = 64;
+
+    private:
+        retired_list<Node, epoch_node, Alloc> retired;
+        std::atomic<size_t> retires{0};
+
+    public:
+        epoch_limbo() = default;
+
+        epoch_limbo(const epoch_limbo &) = delete;
+
+        epoch_limbo &operator=(const epoch_limbo &) = delete;
+
+        // 节点已经从容器中摘下，调用者可以不在epoch_guard中
+        void retire(Node *n, allocator &a)
+        {
+            n->retire_epoch = epoch_domain::current();
+            retired.push(n);
+            if (retires.fetch_add(1, std::memory_order_relaxed) % THRESHOLD == THRESHOLD - 1)
+                collect(a);
+        }
+
+        // 释放retire_epoch + 2 <= 全局epoch的节点，其余的放回
+        void collect(allocator &a)
+        {
+            uint64_t e = epoch_domain::try_advance();
+            retired.release_if(a, retired.take(), [e](const Node *n) { return n->retire_epoch + 2 <= e; });
+        }
+
+        // 不经检查释放全部节点，只能在没有其他线程访问容器时调用
+        void drain(allocator &a)
+        {
+            retired.drain(a);
+        }
+
+        // 等待释放的节点个数，并发时是近似值
+        size_t pending() const noexcept
+        {
+            return retired.pending();
+        }
+    };
+
+    // epoch_ptr保存的值
+    template <typename T>
+    struct epoch_box : epoch_node
+    {
+        T value;
+
+        template <class... Args>
+        explicit epoch_box(Args &&...args) : value(std::forward<Args>(args)...) {}
+    };
+
+    /*
+     * 由EBR管理的单个值，用于读多写少、写者整体替换的场合（RCU）
+     * 读者在epoch_guard中用load取得当前值，不加锁也不修改引用计数，取得的引用在guard结束之前有效；
+     * 写者用store构造新值并发布，旧值在所有可能看到它的读者离开之后释放
+     * 写者之间需要由调用者互斥
+     * */
+    template <typename T, typename Alloc = alloc>
+    class epoch_ptr : protected simple_alloc<epoch_box<T>, Alloc>
+    {
+    private:
+        using box = epoch_box<T>;
+        using box_allocator = simple_alloc<box, Alloc>;
+
+        std::atomic<box *> ptr;
+        epoch_limbo<box, Alloc> limbo;
+
+        template <class... Args>
+        box *create(Args &&...args)
+        {
+            box *b = box_allocator::allocate();
+            try
+            {
+                stl::construct(b, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                box_allocator::deallocate(b);
+                throw;
+            }
+            return b;
+        }
+
+    public:
+        template <class... Args>
+        explicit epoch_ptr(Args &&...args) : ptr(create(std::forward<Args>(args)...)) {}
+
+        epoch_ptr(const epoch_ptr &) = delete;
+
+        epoch_ptr &operator=(const epoch_ptr &) = delete;
+
+        // 不能与其他操作并发
+        ~epoch_ptr()
+        {
+            box *b = ptr.load(std::memory_order_relaxed);
+            stl::destroy(b);
+            box_allocator::deallocate(b);
+            limbo.drain(*this);
+        }
+
+        // 必须在epoch_guard中调用
+        const T &load() const
+        {
+            return ptr.load(std::memory_order_acquire)->value;
+        }
+
+        // 以新的值替换当前值
+        template <class... Args>
+        void store(Args &&...args)
+        {
+            box *old = ptr.exchange(create(std::forward<Args>(args)...), std::memory_order_acq_rel);
+            limbo.retire(old, *this);
+            // 值可能很大（例如整个容器的副本），每次替换之后都尝试回收，而不是攒够THRESHOLD个
+            limbo.collect(*this);
+        }
+
+        // 交换两个当前值，调用者需要同时排除两边的写者；读者看到的总是某一个完整的值
+        void swap(epoch_ptr &other) noexcept
+        {
+            box *mine = ptr.load(std::memory_order_relaxed);
+            ptr.store(other.ptr.load(std::memory_order_relaxed), std::memory_order_release);
+            other.ptr.store(mine, std::memory_order_release);
+        }
+
+        // 已被替换但尚未释放的值的个数
+        size_t pending_reclaim() const noexcept
+        {
+            return limbo.pending();
+        }
+    };
+
+    /*
+     * 供容器选择回收方式的策略类
+     * node为节点的基类，guard在操作期间存在，limbo保存摘下的节点
+     * protects为false表示读到的节点指针不必逐个公布
+     * */
+    struct epoch_reclaimer
+    {
+        static constexpr bool protects = false;
+
+        using node = epoch_node;
+        using guard = epoch_guard;
+
+        template <typename Node, typename Alloc>
+        using limbo = epoch_limbo<Node, Alloc>;
+    };
+} // namespace stl
+
+#endif //MINISTL_EBR_HH
@@ -0,0 +1,841 @@
+//
+// Created by rda on 2024/4/27.
+//
+
+#ifndef MINISTL_FORWARD_LIST_HH
+#define MINISTL_FORWARD_LIST_HH
+
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+#include "alloc.hh"
+#include "iterator.hh"
+#include "construct.hh"
+#include "algobase.hh"
+
+namespace stl
+{
+    /* forward list node base, 只有一个指向后继的指针 */
+    struct forward_list_node_base
+    {
+        forward_list_node_base *next{};
+    };
+
+    /* forward list node, contain 1 pointer and a data item */
+    template <typename T>
+    struct forward_list_node : forward_list_node_base
+    {
+        T data;
+    };
+
+    /* forward list iterator, contain a pointer to node, 尾后迭代器为空指针 */
+    template <typename T>
+    struct forward_list_iterator
+    {
+        using Self = forward_list_iterator<T>;
+        using Node = forward_list_node<T>;
+
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = stl::forward_iterator_tag;
+
+        using value_type = T;
+        using pointer = value_type *;
+        using reference = value_type &;
+
+        forward_list_iterator() = default;
+
+        explicit forward_list_iterator(const forward_list_node_base *n)
+            : node(const_cast<forward_list_node_base *>(n)) {}
+
+        reference
+        operator*() const
+        {
+            return static_cast<Node *>(node)->data;
+        }
+
+        pointer
+        operator->() const
+        {
+            return &(operator*());
+        }
+
+        Self &
+        operator++()
+        {
+            node = node->next;
+            return *this;
+        }
+
+        Self
+        operator++(int)
+        {
+            Self temp = *this;
+            node = node->next;
+            return temp;
+        }
+
+        friend bool
+        operator==(const Self &lhs, const Self &rhs)
+        {
+            return lhs.node == rhs.node;
+        }
+
+        friend bool
+        operator!=(const Self &lhs, const Self &rhs)
+        {
+            return lhs.node != rhs.node;
+        }
+
+        forward_list_node_base *node{};
+    };
+
+    /* forward list const iterator, contain a pointer to node */
+    template <typename T>
+    struct forward_list_const_iterator
+    {
+        using Self = forward_list_const_iterator<T>;
+        using Node = const forward_list_node<T>;
+        using iterator = forward_list_iterator<T>;
+
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = stl::forward_iterator_tag;
+
+        using value_type = T;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        forward_list_const_iterator() = default;
+
+        explicit forward_list_const_iterator(const forward_list_node_base *n) : node(n) {}
+        forward_list_const_iterator(const iterator &iter) : node(iter.node) {}
+
+        reference
+        operator*() const
+        {
+            return static_cast<Node *>(node)->data;
+        }
+
+        pointer
+        operator->() const
+        {
+            return &(operator*());
+        }
+
+        Self &
+        operator++()
+        {
+            node = node->next;
+            return *this;
+        }
+
+        Self
+        operator++(int)
+        {
+            Self temp = *this;
+            node = node->next;
+            return temp;
+        }
+
+        friend bool
+        operator==(const Self &lhs, const Self &rhs)
+        {
+            return lhs.node == rhs.node;
+        }
+
+        friend bool
+        operator!=(const Self &lhs, const Self &rhs)
+        {
+            return lhs.node != rhs.node;
+        }
+
+        const forward_list_node_base *node{};
+    };
+
+    /*
+     * 单向链表，节点只有一个指针，从alloc.hh的配置器（默认为内存池）分配
+     * 与std::forward_list相同，不记录元素个数，所有修改操作都作用于给定位置之后
+     * */
+    template <typename T, typename Alloc = alloc>
+    class forward_list : protected simple_alloc<forward_list_node<T>, Alloc>
+    {
+    public:
+        /* Member types */
+        using value_type = T;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+
+        using iterator = forward_list_iterator<T>;
+        using const_iterator = forward_list_const_iterator<T>;
+
+    protected:
+        using Node = forward_list_node<T>;
+        using node_base = forward_list_node_base;
+        using link_type = Node *;
+        using node_allocator = simple_alloc<Node, Alloc>;
+
+        node_base head; // before_begin()指向的头节点，只使用next
+
+        static node_base *mutable_node(const_iterator pos)
+        {
+            return const_cast<node_base *>(pos.node);
+        }
+
+        static T &value(node_base *n)
+        {
+            return static_cast<link_type>(n)->data;
+        }
+
+        template <class... Args>
+        link_type construct_node(node_batch<Node, Alloc> &batch, Args &&...args)
+        {
+            link_type node = batch.take();
+            try
+            {
+                stl::construct(&node->data, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                batch.put_back(node);
+                throw;
+            }
+            return node;
+        }
+
+        // 在pos之后链接node，返回node
+        static node_base *link_after(node_base *pos, node_base *node)
+        {
+            node->next = pos->next;
+            pos->next = node;
+            return node;
+        }
+
+        // 在pos之后依次插入[first, last)中的元素，前向迭代器的区间成批分配节点，返回最后一个新节点
+        template <typename InputIt>
+        node_base *range_insert_after(node_base *pos, InputIt first, InputIt last)
+        {
+            node_batch<Node, Alloc> batch(*this, stl::batch_distance(first, last));
+            for (; first != last; ++first)
+                pos = link_after(pos, construct_node(batch, *first));
+            return pos;
+        }
+
+        node_base *fill_insert_after(node_base *pos, size_type count, const value_type &value)
+        {
+            node_batch<Node, Alloc> batch(*this, count);
+            while (count--)
+                pos = link_after(pos, construct_node(batch, value));
+            return pos;
+        }
+
+        // 把(before_first, before_last]移动到pos之后
+        static void transfer_after(node_base *pos, node_base *before_first, node_base *before_last)
+        {
+            if (pos == before_first || pos == before_last)
+                return;
+            node_base *first = before_first->next;
+            before_first->next = before_last->next;
+            before_last->next = pos->next;
+            pos->next = first;
+        }
+
+        // 合并两条以空指针结尾的有序链，相等时a中的元素在前
+        template <typename Compare>
+        static node_base *merge_nodes(node_base *a, node_base *b, Compare &comp)
+        {
+            node_base merged;
+            node_base *tail = &merged;
+
+            while (a && b)
+            {
+                if (comp(value(b), value(a)))
+                {
+                    tail->next = b;
+                    b = b->next;
+                }
+                else
+                {
+                    tail->next = a;
+                    a = a->next;
+                }
+                tail = tail->next;
+            }
+            tail->next = a ? a : b;
+            return merged.next;
+        }
+
+    public:
+        /* Member functions */
+
+        /*
+         *  constructor
+         * */
+        forward_list() = default;
+
+        explicit forward_list(const Alloc &a) : node_allocator(a) {}
+
+        explicit forward_list(size_type count, const T &value = T(), const Alloc &a = Alloc()) : node_allocator(a)
+        {
+            fill_insert_after(&head, count, value);
+        }
+
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        forward_list(InputIt first, InputIt last, const Alloc &a = Alloc()) : node_allocator(a)
+        {
+            range_insert_after(&head, first, last);
+        }
+
+        forward_list(std::initializer_list<T> init, const Alloc &a = Alloc())
+            : forward_list(init.begin(), init.end(), a) {}
+
+        forward_list(const forward_list &other) : forward_list(other.begin(), other.end(), other.get_allocator()) {}
+
+        forward_list(forward_list &&other) noexcept : node_allocator(other.get_allocator())
+        {
+            head.next = other.head.next;
+            other.head.next = nullptr;
+        }
+
+        /*
+         *  destructor
+         * */
+        ~forward_list()
+        {
+            clear();
+        }
+
+        /*
+         * assignment operation
+         * */
+        forward_list &operator=(const forward_list &other)
+        {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        forward_list &operator=(forward_list &&other) noexcept
+        {
+            // 节点连同配置器一起转移
+            clear();
+            swap(other);
+            return *this;
+        }
+
+        forward_list &operator=(std::initializer_list<T> ilist)
+        {
+            assign(ilist.begin(), ilist.end());
+            return *this;
+        }
+
+        void assign(size_type count, const value_type &value)
+        {
+            clear();
+            fill_insert_after(&head, count, value);
+        }
+
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            range_insert_after(&head, first, last);
+        }
+
+        void assign(std::initializer_list<T> ilist)
+        {
+            assign(ilist.begin(), ilist.end());
+        }
+
+        allocator_type get_allocator() const noexcept
+        {
+            return node_allocator::get_alloc();
+        }
+
+        /*
+         * Element access
+         * */
+        reference front()
+        {
+            return value(head.next);
+        }
+
+        const_reference front() const
+        {
+            return value(head.next);
+        }
+
+        /*
+         * Iterator
+         * */
+        iterator before_begin() noexcept
+        {
+            return iterator(&head);
+        }
+
+        const_iterator before_begin() const noexcept
+        {
+            return const_iterator(&head);
+        }
+
+        const_iterator cbefore_begin() const noexcept
+        {
+            return const_iterator(&head);
+        }
+
+        iterator begin() noexcept
+        {
+            return iterator(head.next);
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(head.next);
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return const_iterator(head.next);
+        }
+
+        iterator end() noexcept
+        {
+            return iterator(nullptr);
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator(nullptr);
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return const_iterator(nullptr);
+        }
+
+        /*
+         * Capacity
+         * */
+        bool empty() const noexcept
+        {
+            return head.next == nullptr;
+        }
+
+        size_type max_size() const noexcept
+        {
+            return static_cast<size_type>(-1) / sizeof(Node);
+        }
+
+        /*
+         * Modifiers
+         * */
+        void clear() noexcept;
+
+        iterator insert_after(const_iterator pos, const value_type &value)
+        {
+            return emplace_after(pos, value);
+        }
+
+        iterator insert_after(const_iterator pos, value_type &&value)
+        {
+            return emplace_after(pos, std::move(value));
+        }
+
+        iterator insert_after(const_iterator pos, size_type count, const value_type &value)
+        {
+            return iterator(fill_insert_after(mutable_node(pos), count, value));
+        }
+
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        iterator insert_after(const_iterator pos, InputIt first, InputIt last)
+        {
+            return iterator(range_insert_after(mutable_node(pos), first, last));
+        }
+
+        iterator insert_after(const_iterator pos, std::initializer_list<T> ilist)
+        {
+            return insert_after(pos, ilist.begin(), ilist.end());
+        }
+
+        template <class... Args>
+        iterator emplace_after(const_iterator pos, Args &&...args)
+        {
+            node_batch<Node, Alloc> batch(*this, 0);
+            return iterator(link_after(mutable_node(pos), construct_node(batch, std::forward<Args>(args)...)));
+        }
+
+        iterator erase_after(const_iterator pos);
+
+        iterator erase_after(const_iterator pos, const_iterator last);
+
+        void push_front(const value_type &value)
+        {
+            emplace_after(before_begin(), value);
+        }
+
+        void push_front(value_type &&value)
+        {
+            emplace_after(before_begin(), std::move(value));
+        }
+
+        template <class... Args>
+        reference emplace_front(Args &&...args)
+        {
+            return *emplace_after(before_begin(), std::forward<Args>(args)...);
+        }
+
+        void pop_front()
+        {
+            erase_after(before_begin());
+        }
+
+        void resize(size_type count)
+        {
+            resize(count, value_type());
+        }
+
+        void resize(size_type count, const value_type &value);
+
+        void swap(forward_list &other) noexcept
+        {
+            stl::swap(head.next, other.head.next);
+            stl::swap(node_allocator::get_alloc(), other.get_alloc());
+        }
+
+        /*
+         * Operations
+         * */
+        void merge(forward_list &other)
+        {
+            merge(other, std::less<T>());
+        }
+
+        void merge(forward_list &&other)
+        {
+            merge(other, std::less<T>());
+        }
+
+        template <typename Compare>
+        void merge(forward_list &other, Compare comp)
+        {
+            if (&other == this)
+                return;
+            head.next = merge_nodes(head.next, other.head.next, comp);
+            other.head.next = nullptr;
+        }
+
+        template <typename Compare>
+        void merge(forward_list &&other, Compare comp)
+        {
+            merge(other, comp);
+        }
+
+        void splice_after(const_iterator pos, forward_list &other);
+
+        void splice_after(const_iterator pos, forward_list &&other)
+        {
+            splice_after(pos, other);
+        }
+
+        // 移动it之后的一个元素
+        void splice_after(const_iterator pos, forward_list &, const_iterator it)
+        {
+            node_base *before = mutable_node(it);
+            if (before->next)
+                transfer_after(mutable_node(pos), before, before->next);
+        }
+
+        void splice_after(const_iterator pos, forward_list &&other, const_iterator it)
+        {
+            splice_after(pos, other, it);
+        }
+
+        // 移动(first, last)中的元素
+        void splice_after(const_iterator pos, forward_list &, const_iterator first, const_iterator last);
+
+        void splice_after(const_iterator pos, forward_list &&other, const_iterator first, const_iterator last)
+        {
+            splice_after(pos, other, first, last);
+        }
+
+        // val可以是链表中的元素
+        size_type remove(const T &val);
+
+        template <class UnaryPredicate>
+        size_type remove_if(UnaryPredicate p);
+
+        void reverse() noexcept;
+
+        size_type unique()
+        {
+            return unique(std::equal_to<T>());
+        }
+
+        template <typename BinaryPredicate>
+        size_type unique(BinaryPredicate p);
+
+        void sort()
+        {
+            sort(std::less<T>());
+        }
+
+        template <class Compare>
+        void sort(Compare comp);
+    };
+
+    /*
+     * Modifiers
+     * */
+    template <typename T, typename Alloc>
+    void
+    forward_list<T, Alloc>::clear() noexcept
+    {
+        // 节点逐个析构后成批归还
+        node_batch<Node, Alloc> freed(*this, 0);
+        node_base *cur = head.next;
+
+        while (cur)
+        {
+            node_base *next = cur->next;
+            stl::destroy(&value(cur));
+            freed.put_back(static_cast<link_type>(cur));
+            cur = next;
+        }
+        head.next = nullptr;
+    }
+
+    template <typename T, typename Alloc>
+    typename forward_list<T, Alloc>::iterator
+    forward_list<T, Alloc>::erase_after(const_iterator pos)
+    {
+        node_base *prev = mutable_node(pos);
+        link_type node = static_cast<link_type>(prev->next);
+        prev->next = node->next;
+
+        stl::destroy(&node->data);
+        node_allocator::deallocate(node);
+        return iterator(prev->next);
+    }
+
+    template <typename T, typename Alloc>
+    typename forward_list<T, Alloc>::iterator
+    forward_list<T, Alloc>::erase_after(const_iterator pos, const_iterator last)
+    {
+        node_batch<Node, Alloc> freed(*this, 0);
+        node_base *prev = mutable_node(pos);
+        node_base *cur = prev->next;
+
+        while (cur != last.node)
+        {
+            node_base *next = cur->next;
+            stl::destroy(&value(cur));
+            freed.put_back(static_cast<link_type>(cur));
+            cur = next;
+        }
+        prev->next = cur;
+        return iterator(cur);
+    }
+
+    template <typename T, typename Alloc>
+    void
+    forward_list<T, Alloc>::resize(size_type count, const value_type &value)
+    {
+        node_base *prev = &head;
+        while (count && prev->next)
+        {
+            prev = prev->next;
+            --count;
+        }
+
+        if (prev->next)
+            erase_after(const_iterator(prev), end());
+        else
+            fill_insert_after(prev, count, value);
+    }
+
+    /*
+     * Operations
+     * */
+    template <typename T, typename Alloc>
+    void
+    forward_list<T, Alloc>::splice_after(const_iterator pos, forward_list &other)
+    {
+        // this is a undefined behavior if other is itself, but we prevent this behavior
+        if (&other == this || other.empty())
+            return;
+
+        node_base *last = &other.head;
+        while (last->next)
+            last = last->next;
+        transfer_after(mutable_node(pos), &other.head, last);
+    }
+
+    template <typename T, typename Alloc>
+    void
+    forward_list<T, Alloc>::splice_after(const_iterator pos, forward_list &,
+                                         const_iterator first, const_iterator last)
+    {
+        node_base *before_last = mutable_node(first);
+        while (before_last->next != last.node)
+            before_last = before_last->next;
+
+        if (before_last != first.node)
+            transfer_after(mutable_node(pos), mutable_node(first), before_last);
+    }
+
+    template <typename T, typename Alloc>
+    typename forward_list<T, Alloc>::size_type
+    forward_list<T, Alloc>::remove(const T &val)
+    {
+        size_type removed = 0;
+        node_base *prev = &head;
+        node_base *self = nullptr; // 节点中的元素就是val时，最后才删除这个节点，之前的比较仍然用到val
+
+        while (prev->next)
+        {
+            node_base *cur = prev->next;
+            if (value(cur) == val)
+            {
+                if (&value(cur) != &val)
+                {
+                    erase_after(const_iterator(prev));
+                    ++removed;
+                    continue;
+                }
+                self = prev;
+            }
+            prev = cur;
+        }
+        if (self)
+        {
+            erase_after(const_iterator(self));
+            ++removed;
+        }
+        return removed;
+    }
+
+    template <typename T, typename Alloc>
+    template <class UnaryPredicate>
+    typename forward_list<T, Alloc>::size_type
+    forward_list<T, Alloc>::remove_if(UnaryPredicate p)
+    {
+        size_type removed = 0;
+        node_base *prev = &head;
+
+        while (prev->next)
+        {
+            if (p(value(prev->next)))
+            {
+                erase_after(const_iterator(prev));
+                ++removed;
+            }
+            else
+                prev = prev->next;
+        }
+        return removed;
+    }
+
+    template <typename T, typename Alloc>
+    void
+    forward_list<T, Alloc>::reverse() noexcept
+    {
+        node_base *reversed = nullptr;
+        node_base *cur = head.next;
+
+        while (cur)
+        {
+            node_base *next = cur->next;
+            cur->next = reversed;
+            reversed = cur;
+            cur = next;
+        }
+        head.next = reversed;
+    }
+
+    template <typename T, typename Alloc>
+    template <typename BinaryPredicate>
+    typename forward_list<T, Alloc>::size_type
+    forward_list<T, Alloc>::unique(BinaryPredicate p)
+    {
+        size_type removed = 0;
+        node_base *cur = head.next;
+
+        while (cur && cur->next)
+        {
+            if (p(value(cur), value(cur->next)))
+            {
+                erase_after(const_iterator(cur));
+                ++removed;
+            }
+            else
+                cur = cur->next;
+        }
+        return removed;
+    }
+
+    template <typename T, typename Alloc>
+    template <class Compare>
+    void
+    forward_list<T, Alloc>::sort(Compare comp)
+    {
+        // 自底向上的归并排序，bins[i]为空或者是一条长度为2^i的有序链
+        // 只修改指针，不移动元素，稳定
+        node_base *bins[64]{};
+        size_t fill = 0;
+        node_base *cur = head.next;
+
+        while (cur)
+        {
+            node_base *carry = cur;
+            cur = cur->next;
+            carry->next = nullptr;
+
+            size_t i = 0;
+            for (; i < fill && bins[i]; ++i)
+            {
+                carry = merge_nodes(bins[i], carry, comp);
+                bins[i] = nullptr;
+            }
+            bins[i] = carry;
+            if (i == fill)
+                ++fill;
+        }
+
+        // 下标越大的链中的元素越靠前
+        node_base *sorted = nullptr;
+        for (size_t i = 0; i < fill; ++i)
+            sorted = merge_nodes(bins[i], sorted, comp);
+        head.next = sorted;
+    }
+
+    /* Non-member functions */
+    template <typename T, typename Alloc>
+    bool operator==(const forward_list<T, Alloc> &lhs, const forward_list<T, Alloc> &rhs)
+    {
+        auto li = lhs.begin();
+        auto ri = rhs.begin();
+        for (; li != lhs.end() && ri != rhs.end(); ++li, ++ri)
+            if (!(*li == *ri))
+                return false;
+        return li == lhs.end() && ri == rhs.end();
+    }
+
+    template <typename T, typename Alloc>
+    bool operator!=(const forward_list<T, Alloc> &lhs, const forward_list<T, Alloc> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename T, typename Alloc>
+    void swap(forward_list<T, Alloc> &lhs, forward_list<T, Alloc> &rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+} // namespace stl
+
+#endif //MINISTL_FORWARD_LIST_HH
@@ -167,7 +167,7 @@ namespace stl
               typename ExtractKey,
               typename KeyEqual = std::equal_to<Key>,
               typename Alloc = alloc>
-    class Hashtable
+    class Hashtable : protected simple_alloc<Hashtable_node<Value>, Alloc>
     {
         friend class Hashtable_iterator<Key, Value, Hash, ExtractKey, KeyEqual, Alloc>;
         friend class Hashtable_const_iterator<Key, Value, Hash, ExtractKey, KeyEqual, Alloc>;
@@ -198,7 +198,7 @@ namespace stl
         key_equal equals;
         ExtractKey get_key;
 
-        stl::vector<node *> buckets{};
+        stl::vector<node *, Alloc> buckets{}; // 桶数组与节点使用同一个配置器
         size_type num_elements{};
 
         static const int stl_num_primes = 28;
@@ -242,6 +242,22 @@ namespace stl
             hashtable_node_allocator::deallocate(n);
         }
 
+        node *new_node(node_batch<node, Alloc> &batch, const value_type &obj)
+        {
+            node *n = batch.take();
+            n->next = nullptr;
+            try
+            {
+                stl::construct(&n->val, obj);
+            }
+            catch (...)
+            {
+                batch.put_back(n);
+                throw;
+            }
+            return n;
+        }
+
         void initialize_buckets(size_type n)
         {
             const size_type n_buckets = stl_next_prime(n);
@@ -282,20 +298,25 @@ namespace stl
          * */
         Hashtable(size_type n = 0,
                   const Hash &hf = Hash(),
-                  const key_equal &eq = key_equal())
-            : hash(hf), equals(eq), get_key(ExtractKey()), num_elements(n)
+                  const key_equal &eq = key_equal(),
+                  const Alloc &a = Alloc())
+            : hashtable_node_allocator(a), hash(hf), equals(eq), get_key(ExtractKey()), buckets(a)
         {
             initialize_buckets(n);
         }
 
         Hashtable(const Hashtable &other)
+            : hashtable_node_allocator(other.get_alloc()), hash(other.hash), equals(other.equals),
+              get_key(other.get_key), buckets(other.get_alloc())
         {
             copy_from(other);
         }
-        Hashtable(Hashtable &&other) : buckets(std::move(other.buckets)), num_elements(other.num_elements)
+        Hashtable(Hashtable &&other)
+            : hashtable_node_allocator(other.get_alloc()), hash(other.hash), equals(other.equals),
+              get_key(other.get_key), buckets(std::move(other.buckets)), num_elements(other.num_elements)
         {
-            other.buckets.resize(other.buckets.size(), nullptr);
             other.num_elements = 0;
+            other.initialize_buckets(0);
         }
 
         /*
@@ -319,18 +340,9 @@ namespace stl
 
         Hashtable &operator=(Hashtable &&other) noexcept
         {
+            // 节点连同配置器一起转移，other留下本表的空桶数组及原来的配置器
             clear();
-            buckets = std::move(other.buckets);
-
-            size_type bsize = other.buckets.size();
-            for (size_type i = 0; i < bsize; ++i)
-            {
-                buckets[i] = other.buckets[i];
-                other.buckets[i] = nullptr;
-            }
-
-            num_elements = other.num_elements;
-            other.num_elements = 0;
+            swap(other);
 
             return *this;
         }
@@ -407,6 +419,9 @@ namespace stl
          *  */
         void clear() noexcept
         {
+            // 节点逐个析构后成批归还
+            node_batch<node, Alloc> freed(*this, 0);
+
             for (auto &bucket : buckets)
             {
                 node *cur = bucket;
@@ -414,7 +429,8 @@ namespace stl
                 while (cur)
                 {
                     next = cur->next;
-                    delete_node(cur);
+                    stl::destroy(&cur->val);
+                    freed.put_back(cur);
                     cur = next;
                 }
                 bucket = nullptr;
@@ -448,8 +464,26 @@ namespace stl
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
         void insert_unique(InputIt first, InputIt last)
         {
-            while (first != last)
-                insert_unique(*first++);
+            // 前向迭代器的区间只调整一次桶数组，并成批分配节点
+            size_type n = stl::batch_distance(first, last);
+            resize(num_elements + n);
+            node_batch<node, Alloc> batch(*this, n);
+
+            for (; first != last; ++first)
+            {
+                if (!n)
+                    resize(num_elements + 1);
+
+                // 已经存在的元素不需要节点
+                node **pnode = &buckets[bkt_num(*first)];
+                while (*pnode && !equals(get_key((*pnode)->val), get_key(*first)))
+                    pnode = &((*pnode)->next);
+                if (!*pnode)
+                {
+                    *pnode = new_node(batch, *first);
+                    ++num_elements;
+                }
+            }
         }
         void insert_unique(std::initializer_list<value_type> ilist)
         {
@@ -482,8 +516,17 @@ namespace stl
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
         void insert_equal(InputIt first, InputIt last)
         {
-            while (first != last)
-                insert_equal(*first++);
+            // 前向迭代器的区间只调整一次桶数组，并成批分配节点
+            size_type n = stl::batch_distance(first, last);
+            resize(num_elements + n);
+            node_batch<node, Alloc> batch(*this, n);
+
+            for (; first != last; ++first)
+            {
+                if (!n)
+                    resize(num_elements + 1);
+                insert_equal_node(new_node(batch, *first));
+            }
         }
         void insert_equal(std::initializer_list<value_type> ilist)
         {
@@ -522,6 +565,11 @@ namespace stl
         size_type erase(const Key &key);
 
         void swap(Hashtable &other);
+
+        allocator_type get_allocator() const noexcept
+        {
+            return hashtable_node_allocator::get_alloc();
+        }
         void swap(Hashtable &&other) noexcept;
         // node_type extract(const_iterator position);
         // node_type extract(const Key &k);
@@ -616,17 +664,19 @@ namespace stl
         size_type new_bucket_size = stl_next_prime(num_elements_hint);
         if (new_bucket_size <= buckets.size())
             return;
-        stl::vector<node *> new_buckets(new_bucket_size, nullptr);
+        stl::vector<node *, Alloc> new_buckets(new_bucket_size, nullptr, hashtable_node_allocator::get_alloc());
 
+        // 把节点逐个摘下，插入新的桶数组
         for (auto &bucket : buckets)
         {
             node *first = bucket;
 
             while (first)
             {
-                bucket = bucket->next;
-                first->next = buckets[bkt_num(first->val)];
-                buckets[bkt_num(first->val)] = first;
+                bucket = first->next;
+                size_type idx = bkt_num(first->val, new_bucket_size);
+                first->next = new_buckets[idx];
+                new_buckets[idx] = first;
                 first = bucket;
             }
         }
@@ -652,7 +702,10 @@ namespace stl
             ++num_elements;
         }
         else
+        {
             nofound = false;
+            delete_node(n);
+        }
         return {iterator(*pnode, this), nofound};
     }
 
@@ -669,7 +722,7 @@ namespace stl
         node **pnode = &buckets[bkt_idx];
 
         while (*pnode && !equals(n->val, (*pnode)->val))
-            pnode = &((*pnode)->val);
+            pnode = &((*pnode)->next);
         n->next = *pnode;
         *pnode = n;
 
@@ -692,17 +745,18 @@ namespace stl
 
         size_type bsize = htb.buckets.size();
         node *cur, *copy;
+        node_batch<node, Alloc> batch(*this, htb.num_elements);
         for (size_type i = 0; i < bsize; ++i)
         {
             if (cur = htb.buckets[i])
             {
-                copy = new_node(cur->val);
+                copy = new_node(batch, cur->val);
                 buckets[i] = copy;
 
                 while (cur->next)
                 {
                     cur = cur->next;
-                    copy->next = new_node(cur->val);
+                    copy->next = new_node(batch, cur->val);
                     copy = copy->next;
                 }
             }
@@ -784,8 +838,9 @@ namespace stl
     void
     Hashtable<Key, Value, Hash, ExtractKey, KeyEqual, Alloc>::swap(Hashtable &other)
     {
-        std::swap(buckets, other.buckets);
+        buckets.swap(other.buckets);
         std::swap(num_elements, other.num_elements);
+        std::swap(hashtable_node_allocator::get_alloc(), other.get_alloc());
     }
 
     template <typename Key,
@@ -0,0 +1,225 @@
+//
+// Created by rda on 2024/5/25.
+//
+
+#ifndef MINISTL_HAZARD_POINTER_HH
+#define MINISTL_HAZARD_POINTER_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "alloc.hh"
+#include "construct.hh"
+#include "retired_list.hh"
+
+namespace stl
+{
+    /*
+     * 基于hazard pointer的内存回收
+     * 每个线程有SLOTS个hazard槽位，访问节点之前把节点地址写入槽位，再确认节点仍然可以从容器中到达；
+     * 释放之前扫描所有线程的槽位，只释放没有被任何槽位指向的节点
+     * 与EBR不同，一个停住的读者只能阻止它所指向的至多SLOTS个节点被释放，未回收的内存有上界，
+     * 代价是读者每前进一个节点都要写一次槽位并重新验证
+     * hazard_guard可以嵌套，每一层使用自己的SLOTS个槽位，最多嵌套DEPTH层
+     * */
+    class hazard_domain
+    {
+    public:
+        static constexpr size_t SLOTS = 4;
+        static constexpr size_t DEPTH = 4;
+
+    private:
+        friend class hazard_guard;
+
+        struct thread_record
+        {
+            std::atomic<const void *> hazards[SLOTS * DEPTH]{};
+            std::atomic<bool> in_use{};
+            size_t depth{}; // 当前线程中存在的hazard_guard个数，只有拥有记录的线程访问
+            thread_record *next{};
+        };
+
+        // 线程退出时清空槽位并归还记录，记录本身永不释放，之后由新线程复用
+        struct thread_slot
+        {
+            thread_record *rec;
+
+            ~thread_slot()
+            {
+                for (auto &h : rec->hazards)
+                    h.store(nullptr, std::memory_order_release);
+                rec->in_use.store(false, std::memory_order_release);
+            }
+        };
+
+        static inline std::atomic<thread_record *> records{nullptr};
+        static inline std::atomic<size_t> num_of_records{0};
+
+        static thread_record *acquire_record()
+        {
+            for (thread_record *r = records.load(std::memory_order_acquire); r; r = r->next)
+            {
+                bool expected = false;
+                if (!r->in_use.load(std::memory_order_relaxed) &&
+                    r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return r;
+            }
+
+            auto r = new thread_record;
+            r->in_use.store(true, std::memory_order_relaxed);
+            r->next = records.load(std::memory_order_relaxed);
+            while (!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+                ;
+            num_of_records.fetch_add(1, std::memory_order_relaxed);
+            return r;
+        }
+
+        static thread_record *local()
+        {
+            thread_local thread_slot slot{acquire_record()};
+            return slot.rec;
+        }
+
+    public:
+        // 收集所有非空的槽位，排序之后用于二分查找
+        static void collect_hazards(std::vector<const void *> &out)
+        {
+            out.clear();
+            for (thread_record *r = records.load(std::memory_order_acquire); r; r = r->next)
+                for (auto &h : r->hazards)
+                    if (const void *p = h.load(std::memory_order_seq_cst))
+                        out.push_back(p);
+            std::sort(out.begin(), out.end());
+        }
+
+        // 槽位总数的两倍，保证每次扫描至少释放一半的节点
+        static size_t scan_threshold()
+        {
+            size_t h = 2 * SLOTS * DEPTH * num_of_records.load(std::memory_order_relaxed);
+            return h < 64 ? 64 : h;
+        }
+    };
+
+    /*
+     * 当前线程的SLOTS个hazard槽位，析构时清空
+     * 嵌套的hazard_guard使用下一组槽位，例如for_each的回调中再调用contains，
+     * 内层的guard析构时不会清掉外层仍在保护的节点
+     * */
+    class hazard_guard
+    {
+    private:
+        hazard_domain::thread_record *rec;
+        std::atomic<const void *> *hazards;
+
+    public:
+        hazard_guard() : rec(hazard_domain::local())
+        {
+            if (rec->depth == hazard_domain::DEPTH)
+                throw std::length_error("hazard_guard: nested too deeply");
+            hazards = rec->hazards + hazard_domain::SLOTS * rec->depth++;
+        }
+
+        hazard_guard(const hazard_guard &) = delete;
+
+        hazard_guard &operator=(const hazard_guard &) = delete;
+
+        ~hazard_guard()
+        {
+            for (size_t i = 0; i < hazard_domain::SLOTS; ++i)
+                hazards[i].store(nullptr, std::memory_order_release);
+            --rec->depth;
+        }
+
+        // 公布p，调用者随后必须确认p仍然可以到达
+        void protect(size_t slot, const void *p)
+        {
+            hazards[slot].store(p, std::memory_order_seq_cst);
+        }
+    };
+
+    // 需要延迟释放的节点的基类
+    struct hazard_node
+    {
+        hazard_node *retired_next{};
+    };
+
+    /*
+     * 一个容器中等待释放的节点，可以被多个线程同时放入
+     * 个数达到scan_threshold()时扫描所有槽位，把没有被指向的节点析构后通过simple_alloc成批归还
+     * 因此每个容器中未回收的节点不超过阈值加上槽位总数
+     * */
+    template <typename Node, typename Alloc>
+    class hazard_limbo
+    {
+        static_assert(std::is_base_of<hazard_node, Node>::value, "hazard_limbo requires Node derived from hazard_node");
+
+    public:
+        using allocator = simple_alloc<Node, Alloc>;
+
+    private:
+        retired_list<Node, hazard_node, Alloc> retired;
+
+    public:
+        hazard_limbo() = default;
+
+        hazard_limbo(const hazard_limbo &) = delete;
+
+        hazard_limbo &operator=(const hazard_limbo &) = delete;
+
+        // 节点已经从容器中摘下
+        void retire(Node *n, allocator &a)
+        {
+            if (retired.push(n) >= hazard_domain::scan_threshold())
+                scan(a);
+        }
+
+        // 释放没有被任何槽位指向的节点，其余的放回
+        void scan(allocator &a)
+        {
+            // 先取下待释放的节点再收集槽位：取下的节点在此之前都已摘下，
+            // 之后才公布它们的读者一定验证失败；反过来，在收集之后才摘下的节点可能被漏掉
+            hazard_node *chain = retired.take();
+
+            std::vector<const void *> hazards;
+            hazard_domain::collect_hazards(hazards);
+
+            retired.release_if(a, chain, [&hazards](const Node *n) {
+                return !std::binary_search(hazards.begin(), hazards.end(), static_cast<const void *>(n));
+            });
+        }
+
+        // 不经检查释放全部节点，只能在没有其他线程访问容器时调用
+        void drain(allocator &a)
+        {
+            retired.drain(a);
+        }
+
+        // 等待释放的节点个数，并发时是近似值
+        size_t pending() const noexcept
+        {
+            return retired.pending();
+        }
+    };
+
+    /*
+     * 供容器选择回收方式的策略类，与epoch_reclaimer的接口相同
+     * node为节点的基类，guard在操作期间存在，limbo保存摘下的节点
+     * protects为true时，容器每读到一个节点指针都要先protect再验证
+     * */
+    struct hazard_reclaimer
+    {
+        static constexpr bool protects = true;
+
+        using node = hazard_node;
+        using guard = hazard_guard;
+
+        template <typename Node, typename Alloc>
+        using limbo = hazard_limbo<Node, Alloc>;
+    };
+} // namespace stl
+
+#endif //MINISTL_HAZARD_POINTER_HH
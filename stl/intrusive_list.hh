@@ -0,0 +1,363 @@
+//
+// Created by rda on 2024/4/20.
+//
+
+#ifndef MINISTL_INTRUSIVE_LIST_HH
+#define MINISTL_INTRUSIVE_LIST_HH
+
+#include <cstddef>
+
+#include "list.hh"
+
+namespace stl
+{
+    /*
+     * 嵌入在元素中的链表节点，intrusive_list通过它链接元素
+     * 未链接时两个指针为空；复制元素时不复制链接关系，元素析构时自动从链表中摘下
+     * */
+    struct list_hook : list_node_base
+    {
+        list_hook() = default;
+
+        list_hook(const list_hook &) noexcept {}
+
+        list_hook &operator=(const list_hook &) noexcept
+        {
+            return *this;
+        }
+
+        ~list_hook()
+        {
+            unlink();
+        }
+
+        bool is_linked() const noexcept
+        {
+            return next != nullptr;
+        }
+
+        // O(1)地从所在的链表中摘下，不需要知道是哪个链表
+        void unlink() noexcept
+        {
+            if (is_linked())
+            {
+                list_unlink(this);
+                prev = next = nullptr;
+            }
+        }
+    };
+
+    // 由hook的地址换算出元素的地址
+    template <typename T, list_hook T::*Hook>
+    struct intrusive_list_traits
+    {
+        static ptrdiff_t hook_offset() noexcept
+        {
+            // 只计算成员的地址而不访问，编译器会把它折叠为常量
+            alignas(T) unsigned char probe[sizeof(T)];
+            const T *obj = reinterpret_cast<const T *>(probe);
+            return reinterpret_cast<const char *>(&(obj->*Hook)) - reinterpret_cast<const char *>(obj);
+        }
+
+        static T *value(const list_node_base *n) noexcept
+        {
+            auto p = reinterpret_cast<char *>(const_cast<list_node_base *>(n));
+            return reinterpret_cast<T *>(p - hook_offset());
+        }
+
+        static list_hook *hook(T &value) noexcept
+        {
+            return &(value.*Hook);
+        }
+    };
+
+    /*
+     * 侵入式双向链表，元素通过成员Hook链接，插入与删除都不分配内存
+     * 链表不拥有元素，元素的生命周期由调用者管理；链表析构或clear时只摘下元素
+     * 迭代器与拼接沿用list.hh中的实现
+     * 为了让list_hook::unlink可以在不知道链表的情况下摘下元素，链表不记录元素个数，size()为O(n)
+     * */
+    template <typename T, list_hook T::*Hook>
+    class intrusive_list
+    {
+    public:
+        /* Member types */
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+
+        using traits = intrusive_list_traits<T, Hook>;
+        using iterator = list_iterator<T, traits>;
+        using const_iterator = list_const_iterator<T, traits>;
+        using reverse_iterator = stl::reverse_iterator<iterator>;
+        using const_reverse_iterator = stl::reverse_iterator<const_iterator>;
+
+    private:
+        list_node_base head{&head, &head};
+
+        // 接管other的全部元素，调用前本链表为空
+        void take(intrusive_list &other) noexcept
+        {
+            list_transfer(&head, other.head.next, &other.head);
+        }
+
+    public:
+        /*
+         *  constructor
+         * */
+        intrusive_list() = default;
+
+        intrusive_list(const intrusive_list &) = delete;
+
+        intrusive_list(intrusive_list &&other) noexcept
+        {
+            take(other);
+        }
+
+        /*
+         *  destructor
+         * */
+        ~intrusive_list()
+        {
+            clear();
+        }
+
+        /*
+         * assignment operation
+         * */
+        intrusive_list &operator=(const intrusive_list &) = delete;
+
+        intrusive_list &operator=(intrusive_list &&other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                take(other);
+            }
+            return *this;
+        }
+
+        /*
+         * Element access
+         * */
+        reference front()
+        {
+            return *begin();
+        }
+
+        const_reference front() const
+        {
+            return *begin();
+        }
+
+        reference back()
+        {
+            return *--end();
+        }
+
+        const_reference back() const
+        {
+            return *--end();
+        }
+
+        /*
+         * Iterator
+         * */
+        iterator begin() noexcept
+        {
+            return iterator(head.next);
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(head.next);
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        iterator end() noexcept
+        {
+            return iterator(&head);
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator(&head);
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        // 由元素直接得到指向它的迭代器，元素必须在本链表中
+        iterator iterator_to(reference value) noexcept
+        {
+            return iterator(traits::hook(value));
+        }
+
+        const_iterator iterator_to(const_reference value) const noexcept
+        {
+            return const_iterator(traits::hook(const_cast<reference>(value)));
+        }
+
+        /*
+         * Capacity
+         * */
+        bool empty() const noexcept
+        {
+            return head.next == &head;
+        }
+
+        size_type size() const noexcept
+        {
+            return stl::distance(begin(), end());
+        }
+
+        /*
+         * Modifiers
+         * */
+        // 摘下所有元素，元素本身不受影响
+        void clear() noexcept
+        {
+            list_node_base *cur = head.next;
+            while (cur != &head)
+            {
+                list_node_base *next = cur->next;
+                cur->prev = cur->next = nullptr;
+                cur = next;
+            }
+            head.prev = head.next = &head;
+        }
+
+        // value不能已经在某个链表中
+        iterator insert(const_iterator pos, reference value) noexcept
+        {
+            list_hook *hook = traits::hook(value);
+            list_link_before(const_cast<list_node_base *>(pos.node), hook);
+            return iterator(hook);
+        }
+
+        iterator erase(const_iterator pos) noexcept
+        {
+            auto hook = static_cast<list_hook *>(const_cast<list_node_base *>(pos.node));
+            iterator next(hook->next);
+            hook->unlink();
+            return next;
+        }
+
+        iterator erase(const_iterator first, const_iterator last) noexcept
+        {
+            while (first != last)
+                first = erase(first);
+            return iterator(last.node);
+        }
+
+        // 从链表中摘下value
+        void remove(reference value) noexcept
+        {
+            traits::hook(value)->unlink();
+        }
+
+        void push_back(reference value) noexcept
+        {
+            insert(end(), value);
+        }
+
+        void pop_back() noexcept
+        {
+            erase(--end());
+        }
+
+        void push_front(reference value) noexcept
+        {
+            insert(begin(), value);
+        }
+
+        void pop_front() noexcept
+        {
+            erase(begin());
+        }
+
+        void swap(intrusive_list &other) noexcept
+        {
+            intrusive_list temp(std::move(other));
+            other.take(*this);
+            take(temp);
+        }
+
+        /*
+         * Operations
+         * */
+        void splice(const_iterator pos, intrusive_list &other) noexcept
+        {
+            if (&other != this)
+                list_transfer(const_cast<list_node_base *>(pos.node), other.head.next, &other.head);
+        }
+
+        void splice(const_iterator pos, intrusive_list &other, const_iterator it) noexcept
+        {
+            const_iterator next = it;
+            ++next;
+            if (pos == it || pos == next)
+                return;
+            list_transfer(const_cast<list_node_base *>(pos.node), const_cast<list_node_base *>(it.node),
+                          const_cast<list_node_base *>(next.node));
+        }
+
+        // pos不能在[first, last)之中
+        void splice(const_iterator pos, intrusive_list &other, const_iterator first, const_iterator last) noexcept
+        {
+            list_transfer(const_cast<list_node_base *>(pos.node), const_cast<list_node_base *>(first.node),
+                          const_cast<list_node_base *>(last.node));
+        }
+
+        void reverse() noexcept
+        {
+            list_node_base *cur = &head;
+            do
+            {
+                list_node_base *next = cur->next;
+                cur->next = cur->prev;
+                cur->prev = next;
+                cur = next;
+            } while (cur != &head);
+        }
+    };
+
+    template <typename T, list_hook T::*Hook>
+    void swap(intrusive_list<T, Hook> &lhs, intrusive_list<T, Hook> &rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+} // namespace stl
+
+#endif //MINISTL_INTRUSIVE_LIST_HH
@@ -521,6 +521,39 @@ namespace stl
         return distance_aux(first, last, iterator_category(first));
     }
 
+    /*
+     * @brief   预先知道区间长度时才计算“距离”，输入迭代器只能遍历一次，返回0
+     * @param   first   第一个迭代器
+     * @param   last    第二个迭代器
+     * @return  前向迭代器之间的距离，或者0
+     * */
+    template <typename InputIterator>
+    inline size_t
+    batch_distance_aux(InputIterator, InputIterator, input_iterator_tag)
+    {
+        return 0;
+    }
+
+    template <typename ForwardIterator>
+    inline size_t
+    batch_distance_aux(ForwardIterator first, ForwardIterator last, forward_iterator_tag)
+    {
+        return stl::distance(first, last);
+    }
+
+    /*
+     * @brief   容器成批分配节点时使用的区间长度
+     * @param   first   第一个迭代器
+     * @param   last    第二个迭代器
+     * @return  前向迭代器之间的距离，输入迭代器返回0
+     * */
+    template <typename InputIterator>
+    inline size_t
+    batch_distance(InputIterator first, InputIterator last)
+    {
+        return batch_distance_aux(first, last, iterator_category(first));
+    }
+
     /*
      * @brief   输入迭代器向前自增指定次数，逐步自增
      * @param   first   待自增的迭代器
@@ -12,12 +12,53 @@
 
 namespace stl
 {
+    /* list node base, contain 2 pointer, 链接与拼接只依赖这一部分 */
+    struct list_node_base
+    {
+        list_node_base *prev{};
+        list_node_base *next{};
+    };
+
+    // 把node链接到pos之前
+    inline void list_link_before(list_node_base *pos, list_node_base *node) noexcept
+    {
+        node->prev = pos->prev;
+        pos->prev->next = node;
+
+        node->next = pos;
+        pos->prev = node;
+    }
+
+    // 把node从所在的链表中摘下，node的指针保持不变
+    inline void list_unlink(list_node_base *node) noexcept
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+    }
+
+    // 把[first, last)移动到pos之前，三者可以属于不同的链表
+    inline void list_transfer(list_node_base *pos, list_node_base *first, list_node_base *last) noexcept
+    {
+        if (pos != last && first != last)
+        {
+            auto prev_node = pos->prev;
+            auto last_prev_node = last->prev;
+
+            // 关联first的prev节点与last节点
+            first->prev->next = last;
+            last->prev = first->prev;
+
+            prev_node->next = first;
+            first->prev = prev_node;
+            last_prev_node->next = pos;
+            pos->prev = last_prev_node;
+        }
+    }
+
     /* list node, contain 2 pointer and a data item */
     template <typename T>
-    struct list_node
+    struct list_node : list_node_base
     {
-        list_node *prev{};
-        list_node *next{};
         T data{};
 
         list_node()
@@ -26,12 +67,22 @@ namespace stl
         }
     };
 
-    /* list iterator, contain a pointer to node */
+    // 从节点取得元素，list的元素保存在list_node中
     template <typename T>
+    struct list_node_traits
+    {
+        static T *value(const list_node_base *n) noexcept
+        {
+            return &static_cast<list_node<T> *>(const_cast<list_node_base *>(n))->data;
+        }
+    };
+
+    /* list iterator, contain a pointer to node */
+    template <typename T, typename NodeTraits = list_node_traits<T>>
     struct list_iterator
     {
-        using Self = list_iterator<T>;
-        using Node = list_node<T>;
+        using Self = list_iterator<T, NodeTraits>;
+        using Node = list_node_base;
 
         using difference_type = std::ptrdiff_t;
         using iterator_category = stl::bidirectional_iterator_tag;
@@ -42,13 +93,13 @@ namespace stl
 
         list_iterator() = default;
 
-        explicit list_iterator(const list_node<T> *n)
+        explicit list_iterator(const list_node_base *n)
             : node(const_cast<Node *>(n)) {}
 
         reference
         operator*() const
         {
-            return node->data;
+            return *NodeTraits::value(node);
         }
 
         pointer
@@ -103,12 +154,12 @@ namespace stl
     };
 
     /* list const iterator, contain a pointer to node */
-    template <typename T>
+    template <typename T, typename NodeTraits = list_node_traits<T>>
     struct list_const_iterator
     {
-        using Self = list_const_iterator<T>;
-        using Node = const list_node<T>;
-        using iterator = list_iterator<T>;
+        using Self = list_const_iterator<T, NodeTraits>;
+        using Node = const list_node_base;
+        using iterator = list_iterator<T, NodeTraits>;
 
         using difference_type = std::ptrdiff_t;
         using iterator_category = stl::bidirectional_iterator_tag;
@@ -119,13 +170,13 @@ namespace stl
 
         list_const_iterator() = default;
 
-        explicit list_const_iterator(const list_node<T> *n) : node(n) {}
+        explicit list_const_iterator(const list_node_base *n) : node(n) {}
         list_const_iterator(const iterator &iter) : node(iter.node) {}
 
         reference
         operator*() const
         {
-            return const_cast<reference>(node->data);
+            return *NodeTraits::value(node);
         }
 
         pointer
@@ -176,11 +227,11 @@ namespace stl
             return lhs.node != rhs.node;
         }
 
-        const Node *node{};
+        Node *node{};
     };
 
     template <typename T, typename Alloc = alloc>
-    class list
+    class list : protected simple_alloc<list_node<T>, Alloc>
     {
     public:
         /* Member types */
@@ -229,6 +280,52 @@ namespace stl
             put_node(p);
         }
 
+        // 在pos之前插入count个value，节点成批分配，返回第一个新节点
+        link_type fill_insert(link_type pos, size_type count, const value_type &value)
+        {
+            node_batch<Node, Alloc> batch(*this, count);
+            list_node_base *prev = pos->prev;
+
+            while (count--)
+                link_node(pos, construct_node(batch, value));
+            return link_type(prev->next);
+        }
+
+        // 在pos之前依次插入[first, last)中的元素，前向迭代器的区间成批分配节点，返回第一个新节点
+        template <typename InputIt>
+        link_type range_insert(link_type pos, InputIt first, InputIt last)
+        {
+            node_batch<Node, Alloc> batch(*this, stl::batch_distance(first, last));
+            list_node_base *prev = pos->prev;
+
+            for (; first != last; ++first)
+                link_node(pos, construct_node(batch, *first));
+            return link_type(prev->next);
+        }
+
+        template <class... Args>
+        link_type construct_node(node_batch<Node, Alloc> &batch, Args &&...args)
+        {
+            link_type node = batch.take();
+            try
+            {
+                stl::construct(&node->data, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                batch.put_back(node);
+                throw;
+            }
+            return node;
+        }
+
+        // 把node链接到pos之前
+        void link_node(link_type pos, link_type node)
+        {
+            list_link_before(pos, node);
+            ++num_of_nodes;
+        }
+
         void empty_initialize()
         {
             head = get_node();
@@ -237,20 +334,7 @@ namespace stl
 
         void transfer(iterator pos, iterator first, iterator last)
         {
-            if (pos != last && first != last)
-            {
-                auto prev_node = (link_type)(pos.node)->prev;
-                auto last_prev_node = (link_type)(last.node)->prev;
-
-                // 关联first的prev节点与last节点
-                first.node->prev->next = last.node;
-                last.node->prev = first.node->prev;
-
-                prev_node->next = first.node;
-                first.node->prev = prev_node;
-                last_prev_node->next = pos.node;
-                pos.node->prev = last_prev_node;
-            }
+            list_transfer(pos.node, first.node, last.node);
         }
 
     public:
@@ -264,33 +348,23 @@ namespace stl
             empty_initialize();
         }
 
-        explicit list(size_type count, const T &value = T());
-
-        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        list(InputIt first, InputIt last)
+        explicit list(const Alloc &a) : list_node_allocator(a)
         {
             empty_initialize();
+        }
 
-            while (first != last)
-            {
-                link_type node = create_node(*first);
-
-                auto end = head->prev;
-
-                node->prev = end;
-                end->next = node;
-
-                node->next = head;
-                head->prev = node;
+        explicit list(size_type count, const T &value = T(), const Alloc &a = Alloc());
 
-                ++first;
-                ++num_of_nodes;
-            }
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        list(InputIt first, InputIt last, const Alloc &a = Alloc()) : list_node_allocator(a)
+        {
+            empty_initialize();
+            range_insert(head, first, last);
         }
 
         list(const list &other);
         list(list &&other);
-        list(std::initializer_list<T> init);
+        list(std::initializer_list<T> init, const Alloc &a = Alloc());
 
         /*
          *  destructor
@@ -310,30 +384,15 @@ namespace stl
         void
         assign(InputIt first, InputIt last)
         {
-            erase(cbegin(), cend());
-            num_of_nodes = 0;
-
-            while (first != last)
-            {
-                link_type node = create_node(*first);
-                auto end = head->prev;
-
-                node->prev = end;
-                end->next = node;
-
-                node->next = head;
-                head->prev = node;
-
-                ++first;
-                ++num_of_nodes;
-            }
+            clear();
+            range_insert(head, first, last);
         }
 
         void assign(std::initializer_list<T> ilist);
 
         allocator_type get_allocator() const noexcept
         {
-            return allocator_type();
+            return list_node_allocator::get_alloc();
         }
 
         /*
@@ -383,20 +442,7 @@ namespace stl
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
         iterator insert(const_iterator pos, InputIt first, InputIt last)
         {
-            if (first != last)
-            {
-                iterator rt = insert(pos, *first++);
-                pos = const_iterator(rt.node);
-                ++pos;
-                auto inserter = stl::insert_iterator(*this, iterator(pos.node));
-
-                while (first != last)
-                    *inserter = *first++;
-
-                return rt;
-            }
-            else
-                return iterator(pos.node);
+            return iterator(range_insert(link_type(pos.node), first, last));
         }
 
         iterator insert(const_iterator pos, std::initializer_list<value_type> ilist);
@@ -471,16 +517,14 @@ namespace stl
      *  constructor
      * */
     template <typename T, typename Alloc>
-    list<T, Alloc>::list(size_type count, const T &value)
+    list<T, Alloc>::list(size_type count, const T &value, const Alloc &a) : list_node_allocator(a)
     {
         empty_initialize();
-
-        while (count--)
-            insert(cend(), value);
+        fill_insert(head, count, value);
     }
 
     template <typename T, typename Alloc>
-    list<T, Alloc>::list(const list &other)
+    list<T, Alloc>::list(const list &other) : list_node_allocator(other.get_alloc())
     {
         empty_initialize();
 
@@ -501,10 +545,7 @@ namespace stl
 
         // 如果节点数不够，则插入新节点
         if (cbg != ced)
-        {
-            while (cbg != ced)
-                push_back(*cbg++);
-        }
+            range_insert(head, cbg, ced);
         else if (bg != ed) // 如果有多余节点则释放掉
             erase(const_iterator(bg), const_iterator(ed));
 
@@ -513,7 +554,7 @@ namespace stl
     }
 
     template <typename T, typename Alloc>
-    list<T, Alloc>::list(list &&other)
+    list<T, Alloc>::list(list &&other) : list_node_allocator(other.get_alloc())
     {
         empty_initialize();
 
@@ -524,7 +565,7 @@ namespace stl
     }
 
     template <typename T, typename Alloc>
-    list<T, Alloc>::list(std::initializer_list<T> init) : list(init.begin(), init.end())
+    list<T, Alloc>::list(std::initializer_list<T> init, const Alloc &a) : list(init.begin(), init.end(), a)
     {
     }
 
@@ -557,10 +598,8 @@ namespace stl
         // Free old storage
         clear();
 
-        transfer(end(), other.begin(), other.end());
-
-        num_of_nodes = other.num_of_nodes;
-        other.num_of_nodes = 0;
+        // 节点连同配置器一起转移，other留下本链表的头节点及原来的配置器
+        swap(other);
 
         return *this;
     }
@@ -578,9 +617,7 @@ namespace stl
     list<T, Alloc>::assign(size_type count, const value_type &value)
     {
         clear();
-
-        while (count--)
-            insert(end(), value);
+        fill_insert(head, count, value);
     }
 
     template <typename T, typename Alloc>
@@ -739,7 +776,18 @@ namespace stl
     void
     list<T, Alloc>::clear() noexcept
     {
-        erase(cbegin(), cend());
+        // 节点逐个析构后成批归还
+        node_batch<Node, Alloc> freed(*this, 0);
+        link_type cur = link_type(head->next);
+
+        while (cur != head)
+        {
+            link_type next = link_type(cur->next);
+            stl::destroy(&cur->data);
+            freed.put_back(cur);
+            cur = next;
+        }
+        head->prev = head->next = head;
         // update number of nodes
         num_of_nodes = 0;
     }
@@ -760,11 +808,7 @@ namespace stl
 
         auto node = create_node(std::forward<value_type>(value));
 
-        node->prev = cur->prev;
-        cur->prev->next = node;
-
-        node->next = cur;
-        cur->prev = node;
+        list_link_before(cur, node);
 
         // update number of nodes
         ++num_of_nodes;
@@ -776,11 +820,7 @@ namespace stl
     typename list<T, Alloc>::iterator
     list<T, Alloc>::insert(const_iterator pos, size_type count, const value_type &value)
     {
-        iterator it = iterator(pos.node);
-        while (count--)
-            pos = const_iterator(insert(pos, value).node);
-
-        return iterator(pos.node);
+        return iterator(fill_insert(link_type(pos.node), count, value));
     }
 
     template <typename T, typename Alloc>
@@ -802,11 +842,9 @@ namespace stl
     typename list<T, Alloc>::iterator
     list<T, Alloc>::erase(const_iterator pos)
     {
-        auto prev_node = link_type(pos.node)->prev;
-        auto next_node = link_type(pos.node)->next;
+        auto next_node = pos.node->next;
 
-        prev_node->next = next_node;
-        next_node->prev = prev_node;
+        list_unlink(const_cast<list_node_base *>(pos.node));
 
         destroy_node((link_type)(pos.node));
 
@@ -919,6 +957,7 @@ namespace stl
     {
         stl::swap(other.head, head);
         stl::swap(other.num_of_nodes, num_of_nodes);
+        stl::swap(other.get_alloc(), list_node_allocator::get_alloc());
     }
 
     /*
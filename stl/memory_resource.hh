@@ -0,0 +1,194 @@
+//
+// Created by rda on 2024/3/16.
+//
+
+#ifndef MINISTL_MEMORY_RESOURCE_HH
+#define MINISTL_MEMORY_RESOURCE_HH
+
+#include <atomic>
+#include <new>
+
+#include "alloc.hh"
+#include "arena.hh"
+
+namespace stl
+{
+    /*
+     * 内存资源：可以在运行时替换的配置器后端
+     * 使用者通过polymorphic_alloc持有指向内存资源的指针，同一类型的容器可以使用不同的内存资源，
+     * 例如为每个租户创建各自的内存池
+     * */
+    class memory_resource
+    {
+    public:
+        virtual ~memory_resource() = default;
+
+        void *allocate(size_t bytes, size_t align = ALIGN)
+        {
+            return do_allocate(bytes, align);
+        }
+
+        void deallocate(void *p, size_t bytes, size_t align = ALIGN)
+        {
+            do_deallocate(p, bytes, align);
+        }
+
+        // 一个内存资源分配的内存可以由另一个回收时二者相等
+        bool is_equal(const memory_resource &other) const noexcept
+        {
+            return this == &other || do_is_equal(other);
+        }
+
+    protected:
+        virtual void *do_allocate(size_t bytes, size_t align) = 0;
+
+        virtual void do_deallocate(void *p, size_t bytes, size_t align) = 0;
+
+        virtual bool do_is_equal(const memory_resource &other) const noexcept = 0;
+    };
+
+    inline bool operator==(const memory_resource &lhs, const memory_resource &rhs) noexcept
+    {
+        return lhs.is_equal(rhs);
+    }
+
+    inline bool operator!=(const memory_resource &lhs, const memory_resource &rhs) noexcept
+    {
+        return !lhs.is_equal(rhs);
+    }
+
+    // 以第二级配置器为后端的内存资源
+    class alloc_resource : public memory_resource
+    {
+    protected:
+        void *do_allocate(size_t bytes, size_t align) override
+        {
+            return alloc::allocate(bytes, align);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t align) override
+        {
+            alloc::deallocate(p, bytes, align);
+        }
+
+        bool do_is_equal(const memory_resource &other) const noexcept override
+        {
+            return dynamic_cast<const alloc_resource *>(&other) != nullptr;
+        }
+    };
+
+    // 以arena为后端的内存资源，回收什么也不做，内存在reset或析构时一次性释放
+    class arena_resource : public memory_resource
+    {
+    private:
+        arena pool;
+
+    public:
+        explicit arena_resource(size_t initial_size = 4096) : pool(initial_size) {}
+
+        arena &get_arena()
+        {
+            return pool;
+        }
+
+        void reset()
+        {
+            pool.reset();
+        }
+
+    protected:
+        void *do_allocate(size_t bytes, size_t align) override
+        {
+            return pool.allocate(bytes, align);
+        }
+
+        void do_deallocate(void *p, size_t bytes, size_t align) override
+        {
+            (void) align;
+            pool.deallocate(p, bytes);
+        }
+
+        bool do_is_equal(const memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    // 以第二级配置器为后端的内存资源的唯一实例
+    memory_resource *alloc_resource_instance() noexcept
+    {
+        static alloc_resource instance;
+        return &instance;
+    }
+
+    // 为nullptr时表示alloc_resource_instance()
+    std::atomic<memory_resource *> default_resource_ptr{};
+
+    // 默认构造的polymorphic_alloc使用的内存资源
+    memory_resource *get_default_resource() noexcept
+    {
+        memory_resource *r = default_resource_ptr.load(std::memory_order_acquire);
+        return r ? r : alloc_resource_instance();
+    }
+
+    // 设置默认的内存资源，传入nullptr时恢复初始值，返回之前的默认内存资源
+    memory_resource *set_default_resource(memory_resource *r) noexcept
+    {
+        memory_resource *old = default_resource_ptr.exchange(r, std::memory_order_acq_rel);
+        return old ? old : alloc_resource_instance();
+    }
+
+
+    /*
+     * 持有内存资源指针的配置器，可以作为各个容器的Alloc模板参数
+     * 容器保存配置器实例，因此同一类型的两个容器可以使用不同的内存资源
+     * 容器移动赋值与交换时配置器随元素一起转移，复制构造时复制配置器
+     * */
+    class polymorphic_alloc
+    {
+    private:
+        memory_resource *resource;
+
+    public:
+        polymorphic_alloc() noexcept : resource(get_default_resource()) {}
+
+        polymorphic_alloc(memory_resource *r) noexcept : resource(r) {}
+
+        void *allocate(size_t n)
+        {
+            return resource->allocate(n);
+        }
+
+        void *allocate(size_t n, size_t align)
+        {
+            return resource->allocate(n, align < ALIGN ? ALIGN : align);
+        }
+
+        void deallocate(void *p, size_t n)
+        {
+            resource->deallocate(p, n);
+        }
+
+        void deallocate(void *p, size_t n, size_t align)
+        {
+            resource->deallocate(p, n, align < ALIGN ? ALIGN : align);
+        }
+
+        memory_resource *get_resource() const noexcept
+        {
+            return resource;
+        }
+    };
+
+    inline bool operator==(const polymorphic_alloc &lhs, const polymorphic_alloc &rhs) noexcept
+    {
+        return *lhs.get_resource() == *rhs.get_resource();
+    }
+
+    inline bool operator!=(const polymorphic_alloc &lhs, const polymorphic_alloc &rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+}
+
+#endif //MINISTL_MEMORY_RESOURCE_HH
@@ -0,0 +1,445 @@
+//
+// Created by rda on 2024/4/6.
+//
+
+#ifndef MINISTL_MMAP_VECTOR_HH
+#define MINISTL_MMAP_VECTOR_HH
+
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "iterator.hh"
+
+namespace stl
+{
+    /*
+     * 以内存映射文件为存储空间的vector，文件的内容就是依次排列的T，没有任何头部
+     * 只读打开时直接映射整个文件，启动时不必读取与复制，页缓存由多个进程共享
+     * 追加模式下文件按容量预先扩展，关闭时截断为实际的元素个数；扩容时通过mremap重新映射，
+     * 与vector一样，此时指针与迭代器失效
+     * T必须可以平凡复制，且文件的大小必须是sizeof(T)的整数倍
+     * */
+    template <typename T>
+    class mmap_vector
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "mmap_vector requires a trivially copyable T");
+
+    public:
+        /* Member types */
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+
+        using iterator = value_type *;
+        using const_iterator = const value_type *;
+        using reverse_iterator = stl::reverse_iterator<iterator>;
+        using const_reverse_iterator = stl::reverse_iterator<const_iterator>;
+
+        enum open_mode
+        {
+            read_only, // 只读映射已有的文件
+            appendable // 可读写，文件不存在时创建，可以在末尾追加元素
+        };
+
+    private:
+        int fd = -1;
+        open_mode mode = read_only;
+        iterator start{};
+        iterator finish{};
+        iterator end_of_storage{}; // 映射的范围，追加模式下即文件当前的大小
+
+        static size_t page_size()
+        {
+            static const size_t page = sysconf(_SC_PAGESIZE);
+            return page;
+        }
+
+        [[noreturn]] static void throw_errno(const char *what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // 把文件扩展为new_cap个元素并重新映射
+        void remap(size_type new_cap);
+
+        // 修改元素个数的操作只能用于追加模式
+        void check_appendable() const
+        {
+            if (fd < 0 || mode != appendable)
+                throw std::logic_error("mmap_vector: not opened for append");
+        }
+
+        // 只读模式下的映射不可写，不能取得可以修改元素的引用、指针或迭代器
+        void check_writable() const
+        {
+            if (fd >= 0 && mode != appendable)
+                throw std::logic_error("mmap_vector: mapping is read-only");
+        }
+
+    public:
+        /*
+         * constructor
+         * */
+        mmap_vector() = default;
+
+        explicit mmap_vector(const char *path, open_mode m = read_only)
+        {
+            open(path, m);
+        }
+
+        mmap_vector(const mmap_vector &) = delete;
+
+        mmap_vector(mmap_vector &&other) noexcept
+            : fd(other.fd), mode(other.mode), start(other.start), finish(other.finish),
+              end_of_storage(other.end_of_storage)
+        {
+            other.fd = -1;
+            other.start = other.finish = other.end_of_storage = nullptr;
+        }
+
+        /*
+         *  destructor
+         * */
+        ~mmap_vector()
+        {
+            close();
+        }
+
+        /*
+         * assignment operation
+         * */
+        mmap_vector &operator=(const mmap_vector &) = delete;
+
+        mmap_vector &operator=(mmap_vector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                fd = other.fd;
+                mode = other.mode;
+                start = other.start;
+                finish = other.finish;
+                end_of_storage = other.end_of_storage;
+                other.fd = -1;
+                other.start = other.finish = other.end_of_storage = nullptr;
+            }
+            return *this;
+        }
+
+        /*
+         * File operation
+         * */
+        void open(const char *path, open_mode m = read_only);
+
+        // 追加模式下把文件截断为实际的元素个数，然后解除映射并关闭文件
+        void close() noexcept;
+
+        bool is_open() const noexcept
+        {
+            return fd >= 0;
+        }
+
+        // 把修改写回文件
+        void sync();
+
+        /*
+         * Element access
+         * */
+        reference at(size_type pos)
+        {
+            check_writable();
+            return const_cast<reference>(static_cast<const mmap_vector &>(*this).at(pos));
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if (pos >= size())
+                throw std::out_of_range("mmap_vector::at");
+            return start[pos];
+        }
+
+        // 只读模式下的映射不可写，只能通过const引用访问，非const的访问会抛出异常
+        reference operator[](size_type pos)
+        {
+            check_writable();
+            return start[pos];
+        }
+
+        const_reference operator[](size_type pos) const
+        {
+            return start[pos];
+        }
+
+        reference front()
+        {
+            check_writable();
+            return *start;
+        }
+
+        const_reference front() const
+        {
+            return *start;
+        }
+
+        reference back()
+        {
+            check_writable();
+            return *(finish - 1);
+        }
+
+        const_reference back() const
+        {
+            return *(finish - 1);
+        }
+
+        T *data()
+        {
+            check_writable();
+            return start;
+        }
+
+        const T *data() const noexcept
+        {
+            return start;
+        }
+
+        /*
+         * Iterator function
+         * */
+        iterator begin()
+        {
+            check_writable();
+            return start;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return start;
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return start;
+        }
+
+        iterator end()
+        {
+            check_writable();
+            return finish;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return finish;
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return finish;
+        }
+
+        reverse_iterator rbegin()
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend()
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        /*
+         * Capacity
+         * */
+        bool empty() const noexcept
+        {
+            return start == finish;
+        }
+
+        size_type size() const noexcept
+        {
+            return size_type(finish - start);
+        }
+
+        size_type capacity() const noexcept
+        {
+            return size_type(end_of_storage - start);
+        }
+
+        void reserve(size_type new_cap)
+        {
+            check_appendable();
+            if (new_cap > capacity())
+                remap(new_cap);
+        }
+
+        /*
+         * Modifiers，只能用于追加模式
+         * */
+        void push_back(const T &elem)
+        {
+            check_appendable();
+            if (finish == end_of_storage)
+            {
+                T value = elem; // elem可能是映射中的元素
+                remap(size() ? 2 * size() : (sizeof(T) < page_size() ? page_size() / sizeof(T) : 1));
+                *finish++ = value;
+                return;
+            }
+            *finish++ = elem;
+        }
+
+        void append(const T *first, const T *last)
+        {
+            check_appendable();
+            const size_type count = last - first;
+            if (size_type(end_of_storage - finish) < count)
+            {
+                // [first, last)可能在映射之中，mremap移动映射之后按偏移重新定位
+                const bool inside = first >= start && first < finish;
+                const size_type offset = inside ? first - start : 0;
+                remap(size() + (size() > count ? size() : count));
+                if (inside)
+                {
+                    first = start + offset;
+                    last = first + count;
+                }
+            }
+            for (; first != last; ++first)
+                *finish++ = *first;
+        }
+
+        void pop_back()
+        {
+            check_appendable();
+            --finish;
+        }
+
+        void clear()
+        {
+            check_appendable();
+            finish = start;
+        }
+    };
+
+    template <typename T>
+    void mmap_vector<T>::open(const char *path, open_mode m)
+    {
+        close();
+
+        int flags = m == read_only ? O_RDONLY : O_RDWR | O_CREAT;
+        fd = ::open(path, flags | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw_errno("mmap_vector: open");
+        mode = m;
+
+        struct stat st;
+        if (fstat(fd, &st) < 0)
+        {
+            int err = errno;
+            ::close(fd);
+            fd = -1;
+            errno = err;
+            throw_errno("mmap_vector: fstat");
+        }
+        if (size_t(st.st_size) % sizeof(T))
+        {
+            ::close(fd);
+            fd = -1;
+            throw std::runtime_error("mmap_vector: file size is not a multiple of sizeof(T)");
+        }
+
+        const size_type n = size_t(st.st_size) / sizeof(T);
+        if (n)
+        {
+            int prot = m == read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+            void *p = mmap(nullptr, n * sizeof(T), prot, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                int err = errno;
+                ::close(fd);
+                fd = -1;
+                errno = err;
+                throw_errno("mmap_vector: mmap");
+            }
+            start = static_cast<T *>(p);
+        }
+        finish = end_of_storage = start + n;
+    }
+
+    template <typename T>
+    void mmap_vector<T>::close() noexcept
+    {
+        if (fd < 0)
+            return;
+
+        if (start)
+            munmap(start, capacity() * sizeof(T));
+        // 去掉预先扩展而未使用的部分
+        if (mode == appendable && finish != end_of_storage)
+            (void) ftruncate(fd, size() * sizeof(T));
+        ::close(fd);
+
+        fd = -1;
+        start = finish = end_of_storage = nullptr;
+    }
+
+    template <typename T>
+    void mmap_vector<T>::sync()
+    {
+        if (start && msync(start, capacity() * sizeof(T), MS_SYNC) < 0)
+            throw_errno("mmap_vector: msync");
+    }
+
+    template <typename T>
+    void mmap_vector<T>::remap(size_type new_cap)
+    {
+        check_appendable();
+
+        if (ftruncate(fd, new_cap * sizeof(T)) < 0)
+            throw_errno("mmap_vector: ftruncate");
+
+        void *p;
+        if (start)
+            p = mremap(start, capacity() * sizeof(T), new_cap * sizeof(T), MREMAP_MAYMOVE);
+        else
+            p = mmap(nullptr, new_cap * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            int err = errno;
+            (void) ftruncate(fd, capacity() * sizeof(T));
+            errno = err;
+            throw_errno("mmap_vector: mremap");
+        }
+
+        const size_type n = size();
+        start = static_cast<T *>(p);
+        finish = start + n;
+        end_of_storage = start + new_cap;
+    }
+} // namespace stl
+
+#endif //MINISTL_MMAP_VECTOR_HH
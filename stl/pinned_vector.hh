@@ -0,0 +1,460 @@
+//
+// Created by rda on 2024/3/30.
+//
+
+#ifndef MINISTL_PINNED_VECTOR_HH
+#define MINISTL_PINNED_VECTOR_HH
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "algobase.hh"
+#include "construct.hh"
+#include "iterator.hh"
+#include "uninitialized.hh"
+
+namespace stl
+{
+    /*
+     * 元素地址永不改变的vector，适合只在末尾追加、最终大小未知但有上界的缓冲区
+     * 构造时用mmap(PROT_NONE)保留max_size()个元素的虚拟地址空间，不占用物理内存，
+     * finish前进到尚未提交的页时再用mprotect提交，因此扩容从不复制元素，指针与迭代器始终有效，
+     * 代价只是首次访问新页时的缺页中断
+     * 超过保留的大小时抛出std::length_error
+     * */
+    template <typename T>
+    class pinned_vector
+    {
+    public:
+        /* Member types */
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+
+        using iterator = value_type *;
+        using const_iterator = const value_type *;
+        using reverse_iterator = stl::reverse_iterator<iterator>;
+        using const_reverse_iterator = stl::reverse_iterator<const_iterator>;
+
+        // 默认保留1GB的地址空间
+        static constexpr size_t DEFAULT_RESERVE_BYTES = size_t(1) << 30;
+
+    private:
+        iterator start{};
+        iterator finish{};
+        iterator committed{};      // [start, committed)已经提交，可以读写
+        iterator end_of_reserve{}; // [committed, end_of_reserve)只保留了地址空间
+
+        static size_t page_size()
+        {
+            static const size_t page = sysconf(_SC_PAGESIZE);
+            return page;
+        }
+
+        static size_t page_round_up(size_t bytes)
+        {
+            return (bytes + page_size() - 1) & ~(page_size() - 1);
+        }
+
+        void reserve_address_space(size_type max_elems);
+
+        void release_address_space() noexcept;
+
+        // 保证至少提交n个元素
+        void commit(size_type n);
+
+        // 为末尾追加一个元素准备空间
+        void grow_one()
+        {
+            if (finish == committed)
+                commit(size() + 1);
+        }
+
+    public:
+        /*
+         * constructor
+         * */
+        explicit pinned_vector(size_type max_elems = DEFAULT_RESERVE_BYTES / sizeof(T))
+        {
+            reserve_address_space(max_elems);
+        }
+
+        pinned_vector(size_type n, const T &elem, size_type max_elems = DEFAULT_RESERVE_BYTES / sizeof(T))
+            : pinned_vector(max_elems < n ? n : max_elems)
+        {
+            assign(n, elem);
+        }
+
+        pinned_vector(std::initializer_list<T> ilist, size_type max_elems = DEFAULT_RESERVE_BYTES / sizeof(T))
+            : pinned_vector(max_elems < ilist.size() ? ilist.size() : max_elems)
+        {
+            assign(ilist.begin(), ilist.end());
+        }
+
+        // 保留与other相同大小的地址空间
+        pinned_vector(const pinned_vector &other) : pinned_vector(other.max_size())
+        {
+            assign(other.begin(), other.end());
+        }
+
+        // 直接接管保留的地址空间，other变为空且不再保留任何地址空间
+        pinned_vector(pinned_vector &&other) noexcept
+            : start(other.start), finish(other.finish), committed(other.committed), end_of_reserve(other.end_of_reserve)
+        {
+            other.start = other.finish = other.committed = other.end_of_reserve = nullptr;
+        }
+
+        /*
+         *  destructor
+         * */
+        ~pinned_vector()
+        {
+            stl::destroy(start, finish);
+            release_address_space();
+        }
+
+        /*
+         * assignment operation
+         * */
+        pinned_vector &operator=(const pinned_vector &other)
+        {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        pinned_vector &operator=(pinned_vector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                stl::destroy(start, finish);
+                release_address_space();
+                start = other.start;
+                finish = other.finish;
+                committed = other.committed;
+                end_of_reserve = other.end_of_reserve;
+                other.start = other.finish = other.committed = other.end_of_reserve = nullptr;
+            }
+            return *this;
+        }
+
+        void assign(size_type n, const T &elem)
+        {
+            clear();
+            commit(n);
+            finish = stl::uninitialized_fill_n(start, n, elem);
+        }
+
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        /*
+         * Element access
+         * */
+        reference at(size_type pos)
+        {
+            return const_cast<reference>(static_cast<const pinned_vector &>(*this).at(pos));
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if (pos >= size())
+                throw std::out_of_range("pinned_vector::at");
+            return start[pos];
+        }
+
+        reference operator[](size_type pos)
+        {
+            return start[pos];
+        }
+
+        const_reference operator[](size_type pos) const
+        {
+            return start[pos];
+        }
+
+        reference front()
+        {
+            return *start;
+        }
+
+        const_reference front() const
+        {
+            return *start;
+        }
+
+        reference back()
+        {
+            return *(finish - 1);
+        }
+
+        const_reference back() const
+        {
+            return *(finish - 1);
+        }
+
+        T *data() noexcept
+        {
+            return start;
+        }
+
+        const T *data() const noexcept
+        {
+            return start;
+        }
+
+        /*
+         * Iterator function
+         * */
+        iterator begin() noexcept
+        {
+            return start;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return start;
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return start;
+        }
+
+        iterator end() noexcept
+        {
+            return finish;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return finish;
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return finish;
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        /*
+         * Capacity
+         * */
+        bool empty() const noexcept
+        {
+            return start == finish;
+        }
+
+        size_type size() const noexcept
+        {
+            return size_type(finish - start);
+        }
+
+        // 保留的地址空间能容纳的元素个数，构造之后不再改变
+        size_type max_size() const noexcept
+        {
+            return size_type(end_of_reserve - start);
+        }
+
+        // 已经提交的页能容纳的元素个数
+        size_type capacity() const noexcept
+        {
+            return size_type(committed - start);
+        }
+
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > capacity())
+                commit(new_cap);
+        }
+
+        // 把[finish, committed)中的整页归还给操作系统并恢复为只保留地址空间
+        void shrink_to_fit();
+
+        /*
+         * Modifiers
+         * */
+        void clear() noexcept
+        {
+            stl::destroy(start, finish);
+            finish = start;
+        }
+
+        void push_back(const T &elem)
+        {
+            grow_one();
+            stl::construct(finish, elem);
+            ++finish;
+        }
+
+        void push_back(T &&elem)
+        {
+            grow_one();
+            stl::construct(finish, std::move(elem));
+            ++finish;
+        }
+
+        template <typename... Args>
+        reference emplace_back(Args &&...args)
+        {
+            grow_one();
+            stl::construct(finish, std::forward<Args>(args)...);
+            return *finish++;
+        }
+
+        void pop_back()
+        {
+            --finish;
+            stl::destroy(finish);
+        }
+
+        void resize(size_type n)
+        {
+            resize(n, T());
+        }
+
+        void resize(size_type n, const value_type &elem)
+        {
+            if (n < size())
+            {
+                stl::destroy(start + n, finish);
+                finish = start + n;
+                return;
+            }
+            commit(n);
+            finish = stl::uninitialized_fill_n(finish, n - size(), elem);
+        }
+
+        void swap(pinned_vector &other) noexcept
+        {
+            std::swap(start, other.start);
+            std::swap(finish, other.finish);
+            std::swap(committed, other.committed);
+            std::swap(end_of_reserve, other.end_of_reserve);
+        }
+    };
+
+    template <typename T>
+    void pinned_vector<T>::reserve_address_space(size_type max_elems)
+    {
+        if (!max_elems)
+            return;
+        if (max_elems > size_type(-1) / sizeof(T))
+            throw std::length_error("pinned_vector: reservation too large");
+
+        // MAP_NORESERVE：只保留地址空间，不计入可提交的内存
+        size_t bytes = page_round_up(max_elems * sizeof(T));
+        void *p = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+
+        start = finish = committed = static_cast<T *>(p);
+        end_of_reserve = start + max_elems;
+    }
+
+    template <typename T>
+    void pinned_vector<T>::release_address_space() noexcept
+    {
+        if (start)
+            munmap(start, page_round_up(max_size() * sizeof(T)));
+        start = finish = committed = end_of_reserve = nullptr;
+    }
+
+    template <typename T>
+    void pinned_vector<T>::commit(size_type n)
+    {
+        if (n <= capacity())
+            return;
+        if (n > max_size())
+            throw std::length_error("pinned_vector: exceeds reserved size");
+
+        // 提交的范围按几何级数增长以减少mprotect的次数，物理页仍然在首次访问时才分配
+        size_type want = capacity() * 2;
+        if (want < n)
+            want = n;
+        if (want > max_size())
+            want = max_size();
+
+        char *base = reinterpret_cast<char *>(start);
+        size_t old_bytes = page_round_up(capacity() * sizeof(T));
+        size_t new_bytes = page_round_up(want * sizeof(T));
+        if (new_bytes > old_bytes && mprotect(base + old_bytes, new_bytes - old_bytes, PROT_READ | PROT_WRITE))
+            throw std::bad_alloc();
+
+        // 整页提交后可能比want多容纳一些元素
+        size_type elems = new_bytes / sizeof(T);
+        committed = start + (elems < max_size() ? elems : max_size());
+    }
+
+    template <typename T>
+    void pinned_vector<T>::shrink_to_fit()
+    {
+        char *base = reinterpret_cast<char *>(start);
+        size_t keep = page_round_up(size() * sizeof(T));
+        size_t old_bytes = page_round_up(capacity() * sizeof(T));
+        if (keep >= old_bytes)
+            return;
+
+        madvise(base + keep, old_bytes - keep, MADV_DONTNEED);
+        mprotect(base + keep, old_bytes - keep, PROT_NONE);
+
+        size_type elems = keep / sizeof(T);
+        committed = start + (elems < max_size() ? elems : max_size());
+    }
+
+    /* Non-member functions */
+    template <typename T>
+    bool operator==(const pinned_vector<T> &lhs, const pinned_vector<T> &rhs)
+    {
+        return lhs.size() == rhs.size() && stl::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <typename T>
+    bool operator!=(const pinned_vector<T> &lhs, const pinned_vector<T> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename T>
+    void swap(pinned_vector<T> &lhs, pinned_vector<T> &rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+} // namespace stl
+
+#endif //MINISTL_PINNED_VECTOR_HH
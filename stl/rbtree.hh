@@ -176,7 +176,7 @@ namespace stl
     // RB-Tree
     template <typename Key, typename Value, typename KeyOfValue,
               typename Compare, typename Alloc = alloc>
-    class Rb_tree
+    class Rb_tree : protected simple_alloc<Rb_tree_node<Value>, Alloc>
     {
     public:
         /* Member types */
@@ -188,6 +188,7 @@ namespace stl
         using const_reference = const value_type &;
         using size_type = std::size_t;
         using difference_type = std::ptrdiff_t;
+        using allocator_type = Alloc;
 
         using link_type = Rb_tree_node<Value> *;
         using const_link_type = const Rb_tree_node<Value> *;
@@ -208,8 +209,8 @@ namespace stl
         size_type node_count{};
         Compare key_compare{};
 
-        static link_type get_node() { return rb_tree_node_allocator::allocate(); }
-        static void put_node(link_type p) { rb_tree_node_allocator::deallocate(p); }
+        link_type get_node() { return rb_tree_node_allocator::allocate(); }
+        void put_node(link_type p) { rb_tree_node_allocator::deallocate(p); }
 
         link_type create_node(const value_type & value)
         {
@@ -252,6 +253,35 @@ namespace stl
             put_node(p);
         }
 
+        template <class... Args>
+        link_type create_node(node_batch<rb_tree_node, Alloc> &batch, Args &&...args)
+        {
+            link_type node = batch.take();
+            try
+            {
+                stl::construct(&node->value_field, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                batch.put_back(node);
+                throw;
+            }
+            return node;
+        }
+
+        // 析构以x为根的子树中的所有节点，放回batch中，不需要调整平衡
+        static void erase_subtree(base_ptr x, node_batch<rb_tree_node, Alloc> &batch)
+        {
+            while (x)
+            {
+                erase_subtree(right(x), batch);
+                base_ptr y = left(x);
+                stl::destroy(&value(x));
+                batch.put_back(static_cast<link_type>(x));
+                x = y;
+            }
+        }
+
         // get the members of header
         base_ptr &root() const { return header->parent; }
         base_ptr &leftmost() const { return header->left; }
@@ -380,13 +410,14 @@ namespace stl
         void rb_tree_rotate_right(Rb_tree_node_base *p, Rb_tree_node_base *&root);
 
     public:
-        Rb_tree(const Compare &comp = Compare())
-            : key_compare(comp)
+        Rb_tree(const Compare &comp = Compare(), const Alloc &a = Alloc())
+            : rb_tree_node_allocator(a), key_compare(comp)
         {
             init();
         }
 
         Rb_tree(const Rb_tree &other)
+            : rb_tree_node_allocator(other.get_alloc())
         {
             init();
             clear();
@@ -397,7 +428,8 @@ namespace stl
             assert(node_count == other.node_count);
         }
         Rb_tree(Rb_tree &&other)
-            : header(std::move(other.header)), node_count(std::move(other.node_count))
+            : rb_tree_node_allocator(other.get_alloc()), header(std::move(other.header)),
+              node_count(std::move(other.node_count))
         {
             other.init(); // other还原到初始状态
         }
@@ -429,6 +461,8 @@ namespace stl
             clear();
             put_node(header);
 
+            // 节点连同配置器一起转移
+            rb_tree_node_allocator::get_alloc() = other.get_alloc();
             header = std::move(other.header);
             // nil = std::move(other.nil);
             node_count = other.node_count;
@@ -509,7 +543,13 @@ namespace stl
          * */
         void clear() noexcept
         {
-            erase(begin(), end());
+            // 节点逐个析构后成批归还
+            node_batch<rb_tree_node, Alloc> freed(*this, 0);
+            erase_subtree(root(), freed);
+
+            root() = nullptr;
+            leftmost() = rightmost() = header;
+            node_count = 0;
         }
 
         std::pair<iterator, bool> insert_unique(const value_type &value)
@@ -518,6 +558,7 @@ namespace stl
             auto res = get_insert_unique_pos(KeyOfValue()(node->value_field));
             if (res.second)
                 return {insert(static_cast<link_type>(res.first), static_cast<link_type>(res.second), node), true};
+            destroy_node(node);
             return {iterator(static_cast<link_type>(res.first)), false};
         }
 
@@ -528,6 +569,7 @@ namespace stl
             auto res = get_insert_unique_pos(KeyOfValue()(node->value_field));
             if (res.second)
                 return {insert(static_cast<link_type>(res.first), static_cast<link_type>(res.second), node), true};
+            destroy_node(node);
             return {iterator(static_cast<link_type>(res.first)), false};
         }
 
@@ -553,10 +595,20 @@ namespace stl
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
         void insert_unique(InputIt first, InputIt last)
         {
-            while (first != last)
+            // 前向迭代器的区间成批分配节点，重复的元素所用的节点放回batch
+            node_batch<rb_tree_node, Alloc> batch(*this, stl::batch_distance(first, last));
+
+            for (; first != last; ++first)
             {
-                insert_unique(*first);
-                ++first;
+                link_type node = create_node(batch, *first);
+                auto res = get_insert_unique_pos(KeyOfValue()(node->value_field));
+                if (res.second)
+                    insert(static_cast<link_type>(res.first), static_cast<link_type>(res.second), node);
+                else
+                {
+                    stl::destroy(&node->value_field);
+                    batch.put_back(node);
+                }
             }
         }
         template <class... Args>
@@ -607,10 +659,14 @@ namespace stl
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
         void insert_equal(InputIt first, InputIt last)
         {
-            while (first != last)
+            // 前向迭代器的区间成批分配节点
+            node_batch<rb_tree_node, Alloc> batch(*this, stl::batch_distance(first, last));
+
+            for (; first != last; ++first)
             {
-                insert_equal(*first);
-                ++first;
+                link_type node = create_node(batch, *first);
+                auto res = get_insert_equal_pos(KeyOfValue()(node->value_field));
+                insert(static_cast<link_type>(res.first), static_cast<link_type>(res.second), node);
             }
         }
 
@@ -653,6 +709,12 @@ namespace stl
         {
             std::swap(header, other.header);
             std::swap(node_count, other.node_count);
+            std::swap(rb_tree_node_allocator::get_alloc(), other.get_alloc());
+        }
+
+        allocator_type get_allocator() const noexcept
+        {
+            return rb_tree_node_allocator::get_alloc();
         }
 
         /*
@@ -0,0 +1,123 @@
+//
+// Created by rda on 2024/5/25.
+//
+
+#ifndef MINISTL_RETIRED_LIST_HH
+#define MINISTL_RETIRED_LIST_HH
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+#include "alloc.hh"
+#include "construct.hh"
+
+namespace stl
+{
+    /*
+     * 已经从容器中摘下、等待释放的节点，epoch_limbo与hazard_limbo共用
+     * NodeBase是带有retired_next的节点基类，Node是实际的节点类型
+     * 可以被多个线程同时放入；由调用者取下整条链，决定哪些节点可以释放，
+     * 释放的节点析构后通过simple_alloc成批归还，其余的放回
+     * */
+    template <typename Node, typename NodeBase, typename Alloc>
+    class retired_list
+    {
+        static_assert(std::is_base_of<NodeBase, Node>::value, "retired_list requires Node derived from NodeBase");
+
+    public:
+        using allocator = simple_alloc<Node, Alloc>;
+
+    private:
+        std::atomic<NodeBase *> head{nullptr};
+        std::atomic<size_t> count{0};
+
+        void push_chain(NodeBase *first, NodeBase *last)
+        {
+            last->retired_next = head.load(std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(last->retired_next, first, std::memory_order_release,
+                                               std::memory_order_relaxed))
+                ;
+        }
+
+        static void free_node(node_batch<Node, Alloc> &freed, NodeBase *n)
+        {
+            Node *node = static_cast<Node *>(n);
+            stl::destroy(node);
+            freed.put_back(node);
+        }
+
+    public:
+        retired_list() = default;
+
+        retired_list(const retired_list &) = delete;
+
+        retired_list &operator=(const retired_list &) = delete;
+
+        // 放入一个节点，返回放入之后的节点个数
+        size_t push(Node *n)
+        {
+            push_chain(n, n);
+            return count.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        // 取下当前全部节点，之后放入的节点不在其中
+        // seq_cst：hazard pointer要求取下发生在收集槽位之前
+        NodeBase *take()
+        {
+            return head.exchange(nullptr, std::memory_order_seq_cst);
+        }
+
+        // 释放chain中can_free为true的节点，其余的放回
+        template <typename Predicate>
+        void release_if(allocator &a, NodeBase *chain, Predicate can_free)
+        {
+            NodeBase *keep_first = nullptr, *keep_last = nullptr;
+            size_t released = 0;
+            node_batch<Node, Alloc> freed(a, 0);
+
+            while (chain)
+            {
+                NodeBase *next = chain->retired_next;
+                if (can_free(static_cast<Node *>(chain)))
+                {
+                    free_node(freed, chain);
+                    ++released;
+                }
+                else
+                {
+                    chain->retired_next = keep_first;
+                    keep_first = chain;
+                    if (!keep_last)
+                        keep_last = chain;
+                }
+                chain = next;
+            }
+            if (keep_first)
+                push_chain(keep_first, keep_last);
+            count.fetch_sub(released, std::memory_order_relaxed);
+        }
+
+        // 不经检查释放全部节点，只能在没有其他线程访问容器时调用
+        void drain(allocator &a)
+        {
+            NodeBase *n = head.exchange(nullptr, std::memory_order_acquire);
+            node_batch<Node, Alloc> freed(a, 0);
+            while (n)
+            {
+                NodeBase *next = n->retired_next;
+                free_node(freed, n);
+                n = next;
+            }
+            count.store(0, std::memory_order_relaxed);
+        }
+
+        // 等待释放的节点个数，并发时是近似值
+        size_t pending() const noexcept
+        {
+            return count.load(std::memory_order_relaxed);
+        }
+    };
+} // namespace stl
+
+#endif //MINISTL_RETIRED_LIST_HH
@@ -46,10 +46,12 @@ namespace stl
          * Constructors
          * */
         set() : set(Compare()) {}
-        explicit set(const Compare &comp) : tree(comp) {}
+        explicit set(const Compare &comp, const Alloc &a = Alloc()) : tree(comp, a) {}
+        explicit set(const Alloc &a) : tree(Compare(), a) {}
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        set(InputIt first, InputIt last, const Compare &comp = Compare())
-            : tree(comp)
+        set(InputIt first, InputIt last, const Compare &comp = Compare(),
+            const Alloc &a = Alloc())
+            : tree(comp, a)
         {
             tree.insert_unique(first, last);
         }
@@ -62,7 +64,7 @@ namespace stl
         }
 
         set(std::initializer_list<value_type> init,
-            const Compare &comp = Compare()) : tree(comp)
+            const Compare &comp = Compare(), const Alloc &a = Alloc()) : tree(comp, a)
         {
             tree.insert_unique(init.begin(), init.end());
         }
@@ -251,6 +253,11 @@ namespace stl
         {
             return tree.key_comp();
         }
+
+        allocator_type get_allocator() const noexcept
+        {
+            return tree.get_allocator();
+        }
     };
 
     template <typename Key,
@@ -288,10 +295,12 @@ namespace stl
          * Constructors
          * */
         multiset() : multiset(Compare()) {}
-        explicit multiset(const Compare &comp) : tree(comp) {}
+        explicit multiset(const Compare &comp, const Alloc &a = Alloc()) : tree(comp, a) {}
+        explicit multiset(const Alloc &a) : tree(Compare(), a) {}
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        multiset(InputIt first, InputIt last, const Compare &comp = Compare())
-            : tree(comp)
+        multiset(InputIt first, InputIt last, const Compare &comp = Compare(),
+            const Alloc &a = Alloc())
+            : tree(comp, a)
         {
             tree.insert_equal(first, last);
         }
@@ -304,7 +313,7 @@ namespace stl
         }
 
         multiset(std::initializer_list<value_type> init,
-            const Compare &comp = Compare()) : tree(comp)
+            const Compare &comp = Compare(), const Alloc &a = Alloc()) : tree(comp, a)
         {
             tree.insert_equal(init.begin(), init.end());
         }
@@ -493,6 +502,11 @@ namespace stl
         {
             return tree.key_comp();
         }
+
+        allocator_type get_allocator() const noexcept
+        {
+            return tree.get_allocator();
+        }
     };
 } // namespace stl
 
@@ -0,0 +1,308 @@
+//
+// Created by rda on 2024/3/23.
+//
+
+#ifndef MINISTL_SMALL_VECTOR_HH
+#define MINISTL_SMALL_VECTOR_HH
+
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "alloc.hh"
+#include "vector.hh"
+
+namespace stl
+{
+    /*
+     * 优先从容器内部缓冲区分配的配置器适配器，供small_vector使用
+     * 请求不超过Bytes字节且缓冲区空闲时返回缓冲区，否则交给Alloc
+     * vector同一时刻只持有一块存储空间，因此只需记录缓冲区是否正在使用
+     * 缓冲区按元素类型对齐，由持有它的容器保证
+     * */
+    template <size_t Bytes, typename Alloc = alloc>
+    class Inline_alloc : private Alloc
+    {
+    private:
+        void *buffer;
+        bool in_use;
+
+    public:
+        explicit Inline_alloc(void *buf, const Alloc &a = Alloc()) : Alloc(a), buffer(buf), in_use(false) {}
+
+        void *allocate(size_t n)
+        {
+            return allocate(n, ALIGN);
+        }
+
+        void *allocate(size_t n, size_t align)
+        {
+            if (n <= Bytes && !in_use)
+            {
+                in_use = true;
+                return buffer;
+            }
+            return allocate_aligned(get_inner(), n, align);
+        }
+
+        void deallocate(void *p, size_t n)
+        {
+            deallocate(p, n, ALIGN);
+        }
+
+        void deallocate(void *p, size_t n, size_t align)
+        {
+            if (p == buffer)
+                in_use = false;
+            else
+                deallocate_aligned(get_inner(), p, n, align);
+        }
+
+        // 在缓冲区内调整时不必移动，缓冲区与堆之间互相搬移，都在堆上时交给Alloc的reallocate
+        void *reallocate(void *p, size_t old_sz, size_t new_sz)
+        {
+            const bool fits_buffer = new_sz <= Bytes;
+            if (p == buffer && fits_buffer)
+                return p;
+
+            if constexpr (has_reallocate<Alloc>::value)
+            {
+                if (p != buffer && (!fits_buffer || in_use))
+                    return get_inner().reallocate(p, old_sz, new_sz);
+            }
+
+            void *new_p = allocate(new_sz);
+            memcpy(new_p, p, old_sz < new_sz ? old_sz : new_sz);
+            deallocate(p, old_sz);
+            return new_p;
+        }
+
+        bool owns_buffer() const noexcept
+        {
+            return in_use;
+        }
+
+        Alloc &get_inner() noexcept
+        {
+            return *this;
+        }
+
+        const Alloc &get_inner() const noexcept
+        {
+            return *this;
+        }
+    };
+
+    // small_vector的内部缓冲区，作为第一个基类以便先于vector构造、晚于vector析构
+    // 复制与赋值时什么也不做，缓冲区中的元素由small_vector负责
+    template <typename T, size_t N>
+    struct small_vector_buffer
+    {
+        alignas(T) unsigned char storage[N * sizeof(T)];
+
+        small_vector_buffer() = default;
+
+        small_vector_buffer(const small_vector_buffer &) {}
+
+        small_vector_buffer &operator=(const small_vector_buffer &)
+        {
+            return *this;
+        }
+
+        T *inline_data() noexcept
+        {
+            return reinterpret_cast<T *>(storage);
+        }
+
+        const T *inline_data() const noexcept
+        {
+            return reinterpret_cast<const T *>(storage);
+        }
+    };
+
+    /*
+     * 在容器内部保存至多N个元素的vector，元素个数不超过N时不经过配置器
+     * 构造时以整个内部缓冲区作为存储空间，超过N个时沿用vector的扩容逻辑把元素搬到堆上，
+     * 元素减少后shrink_to_fit可以搬回内部缓冲区
+     * 接口与stl::vector相同，但移动与交换在元素位于内部缓冲区时需要逐个移动元素，
+     * 不再是常数时间，也不能通过vector的引用移动或交换small_vector
+     * */
+    template <typename T, size_t N, typename Alloc = alloc>
+    class small_vector : private small_vector_buffer<T, N>, public vector<T, Inline_alloc<N * sizeof(T), Alloc>>
+    {
+        static_assert(N > 0, "small_vector needs at least one inline element");
+
+    private:
+        using buffer = small_vector_buffer<T, N>;
+        using base = vector<T, Inline_alloc<N * sizeof(T), Alloc>>;
+
+    public:
+        using typename base::value_type;
+        using typename base::allocator_type;
+        using typename base::size_type;
+        using typename base::iterator;
+        using typename base::const_iterator;
+
+    private:
+        allocator_type make_alloc(const Alloc &a)
+        {
+            return allocator_type(buffer::inline_data(), a);
+        }
+
+        // 以整个内部缓冲区作为存储空间，之后N个元素以内的插入都不会扩容
+        void init_inline()
+        {
+            this->start = this->finish = base::data_allocator::allocate(N);
+            this->end_of_storage = this->start + N;
+        }
+
+        // 接管other的元素，调用前本容器为空
+        // other的元素在堆上时直接接管存储空间，在内部缓冲区时逐个移动
+        void steal(small_vector &other)
+        {
+            if (!other.is_inline())
+            {
+                this->deallocate();
+                this->start = other.start;
+                this->finish = other.finish;
+                this->end_of_storage = other.end_of_storage;
+                other.init_inline();
+                return;
+            }
+
+            this->reserve(other.size());
+            for (auto &elem : other)
+                this->emplace_back(std::move(elem));
+            other.clear();
+        }
+
+    public:
+        /*
+         * constructor
+         * */
+        small_vector() : base(make_alloc(Alloc()))
+        {
+            init_inline();
+        }
+
+        explicit small_vector(const Alloc &a) : base(make_alloc(a))
+        {
+            init_inline();
+        }
+
+        explicit small_vector(size_type n, const Alloc &a = Alloc()) : base(make_alloc(a))
+        {
+            init_inline();
+            this->resize(n);
+        }
+
+        small_vector(size_type n, const T &elem, const Alloc &a = Alloc()) : base(make_alloc(a))
+        {
+            init_inline();
+            this->assign(n, elem);
+        }
+
+        template <typename InputIterator, typename = std::_RequireInputIter<InputIterator>>
+        small_vector(InputIterator first, InputIterator last, const Alloc &a = Alloc()) : base(make_alloc(a))
+        {
+            init_inline();
+            this->assign(first, last);
+        }
+
+        small_vector(std::initializer_list<T> ilist, const Alloc &a = Alloc()) : base(make_alloc(a))
+        {
+            init_inline();
+            this->assign(ilist);
+        }
+
+        small_vector(const small_vector &other) : buffer(), base(make_alloc(other.get_alloc().get_inner()))
+        {
+            init_inline();
+            this->assign(other.begin(), other.end());
+        }
+
+        small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+            : buffer(), base(make_alloc(other.get_alloc().get_inner()))
+        {
+            init_inline();
+            steal(other);
+        }
+
+        /*
+         * assignment operation
+         * */
+        small_vector &operator=(const small_vector &other)
+        {
+            if (this != &other)
+                this->assign(other.begin(), other.end());
+            return *this;
+        }
+
+        // 与vector相同，other的存储空间在堆上时配置器随之一起转移
+        small_vector &operator=(small_vector &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        {
+            if (this != &other)
+            {
+                this->clear();
+                if (!other.is_inline())
+                {
+                    this->deallocate();
+                    this->start = this->finish = this->end_of_storage = nullptr;
+                    this->get_alloc().get_inner() = other.get_alloc().get_inner();
+                }
+                steal(other);
+            }
+            return *this;
+        }
+
+        small_vector &operator=(std::initializer_list<T> ilist)
+        {
+            this->assign(ilist);
+            return *this;
+        }
+
+        /*
+         * Capacity
+         * */
+        // 元素是否保存在内部缓冲区
+        bool is_inline() const noexcept
+        {
+            return this->get_alloc().owns_buffer();
+        }
+
+        static constexpr size_type inline_capacity() noexcept
+        {
+            return N;
+        }
+
+        // 元素在内部缓冲区时什么也不做，在堆上且不超过N个时搬回内部缓冲区
+        void shrink_to_fit()
+        {
+            if (is_inline())
+                return;
+            if (this->size() <= N)
+                this->reallocate(N);
+            else
+                base::shrink_to_fit();
+        }
+
+        /*
+         * Modifiers
+         * */
+        void swap(small_vector &other) noexcept(std::is_nothrow_move_constructible<T>::value)
+        {
+            small_vector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    };
+
+    template <typename T, size_t N, typename Alloc>
+    void swap(small_vector<T, N, Alloc> &lhs, small_vector<T, N, Alloc> &rhs) noexcept(noexcept(lhs.swap(rhs)))
+    {
+        lhs.swap(rhs);
+    }
+} // namespace stl
+
+#endif //MINISTL_SMALL_VECTOR_HH
@@ -2,1095 +2,672 @@
 // Created by rda on 2023/6/3.
 //
 
-#ifndef MINISTL_LIST_HH
-#define MINISTL_LIST_HH
+#ifndef MINISTL_THS_LIST_HH
+#define MINISTL_THS_LIST_HH
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <utility>
 
 #include "alloc.hh"
-#include "iterator.hh"
 #include "construct.hh"
-#include "algobase.hh"
+#include "ebr.hh"
+#include "hazard_pointer.hh"
 
 namespace stl
 {
-    /* list node, contain 2 pointer and a data item */
-    template <typename T>
-    struct list_node
+    /* ths list node base, 头节点只有这一部分 */
+    struct ths_list_node_base
     {
-        list_node *prev{};
-        list_node *next{};
-        T data{};
-
-        list_node()
-        {
-            prev = next = this;
-        }
+        std::atomic<ths_list_node_base *> next{};
+        std::atomic<bool> marked{};            // 逻辑删除标记，置位之后才从链表中摘下
+        std::mutex mtx;                        // 只有修改者使用，读者从不加锁
     };
 
-    /* list iterator, contain a pointer to node */
     template <typename T>
-    struct list_iterator
+    struct ths_list_node : ths_list_node_base, epoch_node
     {
-        using Self = list_iterator<T>;
-        using Node = list_node<T>;
+        T data;
 
-        using difference_type = std::ptrdiff_t;
-        using iterator_category = stl::bidirectional_iterator_tag;
+        template <class... Args>
+        explicit ths_list_node(Args &&...args) : data(std::forward<Args>(args)...) {}
+    };
 
+    /*
+     * thread-safe version ths_list
+     * 按Compare有序、元素不重复的并发链表，使用lazy list算法（Heller等）
+     * 1. insert/erase先不加锁地找到位置，再只锁住前驱与当前两个节点并验证它们仍然相邻且未被删除，
+     *    验证失败时重试；因此不同位置的插入与删除可以并行
+     * 2. 删除先置位marked（逻辑删除）再修改前驱的next（物理删除）
+     * 3. contains与for_each不加任何锁，只读取原子指针与marked
+     * 4. 读者可能仍在访问已摘下的节点，因此这些节点通过epoch_limbo延迟到没有线程可能访问时才释放
+     * clear与析构不能与其他操作并发
+     * */
+    template <typename T, typename Compare = std::less<T>, typename Alloc = alloc>
+    class ths_list : protected simple_alloc<ths_list_node<T>, Alloc>
+    {
+    public:
+        /* Member types */
         using value_type = T;
-        using pointer = value_type *;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using key_compare = Compare;
+
         using reference = value_type &;
+        using const_reference = const value_type &;
 
-        list_iterator() = default;
+    protected:
+        using Node = ths_list_node<T>;
+        using node_base = ths_list_node_base;
+        using node_allocator = simple_alloc<Node, Alloc>;
 
-        explicit list_iterator(const list_node<T> *n)
-            : node(const_cast<Node *>(n)) {}
+        node_base head;
+        epoch_limbo<Node, Alloc> limbo;
+        std::atomic<size_type> num_of_nodes{};
+        Compare comp;
 
-        reference
-        operator*() const
+        static const T &value(const node_base *n)
         {
-            return node->data;
+            return static_cast<const Node *>(n)->data;
         }
 
-        pointer
-        operator->() const
+        // 返回第一个不小于v的节点cur及其前驱pred，cur为空表示v大于所有元素
+        void locate(const T &v, node_base *&pred, node_base *&cur) const
         {
-            return &(operator*());
+            pred = const_cast<node_base *>(&head);
+            cur = pred->next.load(std::memory_order_acquire);
+            while (cur && comp(value(cur), v))
+            {
+                pred = cur;
+                cur = cur->next.load(std::memory_order_acquire);
+            }
         }
 
-        Self &
-        operator++()
+        // 加锁之后确认pred与cur都未被删除且仍然相邻
+        static bool validate(node_base *pred, node_base *cur)
         {
-            node = node->next;
-            return *this;
+            return !pred->marked.load(std::memory_order_acquire) &&
+                   (!cur || !cur->marked.load(std::memory_order_acquire)) &&
+                   pred->next.load(std::memory_order_acquire) == cur;
         }
 
-        Self
-        operator++(int)
+        bool equal(const T &lhs, const T &rhs) const
         {
-            Self temp = *this;
-            node = node->next;
-            return temp;
+            return !comp(lhs, rhs) && !comp(rhs, lhs);
         }
 
-        Self &
-        operator--()
+        template <class... Args>
+        Node *create_node(Args &&...args)
         {
-            node = node->prev;
-            return *this;
+            Node *node = node_allocator::allocate();
+            try
+            {
+                stl::construct(node, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                node_allocator::deallocate(node);
+                throw;
+            }
+            return node;
         }
 
-        Self
-        operator--(int)
+        void destroy_node(node_base *n)
         {
-            Self temp = *this;
-            node = node->prev;
-            return temp;
+            stl::destroy(static_cast<Node *>(n));
+            node_allocator::deallocate(static_cast<Node *>(n));
         }
 
-        friend bool
-        operator==(const Self &lhs, const Self &rhs)
-        {
-            return lhs.node == rhs.node;
-        }
+        template <typename V>
+        bool insert_aux(V &&v);
+
+    public:
+        /*
+         *  constructor
+         * */
+        ths_list() = default;
+
+        explicit ths_list(const Compare &c, const Alloc &a = Alloc()) : node_allocator(a), comp(c) {}
 
-        friend bool
-        operator!=(const Self &lhs, const Self &rhs)
+        ths_list(std::initializer_list<T> init, const Compare &c = Compare(), const Alloc &a = Alloc())
+            : node_allocator(a), comp(c)
         {
-            return lhs.node != rhs.node;
+            for (auto &v : init)
+                insert(v);
         }
 
-        Node *node{};
-    };
-
-    /* list const iterator, contain a pointer to node */
-    template <typename T>
-    struct list_const_iterator
-    {
-        using Self = list_const_iterator<T>;
-        using Node = const list_node<T>;
-        using iterator = list_iterator<T>;
+        ths_list(const ths_list &) = delete;
 
-        using difference_type = std::ptrdiff_t;
-        using iterator_category = stl::bidirectional_iterator_tag;
+        ths_list &operator=(const ths_list &) = delete;
 
-        using value_type = T;
-        using pointer = value_type *;
-        using reference = value_type &;
+        /*
+         *  destructor
+         * */
+        ~ths_list()
+        {
+            clear();
+        }
 
-        list_const_iterator() = default;
+        allocator_type get_allocator() const noexcept
+        {
+            return node_allocator::get_alloc();
+        }
 
-        explicit list_const_iterator(const list_node<T> *n) : node(n) {}
-        list_const_iterator(const iterator &iter) : node(iter.node) {}
+        /*
+         * Capacity
+         * */
+        // 并发修改时只是某一时刻的近似值
+        size_type size() const noexcept
+        {
+            return num_of_nodes.load(std::memory_order_relaxed);
+        }
 
-        reference
-        operator*() const
+        bool empty() const noexcept
         {
-            return const_cast<reference>(node->data);
+            return head.next.load(std::memory_order_acquire) == nullptr;
         }
 
-        pointer
-        operator->() const
+        /*
+         * Lookup，不加锁
+         * */
+        bool contains(const T &v) const
         {
-            return &(operator*());
+            epoch_guard guard;
+            node_base *pred, *cur;
+            locate(v, pred, cur);
+            return cur && equal(value(cur), v) && !cur->marked.load(std::memory_order_acquire);
         }
 
-        Self &
-        operator++()
+        // 依次把未被删除的元素交给f，遍历期间可以有并发的插入与删除
+        template <typename Function>
+        void for_each(Function f) const
         {
-            node = node->next;
-            return *this;
+            epoch_guard guard;
+            for (node_base *cur = head.next.load(std::memory_order_acquire); cur;
+                 cur = cur->next.load(std::memory_order_acquire))
+                if (!cur->marked.load(std::memory_order_acquire))
+                    f(value(cur));
         }
 
-        Self
-        operator++(int)
+        /*
+         * Modifiers
+         * */
+        // 元素已存在时返回false
+        bool insert(const T &v)
         {
-            Self temp = *this;
-            node = node->next;
-            return temp;
+            return insert_aux(v);
         }
 
-        Self &
-        operator--()
+        bool insert(T &&v)
         {
-            node = node->prev;
-            return *this;
+            return insert_aux(std::move(v));
         }
 
-        Self
-        operator--(int)
+        // 元素不存在时返回false
+        bool erase(const T &v);
+
+        // 不能与其他操作并发
+        void clear() noexcept;
+    };
+
+    template <typename T, typename Compare, typename Alloc>
+    template <typename V>
+    bool ths_list<T, Compare, Alloc>::insert_aux(V &&v)
+    {
+        epoch_guard guard;
+        while (true)
         {
-            Self temp = *this;
-            node = node->prev;
-            return temp;
+            node_base *pred, *cur;
+            locate(v, pred, cur);
+
+            std::lock_guard<std::mutex> pred_guard(pred->mtx);
+            std::unique_lock<std::mutex> cur_guard;
+            if (cur)
+                cur_guard = std::unique_lock<std::mutex>(cur->mtx);
+
+            if (!validate(pred, cur))
+                continue;
+
+            if (cur && equal(value(cur), v))
+                return false;
+
+            Node *node = create_node(std::forward<V>(v));
+            node->next.store(cur, std::memory_order_relaxed);
+            pred->next.store(node, std::memory_order_release);
+            num_of_nodes.fetch_add(1, std::memory_order_relaxed);
+            return true;
         }
+    }
 
-        friend bool
-        operator==(const Self &lhs, const Self &rhs)
+    template <typename T, typename Compare, typename Alloc>
+    bool ths_list<T, Compare, Alloc>::erase(const T &v)
+    {
+        epoch_guard guard;
+        node_base *victim = nullptr;
+        while (!victim)
         {
-            return lhs.node == rhs.node;
+            node_base *pred, *cur;
+            locate(v, pred, cur);
+            if (!cur || !equal(value(cur), v))
+                return false;
+
+            std::lock_guard<std::mutex> pred_guard(pred->mtx);
+            std::lock_guard<std::mutex> cur_guard(cur->mtx);
+
+            if (!validate(pred, cur))
+                continue;
+
+            cur->marked.store(true, std::memory_order_release);
+            pred->next.store(cur->next.load(std::memory_order_acquire), std::memory_order_release);
+            num_of_nodes.fetch_sub(1, std::memory_order_relaxed);
+            victim = cur;
         }
 
-        friend bool
-        operator!=(const Self &lhs, const Self &rhs)
+        // 在锁外回收，避免持锁释放节点
+        limbo.retire(static_cast<Node *>(victim), *this);
+        return true;
+    }
+
+    template <typename T, typename Compare, typename Alloc>
+    void ths_list<T, Compare, Alloc>::clear() noexcept
+    {
+        node_base *cur = head.next.exchange(nullptr, std::memory_order_acquire);
+        while (cur)
         {
-            return lhs.node != rhs.node;
+            node_base *next = cur->next.load(std::memory_order_relaxed);
+            destroy_node(cur);
+            cur = next;
         }
+        limbo.drain(*this);
+        num_of_nodes.store(0, std::memory_order_relaxed);
+    }
+
+    /* lockfree list node, next的最低位是逻辑删除标记 */
+    struct lockfree_list_node_base
+    {
+        std::atomic<uintptr_t> next{};
+    };
+
+    // ReclaimNode为回收方式要求的节点基类
+    template <typename T, typename ReclaimNode>
+    struct lockfree_list_node : lockfree_list_node_base, ReclaimNode
+    {
+        T data;
 
-        const Node *node{};
+        template <class... Args>
+        explicit lockfree_list_node(Args &&...args) : data(std::forward<Args>(args)...) {}
     };
 
-    template <typename T, typename Alloc = alloc>
-    class list
+    /*
+     * thread-safe version lockfree_list
+     * 按Compare有序、元素不重复的无锁链表，使用Harris-Michael算法
+     * 1. 删除先用CAS在被删节点的next上置标记（逻辑删除），再用CAS修改前驱的next（物理删除）
+     * 2. 查找位置时遇到带标记的节点就顺手把它摘下，成功摘下的线程负责回收
+     * 3. contains与for_each不会被其他线程阻塞
+     * 4. 摘下的节点交给Reclaimer延迟到没有线程可能访问时才释放：
+     *    epoch_reclaimer（默认）读者开销最小，但停住的读者会推迟所有回收；
+     *    hazard_reclaimer每前进一个节点都要公布并验证，但未回收的节点个数有上界，
+     *    此时contains也会顺手摘下带标记的节点
+     * 任何操作都不加锁；clear与析构不能与其他操作并发
+     * */
+    template <typename T, typename Compare = std::less<T>, typename Alloc = alloc,
+              typename Reclaimer = epoch_reclaimer>
+    class lockfree_list : protected simple_alloc<lockfree_list_node<T, typename Reclaimer::node>, Alloc>
     {
     public:
         /* Member types */
         using value_type = T;
         using allocator_type = Alloc;
         using size_type = size_t;
-        using difference_type = ptrdiff_t;
+        using key_compare = Compare;
+        using reclaimer_type = Reclaimer;
 
         using reference = value_type &;
         using const_reference = const value_type &;
-        using pointer = value_type *;
-        using const_pointer = const value_type *;
-
-        using iterator = list_iterator<T>;
-        using const_iterator = list_const_iterator<T>;
-        using reverse_iterator = stl::reverse_iterator<iterator>;
-        using const_reverse_iterator = stl::reverse_iterator<const_iterator>;
 
     protected:
-        using Node = list_node<T>;
-        using link_type = Node *;
-        link_type head{};
-        size_type num_of_nodes{};
+        using Node = lockfree_list_node<T, typename Reclaimer::node>;
+        using node_base = lockfree_list_node_base;
+        using node_allocator = simple_alloc<Node, Alloc>;
+        using guard_type = typename Reclaimer::guard;
+
+        // find使用的hazard槽位
+        enum
+        {
+            HP_NEXT,
+            HP_CUR,
+            HP_PREV,
+            HP_KEY // for_each恢复遍历时作为关键字的节点
+        };
 
-        using list_node_allocator = simple_alloc<Node, Alloc>;
+        node_base head;
+        mutable typename Reclaimer::template limbo<Node, Alloc> limbo;
+        std::atomic<size_type> num_of_nodes{};
+        Compare comp;
 
-        link_type get_node()
+        static Node *ptr(uintptr_t link)
         {
-            return list_node_allocator::allocate();
+            return reinterpret_cast<Node *>(link & ~uintptr_t(1));
         }
 
-        template <class... Args>
-        link_type create_node(Args &&...args)
+        static bool is_marked(uintptr_t link)
         {
-            link_type node = get_node();
-            stl::construct(&node->data, std::forward<Args>(args)...);
-
-            return node;
+            return link & 1;
         }
 
-        void put_node(link_type p) { list_node_allocator::deallocate(p); }
-
-        void destroy_node(link_type p)
+        static uintptr_t link_of(const Node *n)
         {
-            stl::destroy(&p->data);
-            put_node(p);
+            return reinterpret_cast<uintptr_t>(n);
         }
 
-        void empty_initialize()
+        bool equal(const T &lhs, const T &rhs) const
         {
-            head = get_node();
-            head->prev = head->next = head;
+            return !comp(lhs, rhs) && !comp(rhs, lhs);
         }
 
-        void transfer(iterator pos, iterator first, iterator last)
+        template <class... Args>
+        Node *create_node(Args &&...args)
         {
-            if (pos != last && first != last)
+            Node *node = node_allocator::allocate();
+            try
             {
-                auto prev_node = (link_type)(pos.node)->prev;
-                auto last_prev_node = (link_type)(last.node)->prev;
-
-                // 关联first的prev节点与last节点
-                first.node->prev->next = last.node;
-                last.node->prev = first.node->prev;
-
-                prev_node->next = first.node;
-                first.node->prev = prev_node;
-                last_prev_node->next = pos.node;
-                pos.node->prev = last_prev_node;
+                stl::construct(node, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                node_allocator::deallocate(node);
+                throw;
             }
+            return node;
         }
 
-    public:
-        /* Member functions */
-
-        /*
-         *  constructor
-         * */
-        list()
+        void destroy_node(Node *n)
         {
-            empty_initialize();
+            stl::destroy(n);
+            node_allocator::deallocate(n);
         }
 
-        explicit list(size_type count, const T &value = T());
-
-        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        list(InputIt first, InputIt last)
+        void retire(Node *n) const
         {
-            empty_initialize();
-
-            while (first != last)
-            {
-                link_type node = create_node(*first);
-
-                auto end = head->prev;
-
-                node->prev = end;
-                end->next = node;
-
-                node->next = head;
-                head->prev = node;
-
-                ++first;
-                ++num_of_nodes;
-            }
+            auto self = const_cast<lockfree_list *>(this);
+            limbo.retire(n, *self);
         }
 
-        list(const list &other);
-        list(list &&other);
-        list(std::initializer_list<T> init);
-
         /*
-         *  destructor
+         * 从start开始找到第一个before为false且未被删除的节点cur及其前驱pred，途中摘下带标记的节点
+         * start必须是头节点或者受guard保护的节点，start被删除时从头节点重新开始
+         * 返回时pred与cur受guard保护
          * */
-        ~list();
+        template <typename Before>
+        void find(guard_type &guard, const node_base *start, Before before, node_base *&pred, Node *&cur) const;
+
+        void find(guard_type &guard, const T &v, node_base *&pred, Node *&cur) const
+        {
+            find(guard, &head, [&](const T &x) { return comp(x, v); }, pred, cur);
+        }
 
+    public:
         /*
-         * assignment operation
+         *  constructor
          * */
-        list &operator=(const list &other);
-        list &operator=(list &&other) noexcept;
-        list &operator=(std::initializer_list<T> ilist);
+        lockfree_list() = default;
 
-        void assign(size_type count, const value_type &value);
+        explicit lockfree_list(const Compare &c, const Alloc &a = Alloc()) : node_allocator(a), comp(c) {}
 
-        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        void
-        assign(InputIt first, InputIt last)
+        lockfree_list(std::initializer_list<T> init, const Compare &c = Compare(), const Alloc &a = Alloc())
+            : node_allocator(a), comp(c)
         {
-            erase(cbegin(), cend());
-            num_of_nodes = 0;
-
-            while (first != last)
-            {
-                link_type node = create_node(*first);
-                auto end = head->prev;
+            for (auto &v : init)
+                insert(v);
+        }
 
-                node->prev = end;
-                end->next = node;
+        lockfree_list(const lockfree_list &) = delete;
 
-                node->next = head;
-                head->prev = node;
+        lockfree_list &operator=(const lockfree_list &) = delete;
 
-                ++first;
-                ++num_of_nodes;
-            }
+        /*
+         *  destructor
+         * */
+        ~lockfree_list()
+        {
+            clear();
         }
 
-        void assign(std::initializer_list<T> ilist);
-
         allocator_type get_allocator() const noexcept
         {
-            return allocator_type();
+            return node_allocator::get_alloc();
         }
 
         /*
-         * Element access
-         * */
-        reference front();
-        const_reference front() const;
-
-        reference back();
-        const_reference back() const;
-
-        /*
-         * Iterator
+         * Capacity
          * */
-        iterator begin() noexcept;
-        const_iterator begin() const noexcept;
-        const_iterator cbegin() const noexcept;
-
-        iterator end() noexcept;
-        const_iterator end() const noexcept;
-        const_iterator cend() const noexcept;
+        // 并发修改时只是某一时刻的近似值
+        size_type size() const noexcept
+        {
+            return num_of_nodes.load(std::memory_order_relaxed);
+        }
 
-        reverse_iterator rbegin() noexcept;
-        const_reverse_iterator rbegin() const noexcept;
-        const_reverse_iterator crbegin() const noexcept;
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
 
-        reverse_iterator rend() noexcept;
-        const_reverse_iterator rend() const noexcept;
-        const_reverse_iterator crend() const noexcept;
+        // 已摘下但尚未释放的节点个数
+        size_type pending_reclaim() const noexcept
+        {
+            return limbo.pending();
+        }
 
         /*
-         * Capacity
+         * Lookup
          * */
-        bool empty() const noexcept;
-        size_type size() const noexcept;
-        size_type max_size() const noexcept;
+        bool contains(const T &v) const;
+
+        // 依次把未被删除的元素交给f，遍历期间可以有并发的插入与删除
+        template <typename Function>
+        void for_each(Function f) const;
 
         /*
          * Modifiers
          * */
-        void clear() noexcept;
-
-        iterator insert(const_iterator pos, const value_type &value);
-        iterator insert(const_iterator pos, value_type &&value);
-        iterator insert(const_iterator pos, size_type count, const value_type &value);
-
-        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
-        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        // 元素已存在时返回false
+        bool insert(const T &v)
         {
-            if (first != last)
-            {
-                iterator rt = insert(pos, *first++);
-                pos = const_iterator(rt.node);
-                ++pos;
-                auto inserter = stl::insert_iterator(*this, iterator(pos.node));
-
-                while (first != last)
-                    *inserter = *first++;
-
-                return rt;
-            }
-            else
-                return iterator(pos.node);
+            return emplace(v);
         }
 
-        iterator insert(const_iterator pos, std::initializer_list<value_type> ilist);
-
-        template <class... Args>
-        iterator emplace(const_iterator pos, Args &&...args);
-
-        iterator erase(const_iterator pos);
-        iterator erase(const_iterator first, const_iterator last);
-
-        void push_back(const value_type &value);
-        void push_back(value_type &&value);
-
-        template <typename... Args>
-        reference emplace_back(Args &&...args);
-
-        void pop_back();
-
-        void push_front(const T &value);
-        void push_front(T &&value);
+        bool insert(T &&v)
+        {
+            return emplace(std::move(v));
+        }
 
         template <class... Args>
-        reference emplace_front(Args &&...args);
-
-        void pop_front();
-
-        void resize(size_type count);
-        void resize(size_type count, const value_type &value);
-
-        void swap(list &other) noexcept;
-
-        /*
-         * Operations
-         * */
-        void merge(list &other) { merge(std::move(other)); }
-        void merge(list &&other);
-
-        template <typename Compare>
-        void merge(list &other, Compare comp);
-        template <typename Compare>
-        void merge(list &&other, Compare comp);
-
-        void splice(const_iterator pos, list &other);
-        void splice(const_iterator pos, list &&other);
-
-        void splice(const_iterator pos, list &other, const_iterator it);
-        void splice(const_iterator pos, list &&other, const_iterator it);
+        bool emplace(Args &&...args);
 
-        void splice(const_iterator pos, list &other,
-                    const_iterator first, const_iterator last);
-        void splice(const_iterator pos, list &&other,
-                    const_iterator first, const_iterator last);
+        // 元素不存在时返回false
+        bool erase(const T &v);
 
-        size_type remove(const T &value);
-    
-        template <class UnaryPredicate>
-        size_type remove_if(UnaryPredicate p);
-
-        void reverse() noexcept;
-
-        size_type unique();
-
-        template <typename BinaryPredicate>
-        size_type unique(BinaryPredicate p);
-
-        void sort();
-        template <class Compare>
-        void sort(Compare comp);
+        // 不能与其他操作并发
+        void clear() noexcept;
     };
 
-    /*
-     *  constructor
-     * */
-    template <typename T, typename Alloc>
-    list<T, Alloc>::list(size_type count, const T &value)
+    template <typename T, typename Compare, typename Alloc, typename Reclaimer>
+    template <typename Before>
+    void lockfree_list<T, Compare, Alloc, Reclaimer>::find(guard_type &guard, const node_base *start, Before before,
+                                                           node_base *&pred, Node *&cur) const
     {
-        empty_initialize();
+        pred = const_cast<node_base *>(start);
+    retry:
+        cur = ptr(pred->next.load(std::memory_order_acquire));
+        while (cur)
+        {
+            if constexpr (Reclaimer::protects)
+            {
+                // 公布cur之后确认它仍是pred的后继，pred带标记时同样失败
+                guard.protect(HP_CUR, cur);
+                if (pred->next.load(std::memory_order_seq_cst) != link_of(cur))
+                {
+                    pred = const_cast<node_base *>(&head);
+                    goto retry;
+                }
+            }
+
+            uintptr_t next = cur->next.load(std::memory_order_acquire);
+            if constexpr (Reclaimer::protects)
+            {
+                guard.protect(HP_NEXT, ptr(next));
+                if (cur->next.load(std::memory_order_seq_cst) != next)
+                    goto retry;
+            }
 
-        while (count--)
-            insert(cend(), value);
+            if (is_marked(next))
+            {
+                // cur已被逻辑删除，把它从pred后摘下；pred变化（包括pred本身被删除）时从头开始
+                uintptr_t expected = link_of(cur);
+                if (!pred->next.compare_exchange_strong(expected, next & ~uintptr_t(1), std::memory_order_acq_rel,
+                                                        std::memory_order_acquire))
+                {
+                    pred = const_cast<node_base *>(&head);
+                    goto retry;
+                }
+                retire(cur);
+                cur = ptr(next);
+                continue;
+            }
+            if (!before(cur->data))
+                return;
+            pred = cur;
+            guard.protect(HP_PREV, cur);
+            cur = ptr(next);
+        }
     }
 
-    template <typename T, typename Alloc>
-    list<T, Alloc>::list(const list &other)
+    template <typename T, typename Compare, typename Alloc, typename Reclaimer>
+    bool lockfree_list<T, Compare, Alloc, Reclaimer>::contains(const T &v) const
     {
-        empty_initialize();
-
-        // 1.首先逐个节点赋值
-        auto bg = begin();
-        auto ed = end();
-        auto cbg = other.cbegin();
-        auto ced = other.cend();
-
-        while (bg != ed && cbg != ced)
+        guard_type guard;
+        if constexpr (Reclaimer::protects)
         {
-            stl::destroy(&*bg);
-            stl::construct(&*bg, *cbg);
-
-            ++bg;
-            ++cbg;
+            // 未被保护的节点不能跨越，借助find逐个验证
+            node_base *pred;
+            Node *cur;
+            find(guard, v, pred, cur);
+            return cur && equal(cur->data, v);
         }
-
-        // 如果节点数不够，则插入新节点
-        if (cbg != ced)
+        else
         {
-            while (cbg != ced)
-                push_back(*cbg++);
+            Node *cur = ptr(head.next.load(std::memory_order_acquire));
+            while (cur && comp(cur->data, v))
+                cur = ptr(cur->next.load(std::memory_order_acquire));
+            return cur && equal(cur->data, v) && !is_marked(cur->next.load(std::memory_order_acquire));
         }
-        else if (bg != ed) // 如果有多余节点则释放掉
-            erase(const_iterator(bg), const_iterator(ed));
-
-        // update number of nodes
-        num_of_nodes = other.num_of_nodes;
-    }
-
-    template <typename T, typename Alloc>
-    list<T, Alloc>::list(list &&other)
-    {
-        empty_initialize();
-
-        transfer(end(), other.begin(), other.end());
-
-        num_of_nodes = other.num_of_nodes;
-        other.num_of_nodes = 0;
-    }
-
-    template <typename T, typename Alloc>
-    list<T, Alloc>::list(std::initializer_list<T> init) : list(init.begin(), init.end())
-    {
-    }
-
-    /*
-     *  destructor
-     * */
-    template <typename T, typename Alloc>
-    list<T, Alloc>::~list()
-    {
-        clear();
-        put_node(head);
-        num_of_nodes = 0;
-    }
-
-    /*
-     * assignment operation
-     * */
-    template <typename T, typename Alloc>
-    list<T, Alloc> &
-    list<T, Alloc>::operator=(const list &other)
-    {
-        this->assign(other.begin(), other.end());
-        return *this;
-    }
-
-    template <typename T, typename Alloc>
-    list<T, Alloc> &
-    list<T, Alloc>::operator=(list &&other) noexcept
-    {
-        // Free old storage
-        clear();
-
-        transfer(end(), other.begin(), other.end());
-
-        num_of_nodes = other.num_of_nodes;
-        other.num_of_nodes = 0;
-
-        return *this;
-    }
-
-    template <typename T, typename Alloc>
-    list<T, Alloc> &
-    list<T, Alloc>::operator=(std::initializer_list<T> ilist)
-    {
-        this->assign(ilist.begin(), ilist.end());
-        return *this;
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::assign(size_type count, const value_type &value)
-    {
-        clear();
-
-        while (count--)
-            insert(end(), value);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::assign(std::initializer_list<T> ilist)
-    {
-        this->assign(ilist.begin(), ilist.end());
-    }
-
-    /*
-     * Element access
-     * */
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::reference
-    list<T, Alloc>::front()
-    {
-        return const_cast<reference>(const_cast<const list &>(*this).front());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_reference
-    list<T, Alloc>::front() const
-    {
-        return *begin();
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::reference
-    list<T, Alloc>::back()
-    {
-        return const_cast<reference>(const_cast<const list &>(*this).back());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_reference
-    list<T, Alloc>::back() const
-    {
-        return *(--end());
-    }
-
-    /*
-     * Iterator
-     * */
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::begin() noexcept
-    {
-        return iterator(head->next);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_iterator
-    list<T, Alloc>::begin() const noexcept
-    {
-        return const_iterator(head->next);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_iterator
-    list<T, Alloc>::cbegin() const noexcept
-    {
-        return const_iterator(head->next);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::end() noexcept
-    {
-        return iterator(head);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_iterator
-    list<T, Alloc>::end() const noexcept
-    {
-        return const_iterator(head);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_iterator
-    list<T, Alloc>::cend() const noexcept
-    {
-        return const_iterator(head);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::reverse_iterator
-    list<T, Alloc>::rbegin() noexcept
-    {
-        return reverse_iterator(end());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_reverse_iterator
-    list<T, Alloc>::rbegin() const noexcept
-    {
-        return const_reverse_iterator(end());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_reverse_iterator
-    list<T, Alloc>::crbegin() const noexcept
-    {
-        return const_reverse_iterator(end());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::reverse_iterator
-    list<T, Alloc>::rend() noexcept
-    {
-        return reverse_iterator(begin());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_reverse_iterator
-    list<T, Alloc>::rend() const noexcept
-    {
-        return const_reverse_iterator(begin());
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::const_reverse_iterator
-    list<T, Alloc>::crend() const noexcept
-    {
-        return const_reverse_iterator(begin());
-    }
-
-    /*
-     * Capacity
-     * */
-    template <typename T, typename Alloc>
-    bool
-    list<T, Alloc>::empty() const noexcept
-    {
-        return num_of_nodes == 0;
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::size_type
-    list<T, Alloc>::size() const noexcept
-    {
-        return num_of_nodes;
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::size_type
-    list<T, Alloc>::max_size() const noexcept
-    {
-        return static_cast<size_type>(-1l);
-    }
-
-    /*
-     * Modifiers
-     * */
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::clear() noexcept
-    {
-        erase(cbegin(), cend());
-        // update number of nodes
-        num_of_nodes = 0;
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::insert(const_iterator pos, const value_type &value)
-    {
-        value_type cv = value;
-        return insert(pos, std::move(cv));
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::insert(const_iterator pos, value_type &&value)
-    {
-        link_type cur = link_type(pos.node);
-
-        auto node = create_node(std::forward<value_type>(value));
-
-        node->prev = cur->prev;
-        cur->prev->next = node;
-
-        node->next = cur;
-        cur->prev = node;
-
-        // update number of nodes
-        ++num_of_nodes;
-
-        return iterator(node);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::insert(const_iterator pos, size_type count, const value_type &value)
-    {
-        iterator it = iterator(pos.node);
-        while (count--)
-            pos = const_iterator(insert(pos, value).node);
-
-        return iterator(pos.node);
     }
 
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::insert(const_iterator pos, std::initializer_list<value_type> ilist)
+    template <typename T, typename Compare, typename Alloc, typename Reclaimer>
+    template <typename Function>
+    void lockfree_list<T, Compare, Alloc, Reclaimer>::for_each(Function f) const
     {
-        return insert(pos, ilist.begin(), ilist.end());
-    }
-
-    template <typename T, typename Alloc>
-    template <class... Args>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::emplace(const_iterator pos, Args &&...args)
-    {
-        return insert(pos, std::move(value_type(std::forward<Args>(args)...)));
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::erase(const_iterator pos)
-    {
-        auto prev_node = link_type(pos.node)->prev;
-        auto next_node = link_type(pos.node)->next;
-
-        prev_node->next = next_node;
-        next_node->prev = prev_node;
-
-        destroy_node((link_type)(pos.node));
-
-        // update number of nodes
-        --num_of_nodes;
-
-        return iterator(next_node);
-    }
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::iterator
-    list<T, Alloc>::erase(const_iterator first, const_iterator last)
-    {
-        while (first != last)
-            first = const_iterator(erase(first).node);
-        return iterator(first.node);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::push_back(const value_type &value)
-    {
-        insert(cend(), value);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::push_back(value_type &&value)
-    {
-        insert(end(), std::move(value));
-    }
-
-    template <typename T, typename Alloc>
-    template <typename... Args>
-    typename list<T, Alloc>::reference
-    list<T, Alloc>::emplace_back(Args &&...args)
-    {
-        return *emplace(end(), std::forward<Args>(args)...);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::pop_back()
-    {
-        erase(--end());
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::push_front(const T &value)
-    {
-        insert(begin(), value);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::push_front(T &&value)
-    {
-        insert(begin(), std::move(value));
-    }
-
-    template <typename T, typename Alloc>
-    template <class... Args>
-    typename list<T, Alloc>::reference
-    list<T, Alloc>::emplace_front(Args &&...args)
-    {
-        insert(begin(), std::move(value_type(std::forward<Args>(args)...)));
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::pop_front()
-    {
-        erase(begin());
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::resize(size_type count)
-    {
-        resize(count, value_type());
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::resize(size_type count, const value_type &value)
-    {
-        num_of_nodes = count;
-        auto iter = this->begin();
-
-        while (count)
+        guard_type guard;
+        if constexpr (Reclaimer::protects)
         {
-            if (iter != end() && *iter != value)
+            // 每次从刚访问过的节点出发找下一个大于它的节点，该节点被删除时find从头开始
+            node_base *pred;
+            Node *cur;
+            find(guard, &head, [](const T &) { return false; }, pred, cur);
+            while (cur)
             {
-                stl::destroy(&*iter);
-                stl::construct(&*iter, value);
+                f(static_cast<const T &>(cur->data));
+                Node *key = cur;
+                guard.protect(HP_KEY, key);
+                find(guard, key, [&](const T &x) { return !comp(key->data, x); }, pred, cur);
             }
-            else
-                iter = insert(iter, value);
-            ++iter;
-            --count;
         }
-
-        erase(iter, end());
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::swap(list &other) noexcept
-    {
-        stl::swap(other.head, head);
-        stl::swap(other.num_of_nodes, num_of_nodes);
-    }
-
-    /*
-     * Operations
-     * */
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::merge(list &&other)
-    {
-        merge(std::move(other), std::less<T>());
-    }
-
-    template <typename T, typename Alloc>
-    template <typename Compare>
-    void
-    list<T, Alloc>::merge(list &other, Compare comp)
-    {
-        merge(std::move(other), comp);
-    }
-
-    template <typename T, typename Alloc>
-    template <typename Compare>
-    void
-    list<T, Alloc>::merge(list &&other, Compare comp)
-    {
-        iterator first1 = begin();
-        iterator last1 = end();
-        iterator first2 = other.begin();
-        iterator last2 = other.end();
-
-        while (first1 != last1 && first2 != last2)
+        else
         {
-            if (comp(*first2, *first1))
+            for (Node *cur = ptr(head.next.load(std::memory_order_acquire)); cur;)
             {
-                iterator next = first2;
-                transfer(first1, first2, ++next);
-                first2 = next;
+                uintptr_t next = cur->next.load(std::memory_order_acquire);
+                if (!is_marked(next))
+                    f(static_cast<const T &>(cur->data));
+                cur = ptr(next);
             }
-            else
-                ++first1;
         }
-
-        transfer(last1, first2, last2);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::splice(const_iterator pos, list &other)
-    {
-        splice(pos, std::move(other));
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::splice(const_iterator pos, list &&other)
-    {
-        // this is a undefined behavior if other is itself, but we prevent this behavior
-        if (&other == this)
-            return;
-
-        transfer(pos, other.begin(), other.end());
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::splice(const_iterator pos, list &other, const_iterator it)
-    {
-        splice(pos, std::move(other), it);
     }
 
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::splice(const_iterator pos, list &&other, const_iterator it)
-    {
-        // this is a undefined behavior if other is itself, but we prevent this behavior
-        if (&other == this)
-            return;
-        iterator nit = it;
-        ++nit;
-
-        if (pos == it || pos == nit)
-            return;
-        transfer(pos, it, ++it);
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::splice(const_iterator pos, list &other,
-                           const_iterator first, const_iterator last)
-    {
-        splice(pos, std::move(other), first, last);
-    }
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::splice(const_iterator pos, list &&other,
-                           const_iterator first, const_iterator last)
-    {
-        // this is a undefined behavior if other is itself, but we prevent this behavior
-        if (&other == this)
-            return;
-        transfer(pos, first, last);
-    }
-
-
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::size_type 
-    list<T, Alloc>::remove(const T &value)
+    template <typename T, typename Compare, typename Alloc, typename Reclaimer>
+    template <class... Args>
+    bool lockfree_list<T, Compare, Alloc, Reclaimer>::emplace(Args &&...args)
     {
-        iterator first = begin();
-        iterator last = end();
-        size_type rt = 0;
-
-        while (first != last)
+        // 先构造节点，以节点中的元素作为查找的关键字
+        Node *node = create_node(std::forward<Args>(args)...);
+        guard_type guard;
+        while (true)
         {
-            if (*first == value)
+            node_base *pred;
+            Node *cur;
+            find(guard, node->data, pred, cur);
+            if (cur && equal(cur->data, node->data))
             {
-                first = erase(first);
-                ++rt;
+                destroy_node(node);
+                return false;
+            }
+
+            node->next.store(link_of(cur), std::memory_order_relaxed);
+            uintptr_t expected = link_of(cur);
+            if (pred->next.compare_exchange_strong(expected, link_of(node), std::memory_order_release,
+                                                   std::memory_order_relaxed))
+            {
+                num_of_nodes.fetch_add(1, std::memory_order_relaxed);
+                return true;
             }
-            else
-                ++first;
         }
-        
-        return rt;
     }
 
-    
-    template <typename T, typename Alloc>
-    template <class UnaryPredicate>
-    typename list<T, Alloc>::size_type 
-    list<T, Alloc>::remove_if(UnaryPredicate p)
+    template <typename T, typename Compare, typename Alloc, typename Reclaimer>
+    bool lockfree_list<T, Compare, Alloc, Reclaimer>::erase(const T &v)
     {
+        guard_type guard;
+        while (true)
+        {
+            node_base *pred;
+            Node *cur;
+            find(guard, v, pred, cur);
+            if (!cur || !equal(cur->data, v))
+                return false;
 
-    }
-
-    template <typename T, typename Alloc>
-    void
-    list<T, Alloc>::reverse() noexcept
-    {
-        iterator first = begin();
-        iterator last = end();
-        auto old = first;
+            // 逻辑删除：在cur的next上置标记，成功的线程是删除者
+            uintptr_t next = cur->next.load(std::memory_order_acquire);
+            if (is_marked(next) ||
+                !cur->next.compare_exchange_strong(next, next | 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                continue;
+            num_of_nodes.fetch_sub(1, std::memory_order_relaxed);
 
-        while (++first != last)
-        {
-            transfer(begin(), old, first);
-            old = first;
+            // 物理删除，失败时由find摘下
+            uintptr_t expected = link_of(cur);
+            if (pred->next.compare_exchange_strong(expected, next, std::memory_order_acq_rel, std::memory_order_relaxed))
+                retire(cur);
+            else
+                find(guard, v, pred, cur);
+            return true;
         }
     }
 
-    template <typename T, typename Alloc>
-    typename list<T, Alloc>::size_type
-    list<T, Alloc>::unique()
+    template <typename T, typename Compare, typename Alloc, typename Reclaimer>
+    void lockfree_list<T, Compare, Alloc, Reclaimer>::clear() noexcept
     {
-        iterator first = begin();
-        iterator last = end();
-        size_type old_num = num_of_nodes;
-
-        auto next = first;
-        while (++next != last)
+        Node *cur = ptr(head.next.exchange(0, std::memory_order_acquire));
+        while (cur)
         {
-            if (*first == *next)
-                erase(next);
-            else
-                first = next;
-            next = first;
+            Node *next = ptr(cur->next.load(std::memory_order_relaxed));
+            destroy_node(cur);
+            cur = next;
         }
-
-        return old_num - num_of_nodes;
+        limbo.drain(*this);
+        num_of_nodes.store(0, std::memory_order_relaxed);
     }
-
 } // namespace stl
 
-#endif
+#endif //MINISTL_THS_LIST_HH
@@ -5,6 +5,7 @@
 #ifndef MINISTL_THS_VECTOR_HH
 #define MINISTL_THS_VECTOR_HH
 
+#include <atomic>
 #include <cstddef>
 #include <cstring>
 #include <initializer_list>
@@ -18,6 +19,7 @@
 
 #include "algobase.hh"
 #include "alloc.hh"
+#include "ebr.hh"
 #include "iterator.hh"
 #include "uninitialized.hh"
 
@@ -28,6 +30,10 @@ namespace stl {
  * 1. 考虑到并发的性能，仅支持只读迭代器
  * 2. 不返回non-const饮用和non-const指针，防止外泄内部数据的引用和指针
  *     使得其他使用者绕过锁修改内部数据
+ * 3. 快照通过epoch_ptr发布，读者在epoch_guard中读取当前快照，不加锁也不修改引用计数；
+ *     写者之间用mtx互斥，每次修改都在快照的副本上进行再发布，旧快照由EBR延迟释放
+ *     因此读操作可以随核数扩展，写操作的代价为O(n)，适合读多写少的场景
+ * 4. 快照随时可能被替换，元素按值返回；迭代器与data()共享所属快照的所有权，不受替换影响
  * */
 
 template <typename Vector> class ths_vector_iterator {
@@ -83,6 +89,12 @@ template <typename Vector> class ths_vector_iterator {
         return *this;
     }
 
+    // 在所属快照中的下标
+    difference_type index() const
+    {
+        return iter - ptr->begin();
+    }
+
     self operator--(int)
     {
         auto temp = *this;
@@ -139,10 +151,37 @@ template <typename T, typename Alloc = alloc> class ths_vector {
     using data_allocator = simple_alloc<value_type, Alloc>;
 
     // 两个数据成员
-    // 1. 指向non-thread-safe的vector的共享指针
-    // 2. 互斥锁
-    std::shared_ptr<Vector> p_vec{};
-    mutable std::mutex              mtx{};
+    // 1. 由EBR管理的当前快照，快照发布之后不再修改；
+    //    用shared_ptr保存是为了让迭代器在快照被替换之后继续持有它
+    // 2. 写者之间的互斥锁
+    epoch_ptr<std::shared_ptr<Vector>, Alloc> p_vec;
+    mutable std::mutex                         mtx{};
+
+    // 读者在epoch_guard中取得当前快照，guard结束之后不能再访问
+    const Vector& snapshot() const
+    {
+        return *p_vec.load();
+    }
+
+    // 取得当前快照的所有权，供迭代器等需要在guard之外访问快照的场合使用
+    std::shared_ptr<Vector> share() const
+    {
+        epoch_guard guard;
+        return p_vec.load();
+    }
+
+    // 持有mtx时复制当前快照，修改副本之后再publish；
+    // 当前快照只会被持有mtx的写者替换，这里不需要epoch_guard
+    std::shared_ptr<Vector> copy() const
+    {
+        return std::make_shared<Vector>(*p_vec.load());
+    }
+
+    // 持有mtx时发布新快照，正在读取旧快照的读者不受影响
+    void publish(std::shared_ptr<Vector> next)
+    {
+        p_vec.store(std::move(next));
+    }
 
   public:
     /*
@@ -152,7 +191,8 @@ template <typename T, typename Alloc = alloc> class ths_vector {
 
     ths_vector(const ths_vector& other);
 
-    ths_vector(ths_vector&& other) noexcept;
+    // 需要为共享的快照分配新的epoch_box，可能抛出异常
+    ths_vector(ths_vector&& other);
 
     explicit ths_vector(size_type n) : p_vec(std::make_shared<Vector>(n)) {}
 
@@ -181,6 +221,7 @@ template <typename T, typename Alloc = alloc> class ths_vector {
      * */
     ths_vector& operator=(const ths_vector& other);
 
+    // 与other交换快照，不分配内存
     ths_vector& operator=(ths_vector&& other) noexcept;
 
     ths_vector& operator=(std::initializer_list<T> ilist);
@@ -197,40 +238,39 @@ template <typename T, typename Alloc = alloc> class ths_vector {
      * Element access
      * Read-only
      * */
-    const_reference at(size_type pos) const
+    value_type at(size_type pos) const
     {
-        std::lock_guard<std::mutex> guard(mtx);
+        epoch_guard   guard;
+        const Vector& vec = snapshot();
 
-        if (pos >= size()) {
-            error("%ld is larger than size %ld", pos, size());
-            throw new std::out_of_range("");
-        }
-        return *(p_vec->begin() + pos);
+        if (pos >= vec.size())
+            throw std::out_of_range("ths_vector::at");
+        return vec[pos];
     }
 
-    const_reference operator[](size_type pos) const
+    value_type operator[](size_type pos) const
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return *(p_vec->begin() + pos);
+        epoch_guard guard;
+        return snapshot()[pos];
     }
 
-    const_reference front() const
+    value_type front() const
     {
-        std::lock_guard<std::mutex> guard(mtx);
-
-        return *p_vec->begin();
+        epoch_guard guard;
+        return snapshot().front();
     }
 
-    const_reference back() const
+    value_type back() const
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return *(p_vec->end() - 1);
+        epoch_guard guard;
+        return snapshot().back();
     }
 
-    const_pointer data() const noexcept
+    // 返回的指针共享快照的所有权，快照被替换之后仍然有效
+    std::shared_ptr<const value_type> data() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return p_vec->data();
+        auto vec = share();
+        return std::shared_ptr<const value_type>(vec, vec->data());
     }
 
     /*
@@ -238,50 +278,43 @@ template <typename T, typename Alloc = alloc> class ths_vector {
      * */
     const_iterator begin() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return iterator(p_vec, 0);
+        return iterator(share(), 0);
     }
 
     const_iterator cbegin() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return iterator(p_vec, 0);
+        return begin();
     }
 
     const_iterator end() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return iterator(p_vec, p_vec->size());
+        auto vec = share();
+        return iterator(vec, vec->size());
     }
 
     const_iterator cend() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return iterator(p_vec, p_vec->size());
+        return end();
     }
 
     const_reverse_iterator rbegin() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return reverse_iterator(iterator(p_vec, 0));
+        return reverse_iterator(end());
     }
 
     const_reverse_iterator crbegin() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return const_reverse_iterator(iterator(p_vec, 0));
+        return const_reverse_iterator(end());
     }
 
     const_reverse_iterator rend() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return reverse_iterator(iterator(p_vec, p_vec->size()));
+        return reverse_iterator(begin());
     }
 
     const_reverse_iterator crend() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-        return const_reverse_iterator(iterator(p_vec, p_vec->size()));
+        return const_reverse_iterator(begin());
     }
 
     /*
@@ -289,16 +322,14 @@ template <typename T, typename Alloc = alloc> class ths_vector {
      * */
     bool empty() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-
-        return p_vec->empty();
+        epoch_guard guard;
+        return snapshot().empty();
     }
 
     size_type size() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-
-        return p_vec->size();
+        epoch_guard guard;
+        return snapshot().size();
     }
 
     size_type max_size() const noexcept  // copy from cppreference
@@ -310,9 +341,8 @@ template <typename T, typename Alloc = alloc> class ths_vector {
 
     size_type capacity() const noexcept
     {
-        std::lock_guard<std::mutex> guard(mtx);
-
-        return p_vec->capacity();
+        epoch_guard guard;
+        return snapshot().capacity();
     }
 
     void shrink_to_fit();
@@ -320,7 +350,7 @@ template <typename T, typename Alloc = alloc> class ths_vector {
     /*
      * Modifiers
      * */
-    void clear() noexcept;
+    void clear();
 
     // insert
     iterator insert(const_iterator pos, T&& elem);
@@ -331,12 +361,12 @@ template <typename T, typename Alloc = alloc> class ths_vector {
     {
         std::lock_guard<std::mutex> guard(mtx);
 
-        if (p_vec.use_count() > 1) {
-            p_vec.reset(new Vector(*p_vec));
-        }
-        assert(p_vec.use_count() == 1);
         // 在新的副本上修改
-        return p_vec->insert(pos, first, last);
+        auto next  = copy();
+        auto index = pos.index();
+        next->insert(next->begin() + index, first, last);
+        publish(next);
+        return iterator(next, index);
     }
 
     iterator insert(const_iterator pos, std::initializer_list<T> ilist);
@@ -351,7 +381,7 @@ template <typename T, typename Alloc = alloc> class ths_vector {
     void push_back(const T& elem);
     void push_back(T&& elem);
 
-    template <typename... Args> reference emplace_back(Args&&... args);
+    template <typename... Args> value_type emplace_back(Args&&... args);
 
     void pop_back();
 
@@ -365,13 +395,13 @@ template <typename T, typename Alloc = alloc> class ths_vector {
  * Constructors
  * */
 template <typename T, typename Alloc>
-ths_vector<T, Alloc>::ths_vector(const ths_vector& rhs) : p_vec(rhs.p_vec)
+ths_vector<T, Alloc>::ths_vector(const ths_vector& rhs) : p_vec(rhs.share())
 {
 }
 
 template <typename T, typename Alloc>
-ths_vector<T, Alloc>::ths_vector(ths_vector&& rhs) noexcept
-    : p_vec(std::move(rhs.p_vec))
+ths_vector<T, Alloc>::ths_vector(ths_vector&& rhs)
+    : p_vec(rhs.share())  // 快照不会被修改，移动与复制一样只共享快照
 {
 }
 
@@ -389,29 +419,11 @@ ths_vector<T, Alloc>&
 ths_vector<T, Alloc>::operator=(const ths_vector<T, Alloc>& rhs)
 {
     if (this != &rhs) {
-        // 按地址大小顺序获取锁，防止死锁
-        if (&mtx < &rhs.mtx) {
-            std::lock_guard<std::mutex> guard1(mtx);
-            std::lock_guard<std::mutex> guard2(rhs.mtx);
-
-            // RCU，如果当前vector存在其他读者，则复制一份再修改
-            if (p_vec.use_count() > 1) {
-                p_vec.reset(new Vector(*p_vec));
-            }
-            assert(p_vec.use_count() == 1);
-            p_vec = rhs.p_vec;
-        }
-        else {
-            std::lock_guard<std::mutex> guard1(rhs.mtx);
-            std::lock_guard<std::mutex> guard2(mtx);
-            // RCU，如果当前vector存在其他读者，则复制一份再修改
-            if (p_vec.use_count() > 1) {
-                p_vec.reset(new Vector(*p_vec));
-            }
-            assert(p_vec.use_count() == 1);
-
-            p_vec = rhs.p_vec;
-        }
+        // 快照不会被原地修改，可以直接共享rhs的快照
+        auto vec = rhs.share();
+
+        std::lock_guard<std::mutex> guard(mtx);
+        publish(std::move(vec));
     }
     return *this;
 }
@@ -420,33 +432,8 @@ template <typename T, typename Alloc>
 ths_vector<T, Alloc>&
 ths_vector<T, Alloc>::operator=(ths_vector<T, Alloc>&& rhs) noexcept
 {
-    if (this != &rhs) {
-        // 按地址大小顺序获取锁，防止死锁
-        if (&mtx < &rhs.mtx) {
-            std::lock_guard<std::mutex> guard1(mtx);
-            std::lock_guard<std::mutex> guard2(rhs.mtx);
-
-            // RCU，如果当前vector存在其他读者，则复制一份再修改
-            if (p_vec.use_count() > 1) {
-                p_vec.reset(new Vector(*p_vec));
-            }
-            assert(p_vec.use_count() == 1);
-
-            p_vec = std::move(rhs.p_vec);  // 在这之后rh.p_vec会变为nullptr
-        }
-        else {
-            std::lock_guard<std::mutex> guard1(rhs.mtx);
-            std::lock_guard<std::mutex> guard2(mtx);
-
-            // RCU，如果当前vector存在其他读者，则复制一份再修改
-            if (p_vec.use_count() > 1) {
-                p_vec.reset(new Vector(*p_vec));
-            }
-            assert(p_vec.use_count() == 1);
-
-            p_vec = std::move(rhs.p_vec);
-        }
-    }
+    // publish需要分配新的epoch_box，交换则只交换两个指针，rhs得到原来的内容
+    swap(rhs);
     return *this;
 }
 
@@ -455,11 +442,7 @@ ths_vector<T, Alloc>&
 ths_vector<T, Alloc>::operator=(std::initializer_list<T> lst)
 {
     std::lock_guard<std::mutex> guard(mtx);
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
-    *p_vec = lst;
+    publish(std::make_shared<Vector>(lst));
 
     return *this;
 }
@@ -468,11 +451,7 @@ template <typename T, typename Alloc>
 void ths_vector<T, Alloc>::assign(size_type n, const T& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
-    p_vec->assign(n, elem);
+    publish(std::make_shared<Vector>(n, elem));
 }
 
 template <typename T, typename Alloc>
@@ -480,21 +459,14 @@ template <typename InputIt>
 void ths_vector<T, Alloc>::assign(InputIt first, InputIt last)
 {
     std::lock_guard<std::mutex> guard(mtx);
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
-    p_vec->assign(first, last);
+    publish(std::make_shared<Vector>(first, last));
 }
 
 template <typename T, typename Alloc>
 void ths_vector<T, Alloc>::assign(std::initializer_list<T> lst)
 {
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
-    p_vec->assign(lst);
+    std::lock_guard<std::mutex> guard(mtx);
+    publish(std::make_shared<Vector>(lst));
 }
 
 /*
@@ -504,43 +476,32 @@ template <typename T, typename Alloc>
 void ths_vector<T, Alloc>::reserve(size_type new_cap)
 {
     std::lock_guard<std::mutex> guard(mtx);
-    if (capacity() >= new_cap)
+    if (p_vec.load()->capacity() >= new_cap)
         return;
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改容量
-    p_vec->reserve(new_cap);
+    auto next = copy();
+    next->reserve(new_cap);
+    publish(next);
 }
 
 template <typename T, typename Alloc> void ths_vector<T, Alloc>::shrink_to_fit()
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
-    // 在新的副本上修改
-    p_vec->shrink_to_fit();
+    // 复制得到的副本本身没有多余的容量
+    publish(copy());
 }
 
 /*
  * Modifiers
  * */
 template <typename T, typename Alloc>
-void ths_vector<T, Alloc>::clear() noexcept
+void ths_vector<T, Alloc>::clear()
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
-    // 在新的副本上修改
-    p_vec->clear();
+    publish(std::make_shared<Vector>());
 }
 
 // insert
@@ -550,12 +511,12 @@ ths_vector<T, Alloc>::insert(const_iterator pos, const T& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->insert(pos, elem);
+    auto next  = copy();
+    auto index = pos.index();
+    next->insert(next->begin() + index, elem);
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -564,12 +525,12 @@ ths_vector<T, Alloc>::insert(const_iterator pos, T&& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->insert(pos, std::move(elem));
+    auto next  = copy();
+    auto index = pos.index();
+    next->insert(next->begin() + index, std::move(elem));
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -578,12 +539,12 @@ ths_vector<T, Alloc>::insert(const_iterator pos, size_type count, const T& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->insert(pos, count, elem);
+    auto next  = copy();
+    auto index = pos.index();
+    next->insert(next->begin() + index, count, elem);
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -592,12 +553,12 @@ ths_vector<T, Alloc>::insert(const_iterator pos, std::initializer_list<T> ilist)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->insert(pos, ilist);
+    auto next  = copy();
+    auto index = pos.index();
+    next->insert(next->begin() + index, ilist);
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -607,12 +568,12 @@ ths_vector<T, Alloc>::emplace(const_iterator pos, Args&&... args)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->emplace(pos, std::forward<Args>(args)...);
+    auto next  = copy();
+    auto index = pos.index();
+    next->emplace(next->begin() + index, std::forward<Args>(args)...);
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -621,12 +582,12 @@ ths_vector<T, Alloc>::erase(const_iterator pos)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->erase(pos);
+    auto next  = copy();
+    auto index = pos.index();
+    next->erase(next->begin() + index);
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -635,12 +596,12 @@ ths_vector<T, Alloc>::erase(const_iterator first, const_iterator last)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->erase(first, last);
+    auto next  = copy();
+    auto index = first.index();
+    next->erase(next->begin() + index, next->begin() + last.index());
+    publish(next);
+    return iterator(next, index);
 }
 
 template <typename T, typename Alloc>
@@ -648,12 +609,10 @@ void ths_vector<T, Alloc>::push_back(const T& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    p_vec->push_back(elem);
+    auto next = copy();
+    next->push_back(elem);
+    publish(next);
 }
 
 template <typename T, typename Alloc>
@@ -661,39 +620,34 @@ void ths_vector<T, Alloc>::push_back(T&& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    p_vec->push_back(std::move(elem));
+    auto next = copy();
+    next->push_back(std::move(elem));
+    publish(next);
 }
 
 template <typename T, typename Alloc>
 template <typename... Args>
-typename ths_vector<T, Alloc>::reference
+typename ths_vector<T, Alloc>::value_type
 ths_vector<T, Alloc>::emplace_back(Args&&... args)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    return p_vec->emplace_back(std::forward<Args>(args)...);
+    auto next = copy();
+    value_type elem(next->emplace_back(std::forward<Args>(args)...));
+    publish(next);
+    return elem;
 }
 
 template <typename T, typename Alloc> void ths_vector<T, Alloc>::pop_back()
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    p_vec->pop_back();
+    auto next = copy();
+    next->pop_back();
+    publish(next);
 }
 
 template <typename T, typename Alloc>
@@ -707,12 +661,10 @@ void ths_vector<T, Alloc>::resize(size_type size, const value_type& elem)
 {
     std::lock_guard<std::mutex> guard(mtx);
 
-    if (p_vec.use_count() > 1) {
-        p_vec.reset(new Vector(*p_vec));
-    }
-    assert(p_vec.use_count() == 1);
     // 在新的副本上修改
-    p_vec->resize(size, elem);
+    auto next = copy();
+    next->resize(size, elem);
+    publish(next);
 }
 
 template <typename T, typename Alloc>
@@ -722,55 +674,34 @@ void ths_vector<T, Alloc>::swap(ths_vector& other) noexcept
         return;
 
     // 按地址大小顺序获取锁，防止死锁
+    std::unique_lock<std::mutex> guard1, guard2;
     if (&mtx < &other.mtx) {
-        std::lock_guard<std::mutex> guard1(mtx);
-        std::lock_guard<std::mutex> guard2(other.mtx);
-
-        // RCU，如果当前vector存在其他读者，则复制一份再修改
-        if (p_vec.use_count() > 1) {
-            p_vec.reset(new Vector(*p_vec));
-        }
-        assert(p_vec.use_count() == 1);
-
-        p_vec->swap(*other.p_vec);
+        guard1 = std::unique_lock<std::mutex>(mtx);
+        guard2 = std::unique_lock<std::mutex>(other.mtx);
     }
     else {
-        std::lock_guard<std::mutex> guard1(other.mtx);
-        std::lock_guard<std::mutex> guard2(mtx);
-
-        // RCU，如果当前vector存在其他读者，则复制一份再修改
-        if (p_vec.use_count() > 1) {
-            p_vec.reset(new Vector(*p_vec));
-        }
-        assert(p_vec.use_count() == 1);
-
-        p_vec->swap(*other.p_vec);
+        guard1 = std::unique_lock<std::mutex>(other.mtx);
+        guard2 = std::unique_lock<std::mutex>(mtx);
     }
+
+    // 交换两个快照，读者看到的总是某一方完整的内容
+    p_vec.swap(other.p_vec);
 }
 
 /* Non-member functions */
+// 比较两个容器各自的一个快照，不加锁
 template <typename T, typename Alloc>
 bool operator==(
     const stl::ths_vector<T, Alloc>& lhs,
     const stl::ths_vector<T, Alloc>& rhs)
 {
-    // 按地址大小顺序获取锁，防止死锁
-    if (&lhs.mtx < &rhs.mtx) {
-        std::lock_guard<std::mutex> guard1(lhs.mtx);
-        std::lock_guard<std::mutex> guard2(rhs.mtx);
-
-        return (
-            lhs.size() == rhs.size() &&
-            stl::equal(lhs.begin(), lhs.end(), rhs.begin()));
-    }
-    else {
-        std::lock_guard<std::mutex> guard1(rhs.mtx);
-        std::lock_guard<std::mutex> guard2(lhs.mtx);
-
-        return (
-            lhs.size() == rhs.size() &&
-            stl::equal(lhs.begin(), lhs.end(), rhs.begin()));
+    auto l = lhs.begin(), r = rhs.begin();
+    auto l_end = lhs.end(), r_end = rhs.end();
+    for (; l != l_end && r != r_end; ++l, ++r) {
+        if (!(*l == *r))
+            return false;
     }
+    return l == l_end && r == r_end;
 }
 
 template <typename T, typename Alloc>
@@ -786,21 +717,8 @@ bool operator<(
     const stl::ths_vector<T, Alloc>& lhs,
     const stl::ths_vector<T, Alloc>& rhs)
 {
-    // 按地址大小顺序获取锁，防止死锁
-    if (&lhs.mtx < &rhs.mtx) {
-        std::lock_guard<std::mutex> guard1(lhs.mtx);
-        std::lock_guard<std::mutex> guard2(rhs.mtx);
-
-        return stl::lexicographical_compare(
-            lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
-    }
-    else {
-        std::lock_guard<std::mutex> guard1(rhs.mtx);
-        std::lock_guard<std::mutex> guard2(lhs.mtx);
-
-        return stl::lexicographical_compare(
-            lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
-    }
+    return stl::lexicographical_compare(
+        lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
 template <typename T, typename Alloc>
@@ -5,152 +5,57 @@
 #ifndef MINISTL_TYPE_STRAITS_HH
 #define MINISTL_TYPE_STRAITS_HH
 
+#include <type_traits>
+
 namespace stl
 {
     struct __true_type {};
     struct __false_type {};
 
-    template <typename T>
-    struct type_traits
-    {
-        using has_trivial_default_constructor = __false_type;
-        using has_trivial_copy_constructor = __false_type;
-        using has_trivial_assignment_operator = __false_type;
-        using has_trivial_destructor = __false_type;
-        using is_POD_type = __false_type;
-    };
-
-    template <>
-    struct type_traits<char>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<signed char>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<unsigned char>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-
-    template <>
-    struct type_traits<short>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<unsigned short>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<int>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<unsigned int>
+    // 把编译期的布尔值转换为__true_type或__false_type，以便按类型分派
+    template <bool B>
+    struct bool_type
     {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
+        using type = __false_type;
     };
 
     template <>
-    struct type_traits<long>
+    struct bool_type<true>
     {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
+        using type = __true_type;
     };
 
-    template <>
-    struct type_traits<unsigned long>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<float>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<double>
+    /*
+     * 各项性质由编译器提供的<type_traits>推导，因此用户定义的简单结构体（如struct {int a; double b;}）
+     * 同样可以走按字节复制、不调用析构函数等快速路径
+     * 仍然可以为特定的类型特化type_traits
+     * */
+    template <typename T>
+    struct type_traits
     {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-
-    template <>
-    struct type_traits<long double>
+        using has_trivial_default_constructor = typename bool_type<std::is_trivially_default_constructible<T>::value>::type;
+        using has_trivial_copy_constructor = typename bool_type<std::is_trivially_copy_constructible<T>::value>::type;
+        using has_trivial_assignment_operator = typename bool_type<std::is_trivially_copy_assignable<T>::value>::type;
+        using has_trivial_destructor = typename bool_type<std::is_trivially_destructible<T>::value>::type;
+        using is_POD_type = typename bool_type<std::is_trivial<T>::value && std::is_standard_layout<T>::value>::type;
+    };
+
+    /*
+     * 可以平凡重定位（trivially relocatable）的类型：把对象按字节搬到新的位置并且不再析构原来的对象，
+     * 等价于移动构造之后析构原对象。可以平凡复制的类型都满足这一点，
+     * 许多持有资源的类型（如只持有一个堆指针的消息结构体）虽然不能平凡复制，同样可以平凡重定位，
+     * 这类类型需要显式特化（opt-in）：
+     *     template <> struct stl::is_trivially_relocatable<Message> : std::true_type {};
+     * vector扩容时对满足该性质的类型直接交给配置器的reallocate
+     * */
+    template <typename T>
+    struct is_trivially_relocatable : std::is_trivially_copyable<T>
     {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
     };
 
     template <typename T>
-    struct type_traits<T *>
-    {
-        using has_trivial_default_constructor = __true_type;
-        using has_trivial_copy_constructor = __true_type;
-        using has_trivial_assignment_operator = __true_type;
-        using has_trivial_destructor = __true_type;
-        using is_POD_type = __true_type;
-    };
-    
+    using relocatable_type = typename bool_type<is_trivially_relocatable<T>::value>::type;
+
 } // namespace stl
 
 #endif
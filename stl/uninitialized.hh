@@ -5,6 +5,9 @@
 #ifndef MINISTL_UNINITIALIZED_HH
 #define MINISTL_UNINITIALIZED_HH
 
+#include <cstring>
+#include <utility>
+
 #include "algobase.hh"
 
 #include "type_traits.hh"
@@ -16,9 +19,8 @@ namespace stl
     ForwardIterator uninitialized_copy_aux(InputIterator first, InputIterator last,
                                          ForwardIterator result, __true_type)
     {
-        // 暂时不能调用
-        // return std::copy(first, last, result); // TODO: replace by our own copy function, as stl:copy
-        return uninitialized_copy_aux(first, last, result, __false_type());
+        // POD类型的构造等同于赋值，源与目的都是指针时stl::copy按字节复制
+        return stl::copy(first, last, result);
     }
 
     template <typename InputIterator, typename ForwardIterator>
@@ -99,7 +101,7 @@ namespace stl
     template <typename ForwardIterator, typename T>
     void uninitialized_fill_aux(ForwardIterator first, ForwardIterator last, const T &x, __true_type)
     {
-        std::fill(first, last, x); // TODO: replace by our own copy function, as stl:fill
+        stl::fill(first, last, x);
     }
 
     template <typename ForwardIterator, typename T>
@@ -132,6 +134,86 @@ namespace stl
         uninitialized_fill(first, last, x, value_type(first));
     }
 
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator uninitialized_move_if_noexcept_aux(InputIterator first, InputIterator last,
+                                                       ForwardIterator result, __false_type)
+    {
+        ForwardIterator cur = result;
+        try
+        {
+            for (; first != last; ++first, ++cur)
+                stl::construct(&*cur, std::move_if_noexcept(*first));
+        }
+        catch (...)
+        {
+            stl::destroy(result, cur);
+            throw;
+        }
+        return cur;
+    }
+
+    template <typename T>
+    T *uninitialized_move_if_noexcept_aux(T *first, T *last, T *result, __true_type)
+    {
+        if (first != last)
+            memmove(result, first, (last - first) * sizeof(T));
+        return result + (last - first);
+    }
+
+    /**
+     * move elements in [first, last) to uninitialized [result, result + (last - first)).
+     * 移动构造不会抛出异常（或者不能复制）时移动，否则复制，构造失败时已构造的元素被析构，原来的元素保持不变
+     * 连续存放的POD类型直接按字节复制
+     * @param   first	the beginning iterator of source range.
+     * @param   last    the end iterator of source range(not including).
+     * @param   result  the beginning iterator of destinatioin range.
+     * @return  Iterator points the next position of the last moved element.
+     **/
+    template <typename InputIterator, typename ForwardIterator>
+    ForwardIterator uninitialized_move_if_noexcept(InputIterator first, InputIterator last,
+                                                   ForwardIterator result)
+    {
+        return uninitialized_move_if_noexcept_aux(first, last, result, __false_type());
+    }
+
+    template <typename T>
+    T *uninitialized_move_if_noexcept(T *first, T *last, T *result)
+    {
+        using is_POD = typename type_traits<T>::is_POD_type;
+        return uninitialized_move_if_noexcept_aux(first, last, result, is_POD());
+    }
+
+    /**
+     * relocate elements in [first, last) to uninitialized [result, result + (last - first)),
+     * 即移动（或复制）到新的位置之后析构原来的元素，相当于把对象按字节搬到新的位置
+     * 构造失败时原来的元素保持不变
+     * @param   first	the beginning of source range.
+     * @param   last    the end of source range(not including).
+     * @param   result  the beginning of destinatioin range.
+     * @return  Pointer points the next position of the last relocated element.
+     **/
+    template <typename T>
+    T *uninitialized_relocate_aux(T *first, T *last, T *result, __true_type)
+    {
+        if (first != last)
+            memcpy(static_cast<void *>(result), static_cast<const void *>(first), (last - first) * sizeof(T));
+        return result + (last - first);
+    }
+
+    template <typename T>
+    T *uninitialized_relocate_aux(T *first, T *last, T *result, __false_type)
+    {
+        T *cur = uninitialized_move_if_noexcept(first, last, result);
+        stl::destroy(first, last);
+        return cur;
+    }
+
+    template <typename T>
+    T *uninitialized_relocate(T *first, T *last, T *result)
+    {
+        return uninitialized_relocate_aux(first, last, result, relocatable_type<T>());
+    }
+
 } // namespace stl
 
 #endif
\ No newline at end of file
@@ -0,0 +1,657 @@
+//
+// Created by rda on 2024/4/13.
+//
+
+#ifndef MINISTL_UNROLLED_LIST_HH
+#define MINISTL_UNROLLED_LIST_HH
+
+#include <algorithm>
+#include <initializer_list>
+#include <utility>
+
+#include "alloc.hh"
+#include "iterator.hh"
+#include "construct.hh"
+#include "uninitialized.hh"
+#include "algobase.hh"
+
+namespace stl
+{
+    // 默认每个节点约256字节的元素，元素很大时至少4个
+    template <typename T>
+    constexpr size_t unrolled_list_capacity()
+    {
+        return sizeof(T) * 4 >= 256 ? 4 : 256 / sizeof(T);
+    }
+
+    /* unrolled list node base, 头节点只有这一部分，count为0 */
+    struct unrolled_list_node_base
+    {
+        unrolled_list_node_base *prev;
+        unrolled_list_node_base *next;
+        size_t count; // 节点中的元素个数
+    };
+
+    /* unrolled list node, 连续保存至多Capacity个元素 */
+    template <typename T, size_t Capacity>
+    struct unrolled_list_node : unrolled_list_node_base
+    {
+        alignas(T) unsigned char storage[Capacity * sizeof(T)];
+
+        T *elems() noexcept
+        {
+            return reinterpret_cast<T *>(storage);
+        }
+
+        bool full() const noexcept
+        {
+            return count == Capacity;
+        }
+    };
+
+    /* unrolled list iterator, 由节点与元素在节点中的下标组成 */
+    template <typename T, size_t Capacity, typename Ref, typename Ptr>
+    struct unrolled_list_iterator
+    {
+        using iterator = unrolled_list_iterator<T, Capacity, T &, T *>;
+        using const_iterator = unrolled_list_iterator<T, Capacity, const T &, const T *>;
+
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = T;
+        using pointer = Ptr;
+        using reference = Ref;
+        using difference_type = ptrdiff_t;
+
+        using Self = unrolled_list_iterator;
+        using Node = unrolled_list_node<T, Capacity>;
+
+        unrolled_list_node_base *node{};
+        size_t index{};
+
+        unrolled_list_iterator() = default;
+
+        unrolled_list_iterator(const unrolled_list_node_base *n, size_t i)
+            : node(const_cast<unrolled_list_node_base *>(n)), index(i) {}
+
+        operator const_iterator() const
+        {
+            return const_iterator(node, index);
+        }
+
+        reference operator*() const
+        {
+            return static_cast<Node *>(node)->elems()[index];
+        }
+
+        pointer operator->() const
+        {
+            return &(operator*());
+        }
+
+        Self &operator++()
+        {
+            if (++index == node->count)
+            {
+                node = node->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        Self operator++(int)
+        {
+            Self temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        Self &operator--()
+        {
+            if (index == 0)
+            {
+                node = node->prev;
+                index = node->count;
+            }
+            --index;
+            return *this;
+        }
+
+        Self operator--(int)
+        {
+            Self temp = *this;
+            --*this;
+            return temp;
+        }
+
+        friend bool operator==(const Self &lhs, const Self &rhs)
+        {
+            return lhs.node == rhs.node && lhs.index == rhs.index;
+        }
+
+        friend bool operator!=(const Self &lhs, const Self &rhs)
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+    /*
+     * 展开链表：每个节点连续保存至多Capacity个元素，节点之间双向链接
+     * 遍历时大部分访问落在同一个节点内，指针与分配器头部的开销由Capacity个元素分摊
+     * 在迭代器附近插入与删除只移动同一节点内的元素，节点满时分裂为两个半满的节点，
+     * 元素过少时与相邻的节点合并，因此代价与Capacity相关而与元素个数无关
+     * 插入与删除使同一节点（分裂、合并时还有相邻节点）中元素的迭代器失效
+     * */
+    template <typename T, size_t Capacity = unrolled_list_capacity<T>(), typename Alloc = alloc>
+    class unrolled_list : protected simple_alloc<unrolled_list_node<T, Capacity>, Alloc>
+    {
+        static_assert(Capacity >= 2, "unrolled_list needs at least 2 elements per node");
+
+    public:
+        /* Member types */
+        using value_type = T;
+        using allocator_type = Alloc;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using pointer = value_type *;
+        using const_pointer = const value_type *;
+
+        using iterator = unrolled_list_iterator<T, Capacity, T &, T *>;
+        using const_iterator = unrolled_list_iterator<T, Capacity, const T &, const T *>;
+        using reverse_iterator = stl::reverse_iterator<iterator>;
+        using const_reverse_iterator = stl::reverse_iterator<const_iterator>;
+
+    protected:
+        using Node = unrolled_list_node<T, Capacity>;
+        using node_base = unrolled_list_node_base;
+        using node_allocator = simple_alloc<Node, Alloc>;
+
+        node_base header{&header, &header, 0};
+        size_type num_of_elems{};
+        size_type num_of_nodes{};
+
+        static Node *as_node(node_base *p)
+        {
+            return static_cast<Node *>(p);
+        }
+
+        // 在pos之前链接一个空节点
+        Node *create_node(node_base *pos)
+        {
+            Node *node = node_allocator::allocate();
+            node->count = 0;
+            node->prev = pos->prev;
+            node->next = pos;
+            pos->prev->next = node;
+            pos->prev = node;
+            ++num_of_nodes;
+            return node;
+        }
+
+        // 节点中的元素已经析构
+        void destroy_node(node_base *node)
+        {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+            --num_of_nodes;
+            node_allocator::deallocate(as_node(node));
+        }
+
+        // 把node中[from, count)的元素搬到dst的末尾
+        static void move_elems(Node *node, size_t from, Node *dst)
+        {
+            T *first = node->elems() + from;
+            T *last = node->elems() + node->count;
+            stl::uninitialized_move_if_noexcept(first, last, dst->elems() + dst->count);
+            stl::destroy(first, last);
+            dst->count += node->count - from;
+            node->count = from;
+        }
+
+        // 把elem放到节点node的下标index处，后面的元素依次后移，node未满
+        static void place(Node *node, size_t index, T &&elem)
+        {
+            T *elems = node->elems();
+            if (index == node->count)
+                stl::construct(elems + index, std::move(elem));
+            else
+            {
+                stl::construct(elems + node->count, std::move(elems[node->count - 1]));
+                std::move_backward(elems + index, elems + node->count - 1, elems + node->count);
+                elems[index] = std::move(elem);
+            }
+            ++node->count;
+        }
+
+        iterator insert_aux(const_iterator pos, T &&elem);
+
+        void move_from(unrolled_list &other) noexcept;
+
+    public:
+        /* Member functions */
+
+        /*
+         *  constructor
+         * */
+        unrolled_list() = default;
+
+        explicit unrolled_list(const Alloc &a) : node_allocator(a) {}
+
+        explicit unrolled_list(size_type count, const T &value = T(), const Alloc &a = Alloc()) : node_allocator(a)
+        {
+            while (count--)
+                push_back(value);
+        }
+
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        unrolled_list(InputIt first, InputIt last, const Alloc &a = Alloc()) : node_allocator(a)
+        {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        unrolled_list(std::initializer_list<T> init, const Alloc &a = Alloc())
+            : unrolled_list(init.begin(), init.end(), a) {}
+
+        unrolled_list(const unrolled_list &other) : unrolled_list(other.begin(), other.end(), other.get_allocator()) {}
+
+        unrolled_list(unrolled_list &&other) noexcept : node_allocator(other.get_allocator())
+        {
+            move_from(other);
+        }
+
+        /*
+         *  destructor
+         * */
+        ~unrolled_list()
+        {
+            clear();
+        }
+
+        /*
+         * assignment operation
+         * */
+        unrolled_list &operator=(const unrolled_list &other)
+        {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        unrolled_list &operator=(unrolled_list &&other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                node_allocator::get_alloc() = other.get_alloc();
+                move_from(other);
+            }
+            return *this;
+        }
+
+        unrolled_list &operator=(std::initializer_list<T> ilist)
+        {
+            assign(ilist.begin(), ilist.end());
+            return *this;
+        }
+
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        allocator_type get_allocator() const noexcept
+        {
+            return node_allocator::get_alloc();
+        }
+
+        /*
+         * Element access
+         * */
+        reference front()
+        {
+            return *begin();
+        }
+
+        const_reference front() const
+        {
+            return *begin();
+        }
+
+        reference back()
+        {
+            return *--end();
+        }
+
+        const_reference back() const
+        {
+            return *--end();
+        }
+
+        /*
+         * Iterator
+         * */
+        iterator begin() noexcept
+        {
+            return iterator(header.next, 0);
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(header.next, 0);
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        iterator end() noexcept
+        {
+            return iterator(&header, 0);
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator(&header, 0);
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        /*
+         * Capacity
+         * */
+        bool empty() const noexcept
+        {
+            return num_of_elems == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return num_of_elems;
+        }
+
+        // 节点的个数，用于观察元素的密度
+        size_type node_count() const noexcept
+        {
+            return num_of_nodes;
+        }
+
+        static constexpr size_type node_capacity() noexcept
+        {
+            return Capacity;
+        }
+
+        /*
+         * Modifiers
+         * */
+        void clear() noexcept;
+
+        iterator insert(const_iterator pos, const value_type &value)
+        {
+            value_type cv = value;
+            return insert_aux(pos, std::move(cv));
+        }
+
+        iterator insert(const_iterator pos, value_type &&value)
+        {
+            return insert_aux(pos, std::move(value));
+        }
+
+        template <class... Args>
+        iterator emplace(const_iterator pos, Args &&...args)
+        {
+            value_type value(std::forward<Args>(args)...);
+            return insert_aux(pos, std::move(value));
+        }
+
+        iterator erase(const_iterator pos);
+
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(const value_type &value);
+
+        void push_back(value_type &&value);
+
+        template <class... Args>
+        reference emplace_back(Args &&...args);
+
+        void pop_back()
+        {
+            erase(--end());
+        }
+
+        void push_front(const value_type &value)
+        {
+            insert(begin(), value);
+        }
+
+        void push_front(value_type &&value)
+        {
+            insert(begin(), std::move(value));
+        }
+
+        void pop_front()
+        {
+            erase(begin());
+        }
+
+        void swap(unrolled_list &other) noexcept
+        {
+            unrolled_list temp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temp);
+        }
+    };
+
+    template <typename T, size_t Capacity, typename Alloc>
+    void unrolled_list<T, Capacity, Alloc>::move_from(unrolled_list &other) noexcept
+    {
+        // 头节点位于容器内部，首尾节点需要重新指向本容器的头节点
+        if (other.header.next != &other.header)
+        {
+            header.next = other.header.next;
+            header.prev = other.header.prev;
+            header.next->prev = header.prev->next = &header;
+        }
+        num_of_elems = other.num_of_elems;
+        num_of_nodes = other.num_of_nodes;
+
+        other.header.prev = other.header.next = &other.header;
+        other.num_of_elems = other.num_of_nodes = 0;
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    void unrolled_list<T, Capacity, Alloc>::clear() noexcept
+    {
+        // 节点中的元素析构后成批归还
+        node_batch<Node, Alloc> freed(*this, 0);
+        node_base *cur = header.next;
+
+        while (cur != &header)
+        {
+            node_base *next = cur->next;
+            stl::destroy(as_node(cur)->elems(), as_node(cur)->elems() + cur->count);
+            freed.put_back(as_node(cur));
+            cur = next;
+        }
+        header.prev = header.next = &header;
+        num_of_elems = num_of_nodes = 0;
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    void unrolled_list<T, Capacity, Alloc>::push_back(const value_type &value)
+    {
+        emplace_back(value);
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    void unrolled_list<T, Capacity, Alloc>::push_back(value_type &&value)
+    {
+        emplace_back(std::move(value));
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    template <class... Args>
+    typename unrolled_list<T, Capacity, Alloc>::reference
+    unrolled_list<T, Capacity, Alloc>::emplace_back(Args &&...args)
+    {
+        // 最后一个节点满了才分配新的节点，因此顺序追加的元素总是填满节点
+        Node *last = as_node(header.prev);
+        bool fresh = last == &header || last->full();
+        if (fresh)
+            last = create_node(&header);
+
+        try
+        {
+            stl::construct(last->elems() + last->count, std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            if (fresh)
+                destroy_node(last);
+            throw;
+        }
+        ++num_of_elems;
+        return last->elems()[last->count++];
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    typename unrolled_list<T, Capacity, Alloc>::iterator
+    unrolled_list<T, Capacity, Alloc>::insert_aux(const_iterator pos, T &&elem)
+    {
+        node_base *base = pos.node;
+        size_t index = pos.index;
+
+        // 插入到一个节点的开头（包括末尾）时，前一个节点有空位就放在它的末尾
+        if (index == 0 && base->prev != &header && !as_node(base->prev)->full())
+        {
+            base = base->prev;
+            index = base->count;
+        }
+        else if (base == &header)
+            base = create_node(&header);
+
+        Node *node = as_node(base);
+        if (node->full())
+        {
+            // 分裂：后一半元素搬到新的后继节点
+            Node *next = create_node(node->next);
+            move_elems(node, Capacity / 2, next);
+            if (index > node->count)
+            {
+                index -= node->count;
+                node = next;
+            }
+        }
+
+        place(node, index, std::move(elem));
+        ++num_of_elems;
+        return iterator(node, index);
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    typename unrolled_list<T, Capacity, Alloc>::iterator
+    unrolled_list<T, Capacity, Alloc>::erase(const_iterator pos)
+    {
+        Node *node = as_node(pos.node);
+        size_t index = pos.index;
+        T *elems = node->elems();
+
+        std::move(elems + index + 1, elems + node->count, elems + index);
+        stl::destroy(elems + node->count - 1);
+        --node->count;
+        --num_of_elems;
+
+        if (node->count == 0)
+        {
+            node_base *next = node->next;
+            destroy_node(node);
+            return iterator(next, 0);
+        }
+
+        // 元素不足一半时与相邻的节点合并，避免节点越来越稀疏
+        if (node->count < Capacity / 2)
+        {
+            node_base *prev = node->prev;
+            node_base *next = node->next;
+            if (prev != &header && prev->count + node->count <= Capacity)
+            {
+                index += prev->count;
+                move_elems(node, 0, as_node(prev));
+                destroy_node(node);
+                node = as_node(prev);
+            }
+            else if (next != &header && node->count + next->count <= Capacity)
+            {
+                move_elems(as_node(next), 0, node);
+                destroy_node(next);
+            }
+        }
+
+        if (index == node->count)
+            return iterator(node->next, 0);
+        return iterator(node, index);
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    typename unrolled_list<T, Capacity, Alloc>::iterator
+    unrolled_list<T, Capacity, Alloc>::erase(const_iterator first, const_iterator last)
+    {
+        // 合并可能使last失效，因此先数出要删除的元素个数
+        size_type count = stl::distance(first, last);
+        iterator cur(first.node, first.index);
+        while (count--)
+            cur = erase(cur);
+        return cur;
+    }
+
+    /* Non-member functions */
+    template <typename T, size_t Capacity, typename Alloc>
+    bool operator==(const unrolled_list<T, Capacity, Alloc> &lhs, const unrolled_list<T, Capacity, Alloc> &rhs)
+    {
+        return lhs.size() == rhs.size() && stl::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    bool operator!=(const unrolled_list<T, Capacity, Alloc> &lhs, const unrolled_list<T, Capacity, Alloc> &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename T, size_t Capacity, typename Alloc>
+    void swap(unrolled_list<T, Capacity, Alloc> &lhs, unrolled_list<T, Capacity, Alloc> &rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+} // namespace stl
+
+#endif //MINISTL_UNROLLED_LIST_HH
@@ -12,6 +12,8 @@
 #include <stdexcept>
 #include <cstring>
 #include <limits>
+#include <algorithm>
+#include <type_traits>
 
 #include "alloc.hh"
 #include "iterator.hh"
@@ -20,8 +22,44 @@
 
 namespace stl
 {
-    template <typename T, typename Alloc = alloc>
-    class vector
+    /*
+     * vector的扩容策略：元素个数为size的vector至少需要容纳needed个元素时，新的容量为next_capacity(size, needed)
+     * 返回值不小于needed
+     * */
+    // 每次扩容为原来的2倍，扩容次数最少
+    struct double_growth
+    {
+        static size_t next_capacity(size_t size, size_t needed)
+        {
+            return needed < 2 * size ? 2 * size : needed;
+        }
+    };
+
+    // 每次扩容为原来的1.5倍，之前释放的区块之和有机会被之后的扩容重新利用
+    struct half_growth
+    {
+        static size_t next_capacity(size_t size, size_t needed)
+        {
+            size_t grown = size + size / 2;
+            return needed < grown ? grown : needed;
+        }
+    };
+
+    // 每次增加固定的Step个元素，适合大小可以预估、不希望浪费空间的场景
+    template <size_t Step>
+    struct fixed_growth
+    {
+        static_assert(Step > 0, "Step must be positive");
+
+        static size_t next_capacity(size_t size, size_t needed)
+        {
+            size_t grown = size + Step;
+            return needed < grown ? grown : needed;
+        }
+    };
+
+    template <typename T, typename Alloc = alloc, typename GrowthPolicy = double_growth>
+    class vector : protected simple_alloc<T, Alloc>
     {
     public:
         /* Member types */
@@ -55,38 +93,169 @@ namespace stl
 
         void reallocate(size_type n);
 
+        void reallocate(size_type n, __true_type);
+
+        void reallocate(size_type n, __false_type);
+
+        // 把容量扩展为n后在末尾追加elem，元素可以按字节搬移时借助配置器的reallocate就地扩展，返回是否已经追加
+        bool append_expand(T &&elem, size_type n, __true_type)
+        {
+            T value(std::move(elem)); // elem可能是本vector中的元素
+            reallocate(n, __true_type());
+            stl::construct(finish, std::move(value));
+            ++finish;
+            return true;
+        }
+
+        bool append_expand(T &&, size_type, __false_type)
+        {
+            return false;
+        }
+
         iterator insert_aux(const_iterator pos, T &&elem);
 
+        // 在现有size()个元素之外至少再容纳count个元素时的新容量
+        size_type grow_capacity(size_type count) const
+        {
+            return GrowthPolicy::next_capacity(size(), size() + count);
+        }
+
+        // 前向迭代器可以预先求出元素个数，至多扩容一次
+        template <typename ForwardIt>
+        iterator range_insert(const_iterator pos, ForwardIt first, ForwardIt last, forward_iterator_tag)
+        {
+            iterator ipos = const_cast<iterator>(pos);
+            auto count = stl::distance(first, last);
+
+            if (count)
+            {
+                if (stl::distance(finish, end_of_storage) >= count)
+                {
+                    const auto elems_after = stl::distance(ipos, end());
+
+                    if (elems_after > count)
+                    {
+                        stl::uninitialized_copy(finish - count, finish, finish);
+                        stl::copy_backward(ipos, finish - count, finish);
+
+                        auto iter = ipos;
+                        while (first != last)
+                            *iter++ = *first++;
+
+                        finish += count;
+                    }
+                    else
+                    {
+                        iterator old_finish = finish;
+                        finish += count - elems_after;
+                        stl::uninitialized_copy(ipos, old_finish, finish);
+                        finish += elems_after;
+
+                        auto iter = ipos;
+                        while (iter != old_finish)
+                            *iter++ = *first++;
+
+                        while (first != last)
+                            stl::construct(&*iter++, *first++);
+                    }
+                }
+
+                else
+                {
+                    const size_type len = grow_capacity(count);
+
+                    // allocate new storage
+                    iterator new_start = data_allocator::allocate(len);
+
+                    // 先构造插入的元素，再把原有的元素移过去，见insert_aux
+                    iterator new_pos = new_start + (ipos - start);
+                    iterator constructed = new_pos;
+                    iterator new_finish = new_pos;
+
+                    try
+                    {
+                        while (first != last)
+                            stl::construct(&*new_finish++, *first++);
+                        stl::uninitialized_move_if_noexcept(start, ipos, new_start);
+                        constructed = new_start;
+                        new_finish = stl::uninitialized_move_if_noexcept(ipos, finish, new_finish);
+                    }
+                    catch (...)
+                    {
+                        stl::destroy(constructed, new_finish);
+                        data_allocator::deallocate(new_start, len);
+                        throw;
+                    }
+                    ipos = new_pos;
+                    // release old storage
+                    stl::destroy(begin(), end());
+                    deallocate();
+
+                    start = new_start;
+                    finish = new_finish;
+                    end_of_storage = new_start + len;
+                }
+            }
+
+            return ipos;
+        }
+
+        // 输入迭代器只能遍历一次，逐个追加到末尾之后再旋转到pos处
+        template <typename InputIt>
+        iterator range_insert(const_iterator pos, InputIt first, InputIt last, input_iterator_tag)
+        {
+            const size_type offset = pos - start;
+            const size_type old_size = size();
+            range_append(first, last, input_iterator_tag());
+            std::rotate(start + offset, start + old_size, finish);
+            return start + offset;
+        }
+
+        template <typename ForwardIt>
+        void range_append(ForwardIt first, ForwardIt last, forward_iterator_tag)
+        {
+            const size_type count = stl::distance(first, last);
+            if (size_type(end_of_storage - finish) < count)
+                reallocate(grow_capacity(count));
+            finish = stl::uninitialized_copy(first, last, finish);
+        }
+
+        template <typename InputIt>
+        void range_append(InputIt first, InputIt last, input_iterator_tag)
+        {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
     public:
         /*
          * constructor
          * */
         vector() = default;
 
+        explicit vector(const Alloc &a) : data_allocator(a) {}
+
         vector(const vector &other);
 
         vector(vector &&other) noexcept;
 
-        explicit vector(size_type n)
+        explicit vector(size_type n, const Alloc &a = Alloc()) : data_allocator(a)
         {
             fill_initialize(n, T());
         }
 
-        vector(size_type n, const T &elem)
+        vector(size_type n, const T &elem, const Alloc &a = Alloc()) : data_allocator(a)
         {
             fill_initialize(n, elem);
         }
 
         template <typename InputIterator, typename = std::_RequireInputIter<InputIterator>>
-        vector(InputIterator first, InputIterator last)
+        vector(InputIterator first, InputIterator last, const Alloc &a = Alloc()) : data_allocator(a)
         {
-            start = finish = data_allocator::allocate(stl::distance(first, last));
-            while (first != last)
-                construct(finish++, *first++);
-            end_of_storage = finish;
+            append_range(first, last);
         }
 
-        vector(std::initializer_list<T>);
+        vector(std::initializer_list<T>, const Alloc &a = Alloc());
 
         /*
          *  destructor
@@ -274,81 +443,24 @@ namespace stl
         template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
         iterator insert(const_iterator pos, InputIt first, InputIt last)
         {
-            iterator ipos = const_cast<iterator>(pos);
-            auto count = stl::distance(first, last);
-
-            if (count)
-            {
-                if (stl::distance(finish, end_of_storage) >= count)
-                {
-                    const size_type elems_after = stl::distance(ipos, end());
-
-                    if (elems_after > count)
-                    {
-                        stl::uninitialized_copy(finish - count, finish, finish);
-                        stl::copy_backward(ipos, finish - count, finish);
-
-                        auto iter = ipos;
-                        while (first != last)
-                            *iter++ = *first++;
-
-                        finish += count;
-                    }
-                    else
-                    {
-                        iterator old_finish = finish;
-                        finish += count - elems_after;
-                        stl::uninitialized_copy(ipos, old_finish, finish);
-                        finish += elems_after;
-
-                        auto iter = ipos;
-                        while (iter != old_finish)
-                            *iter++ = *first++;
-
-                        while (first != last)
-                            stl::construct(&*iter++, *first++);
-                    }
-                }
-
-                else
-                {
-                    const size_type old_size = size();
-                    const size_type len = old_size + stl::max(old_size, (size_type)count);
-
-                    // allocate new storage
-                    iterator new_start = data_allocator::allocate(len);
-                    iterator new_finish = new_start;
-
-                    try
-                    {
-                        /* code */
-                        new_finish = stl::uninitialized_copy(start, ipos, new_start);
-                        auto old_ipos = ipos; // save old ipos
-                        ipos = new_finish;    // update ipos
-                        while (first != last)
-                            stl::construct(&*new_finish++, *first++);
-                        new_finish = stl::uninitialized_copy(old_ipos, finish, new_finish);
-                    }
-                    catch (const std::exception &e)
-                    {
-                        stl::destroy(new_start, new_finish);
-                        data_allocator::deallocate(new_start, len);
-                        throw;
-                    }
-                    // release old storage
-                    stl::destroy(begin(), end());
-                    deallocate();
+            return insert_range(pos, first, last);
+        }
 
-                    start = new_start;
-                    finish = new_finish;
-                    end_of_storage = new_start + len;
-                }
-            }
+        iterator insert(const_iterator pos, std::initializer_list<T> ilist);
 
-            return ipos;
+        // 与insert(pos, first, last)相同，迭代器类别允许时先求出元素个数，只扩容一次
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        iterator insert_range(const_iterator pos, InputIt first, InputIt last)
+        {
+            return range_insert(pos, first, last, stl::iterator_category(first));
         }
 
-        iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+        // 在末尾追加[first, last)，迭代器类别允许时只扩容一次
+        template <typename InputIt, typename = std::_RequireInputIter<InputIt>>
+        void append_range(InputIt first, InputIt last)
+        {
+            range_append(first, last, stl::iterator_category(first));
+        }
 
         template <typename... Args>
         iterator emplace(const_iterator pos, Args &&...args);
@@ -368,29 +480,33 @@ namespace stl
         void resize(size_type size);
         void resize(size_type size, const value_type &elem);
 
+        // 把元素个数调整为n，新增的元素不初始化，只能用于可以平凡构造与析构的T
+        // 适合随后直接写入data()的场景，例如反序列化时不必先把缓冲区清零
+        void resize_uninitialized(size_type n);
+
         void swap(vector &other) noexcept;
     };
 
     /*
      * Protected function
      * */
-    template <typename T, typename Alloc>
-    auto vector<T, Alloc>::allocate_and_fill(size_type n, const T &value) -> iterator
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    auto vector<T, Alloc, GrowthPolicy>::allocate_and_fill(size_type n, const T &value) -> iterator
     {
         iterator result = data_allocator::allocate(n);
         uninitialized_fill_n(result, n, value);
         return result;
     }
 
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::deallocate()
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::deallocate()
     {
         if (start)
             data_allocator::deallocate(start, end_of_storage - start);
     }
 
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::fill_initialize(size_type n, const T &value)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::fill_initialize(size_type n, const T &value)
     {
         start = allocate_and_fill(n, value);
         finish = start;
@@ -398,8 +514,25 @@ namespace stl
         end_of_storage = finish;
     }
 
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::reallocate(size_type n)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::reallocate(size_type n)
+    {
+        reallocate(n, relocatable_type<T>());
+    }
+
+    // 交给配置器的reallocate，可能就地扩展，大的区块由realloc通过mremap重新映射页面而不必复制
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::reallocate(size_type n, __true_type)
+    {
+        const size_type old_size = size();
+
+        start = data_allocator::reallocate(start, capacity(), n);
+        finish = start + (old_size < n ? old_size : n);
+        end_of_storage = start + n;
+    }
+
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::reallocate(size_type n, __false_type)
     {
         T *new_start = nullptr;
         T *new_finish = nullptr;
@@ -407,11 +540,20 @@ namespace stl
         {
             new_start = data_allocator::allocate(n);
             new_finish = new_start;
-            new_finish = stl::uninitialized_copy(begin(), end(), new_finish);
+            try
+            {
+                new_finish = stl::uninitialized_relocate(start, finish, new_finish);
+            }
+            catch (...)
+            {
+                data_allocator::deallocate(new_start, n);
+                throw;
+            }
         }
+        else
+            stl::destroy(begin(), end());
 
-        // destroy and release old storage
-        stl::destroy(begin(), end());
+        // release old storage
         deallocate();
 
         start = new_start;
@@ -420,9 +562,9 @@ namespace stl
             end_of_storage = start + n;
     }
 
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::insert_aux(const_iterator pos, T &&elem)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::insert_aux(const_iterator pos, T &&elem)
     {
         iterator ipos = const_cast<iterator>(pos);
 
@@ -441,30 +583,34 @@ namespace stl
                 *ipos = std::forward<T>(elem);
             }
         }
+        else if (ipos == finish && append_expand(std::move(elem), grow_capacity(1), relocatable_type<T>()))
+            ipos = finish - 1;
         else
         {
-            const size_type old_size = size();
-            const size_type len = old_size ? 2 * old_size : 1;
+            const size_type len = grow_capacity(1);
             auto new_start = data_allocator::allocate(len);
-            auto new_finish = new_start;
+
+            // 先在新的位置构造elem（它可能是原有的元素），再把原有的元素移动过去
+            // 移动构造可能抛出异常时改为复制，因此失败时原有的元素保持不变
+            // [constructed, new_finish)为新空间中已经构造的部分
+            iterator new_pos = new_start + (ipos - start);
+            iterator constructed = new_pos;
+            iterator new_finish = new_pos;
             try
             {
-                if (start != nullptr)
-                    new_finish = stl::uninitialized_copy(begin(), ipos, new_finish);
-                // update ipos
-                auto old_ipos = ipos;
-                ipos = new_finish;
-
-                stl::construct(new_finish++, std::forward<T>(elem));
-                if (start != nullptr)
-                    new_finish = stl::uninitialized_copy(old_ipos, end(), new_finish);
+                stl::construct(new_pos, std::forward<T>(elem));
+                new_finish = new_pos + 1;
+                stl::uninitialized_move_if_noexcept(start, ipos, new_start);
+                constructed = new_start;
+                new_finish = stl::uninitialized_move_if_noexcept(ipos, finish, new_finish);
             }
-            catch (std::exception e)
+            catch (...)
             {
-                stl::destroy(new_start, new_finish);
+                stl::destroy(constructed, new_finish);
                 data_allocator::deallocate(new_start, len);
                 throw;
             }
+            ipos = new_pos;
 
             // release old storage
             stl::destroy(begin(), end());
@@ -481,8 +627,8 @@ namespace stl
     /*
      * Constructors
      * */
-    template <typename T, typename Alloc>
-    vector<T, Alloc>::vector(const vector &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    vector<T, Alloc, GrowthPolicy>::vector(const vector &rhs) : data_allocator(rhs.get_alloc())
     {
         size_type size = rhs.size();
         start = finish = data_allocator::allocate(size);
@@ -492,32 +638,35 @@ namespace stl
         end_of_storage = finish;
     }
 
-    template <typename T, typename Alloc>
-    vector<T, Alloc>::vector(vector &&rhs) noexcept : start(rhs.start), finish(rhs.finish), end_of_storage(rhs.end_of_storage)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    vector<T, Alloc, GrowthPolicy>::vector(vector &&rhs) noexcept
+        : data_allocator(rhs.get_alloc()), start(rhs.start), finish(rhs.finish), end_of_storage(rhs.end_of_storage)
     {
         rhs.start = rhs.finish = rhs.end_of_storage = nullptr;
     }
 
-    template <typename T, typename Alloc>
-    vector<T, Alloc>::vector(std::initializer_list<T> lst) : vector(lst.begin(), lst.end()) {}
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    vector<T, Alloc, GrowthPolicy>::vector(std::initializer_list<T> lst, const Alloc &a) : vector(lst.begin(), lst.end(), a) {}
 
     /*
      * Assignment operation
      * */
-    template <typename T, typename Alloc>
-    vector<T, Alloc> &vector<T, Alloc>::operator=(const vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    vector<T, Alloc, GrowthPolicy> &vector<T, Alloc, GrowthPolicy>::operator=(const vector<T, Alloc, GrowthPolicy> &rhs)
     {
         assign(rhs.begin(), rhs.end());
         return *this;
     }
 
-    template <typename T, typename Alloc>
-    vector<T, Alloc> &vector<T, Alloc>::operator=(vector<T, Alloc> &&rhs) noexcept
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    vector<T, Alloc, GrowthPolicy> &vector<T, Alloc, GrowthPolicy>::operator=(vector<T, Alloc, GrowthPolicy> &&rhs) noexcept
     {
         // release old storage
         stl::destroy(begin(), end());
         deallocate();
 
+        // 配置器随存储空间一起转移
+        data_allocator::get_alloc() = rhs.get_alloc();
         start = rhs.start;
         finish = rhs.finish;
         end_of_storage = rhs.end_of_storage;
@@ -527,21 +676,22 @@ namespace stl
         return *this;
     }
 
-    template <typename T, typename Alloc>
-    vector<T, Alloc> &vector<T, Alloc>::operator=(std::initializer_list<T> lst)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    vector<T, Alloc, GrowthPolicy> &vector<T, Alloc, GrowthPolicy>::operator=(std::initializer_list<T> lst)
     {
         assign(lst.begin(), lst.end());
 
         return *this;
     }
 
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::assign(size_type n, const T &elem)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::assign(size_type n, const T &elem)
     {
         destroy(begin(), end());
 
         if (capacity() < n)
         {
+            deallocate();
             start = data_allocator::allocate(n);
             end_of_storage = start + n;
         }
@@ -549,15 +699,16 @@ namespace stl
         finish = stl::uninitialized_fill_n(finish, n, elem);
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     template <typename InputIt>
-    void vector<T, Alloc>::assign(InputIt first, InputIt last)
+    void vector<T, Alloc, GrowthPolicy>::assign(InputIt first, InputIt last)
     {
         stl::destroy(begin(), end());
         size_type n = stl::distance(first, last);
 
         if (capacity() < n)
         {
+            deallocate();
             start = data_allocator::allocate(n);
             end_of_storage = start + n;
         }
@@ -565,8 +716,8 @@ namespace stl
         finish = stl::uninitialized_copy(first, last, finish);
     }
 
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::assign(std::initializer_list<T> lst)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::assign(std::initializer_list<T> lst)
     {
         assign(lst.begin(), lst.end());
     }
@@ -574,16 +725,16 @@ namespace stl
     /*
      * Capacity
      * */
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::reserve(size_type new_cap)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::reserve(size_type new_cap)
     {
         if (capacity() >= new_cap)
             return;
         reallocate(new_cap);
     }
 
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::shrink_to_fit()
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::shrink_to_fit()
     {
         if (finish != end_of_storage)
             reallocate(size());
@@ -592,37 +743,45 @@ namespace stl
     /*
      * Modifiers
      * */
-    template <typename T, typename Alloc>
-    void vector<T, Alloc>::clear() noexcept
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void vector<T, Alloc, GrowthPolicy>::clear() noexcept
     {
         erase(begin(), end());
     }
 
     // insert
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::insert(const_iterator pos, const T &elem)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::insert(const_iterator pos, const T &elem)
     {
         T elem_copy = elem;
         return insert_aux(pos, std::move(elem_copy));
     }
 
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::insert(const_iterator pos, T &&elem)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::insert(const_iterator pos, T &&elem)
     {
         return insert_aux(pos, std::move(elem));
     }
 
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::insert(const_iterator pos, size_type count, const T &elem)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::insert(const_iterator pos, size_type count, const T &elem)
     {
         iterator ipos = const_cast<iterator>(pos);
 
         if (count)
         {
-            if (finish && stl::distance(finish, end_of_storage) >= count)
+            // 在末尾插入时只需扩展容量，元素可以按字节搬移时可能就地扩展
+            if (ipos == finish && size_type(end_of_storage - finish) < count)
+            {
+                value_type value = elem; // elem可能是本vector中的元素
+                reallocate(grow_capacity(count));
+                ipos = finish;
+                finish = stl::uninitialized_fill_n(finish, count, value);
+            }
+            else if (finish && size_type(end_of_storage - finish) >= count)
             {
                 const size_type elems_after = stl::distance(ipos, end());
 
@@ -646,30 +805,30 @@ namespace stl
 
             else
             {
-                const size_type old_size = size();
-                const size_type len = old_size + max(old_size, count);
+                const size_type len = grow_capacity(count);
 
                 // allocate new storage
                 iterator new_start = data_allocator::allocate(len);
-                iterator new_finish = new_start;
+
+                // 先构造插入的元素，再把原有的元素移过去，见insert_aux
+                iterator new_pos = new_start + (ipos - start);
+                iterator constructed = new_pos;
+                iterator new_finish = new_pos;
 
                 try
                 {
-                    /* code */
-                    if (finish)
-                        new_finish = stl::uninitialized_copy(start, ipos, new_start);
-                    auto old_ipos = ipos;
-                    ipos = new_finish;
-                    new_finish = stl::uninitialized_fill_n(new_finish, count, elem);
-                    if (finish)
-                        new_finish = stl::uninitialized_copy(old_ipos, finish, new_finish);
+                    new_finish = stl::uninitialized_fill_n(new_pos, count, elem);
+                    stl::uninitialized_move_if_noexcept(start, ipos, new_start);
+                    constructed = new_start;
+                    new_finish = stl::uninitialized_move_if_noexcept(ipos, finish, new_finish);
                 }
-                catch (const std::exception &e)
+                catch (...)
                 {
-                    stl::destroy(new_start, new_finish);
+                    stl::destroy(constructed, new_finish);
                     data_allocator::deallocate(new_start, len);
                     throw;
                 }
+                ipos = new_pos;
                 // release old storage
                 stl::destroy(begin(), end());
                 deallocate();
@@ -683,25 +842,25 @@ namespace stl
         return ipos;
     }
 
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::insert(const_iterator pos, std::initializer_list<T> ilist)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::insert(const_iterator pos, std::initializer_list<T> ilist)
     {
         return insert(pos, ilist.begin(), ilist.end());
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     template <typename... Args>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::emplace(const_iterator pos, Args &&...args)
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::emplace(const_iterator pos, Args &&...args)
     {
         T elem(std::forward<Args>(args)...);
         return insert_aux(pos, std::move(elem));
     }
 
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::erase(const_iterator pos)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::erase(const_iterator pos)
     {
         iterator ipos = const_cast<iterator>(pos);
 
@@ -712,9 +871,9 @@ namespace stl
         return ipos;
     }
 
-    template <typename T, typename Alloc>
-    typename vector<T, Alloc>::iterator
-    vector<T, Alloc>::erase(const_iterator first, const_iterator last)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::iterator
+    vector<T, Alloc, GrowthPolicy>::erase(const_iterator first, const_iterator last)
     {
         iterator f = const_cast<iterator>(first);
         iterator l = const_cast<iterator>(last);
@@ -725,9 +884,9 @@ namespace stl
         return f;
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     void
-    vector<T, Alloc>::push_back(const T &elem)
+    vector<T, Alloc, GrowthPolicy>::push_back(const T &elem)
     {
         if (finish != end_of_storage)
         {
@@ -735,12 +894,15 @@ namespace stl
             ++finish;
         }
         else
-            (void)insert_aux(end(), elem);
+        {
+            T elem_copy = elem;
+            (void)insert_aux(end(), std::move(elem_copy));
+        }
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     void
-    vector<T, Alloc>::push_back(T &&elem)
+    vector<T, Alloc, GrowthPolicy>::push_back(T &&elem)
     {
         if (finish != end_of_storage)
         {
@@ -751,10 +913,10 @@ namespace stl
             (void)insert_aux(end(), std::move(elem));
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     template <typename... Args>
-    typename vector<T, Alloc>::reference
-    vector<T, Alloc>::emplace_back(Args &&...args)
+    typename vector<T, Alloc, GrowthPolicy>::reference
+    vector<T, Alloc, GrowthPolicy>::emplace_back(Args &&...args)
     {
         if (finish != end_of_storage)
         {
@@ -769,24 +931,24 @@ namespace stl
         return *end();
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     void
-    vector<T, Alloc>::pop_back()
+    vector<T, Alloc, GrowthPolicy>::pop_back()
     {
         --finish;
         stl::destroy(finish);
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     void
-    vector<T, Alloc>::resize(size_type size)
+    vector<T, Alloc, GrowthPolicy>::resize(size_type size)
     {
         resize(size, T());
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     void
-    vector<T, Alloc>::resize(size_type size, const value_type &elem)
+    vector<T, Alloc, GrowthPolicy>::resize(size_type size, const value_type &elem)
     {
         const size_type s = this->size();
 
@@ -795,24 +957,11 @@ namespace stl
             // whether or not need to allocate more storage space
             if (size > capacity())
             {
-                auto new_start = data_allocator::allocate(size);
-                auto new_finish = new_start;
-
-                try
-                {
-                    if (start)
-                        new_finish = stl::uninitialized_copy(start, finish, new_start);
-                }
-                catch (const std::exception &e)
-                {
-                    stl::destroy(new_start, new_finish);
-                    data_allocator::deallocate(new_start, size);
-
-                    throw;
-                }
-                start = new_start;
-                finish = new_finish;
-                end_of_storage = start + size;
+                value_type value = elem; // elem可能是本vector中的元素
+                reallocate(size);
+                stl::uninitialized_fill(finish, start + size, value);
+                finish = start + size;
+                return;
             }
 
             stl::uninitialized_fill(finish, start + size, elem);
@@ -826,61 +975,81 @@ namespace stl
         }
     }
 
-    template <typename T, typename Alloc>
+    template <typename T, typename Alloc, typename GrowthPolicy>
     void
-    vector<T, Alloc>::swap(vector &other) noexcept
+    vector<T, Alloc, GrowthPolicy>::resize_uninitialized(size_type n)
+    {
+        static_assert(std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value,
+                      "resize_uninitialized requires a trivial type");
+
+        if (n > capacity())
+            reallocate(grow_capacity(n - size()));
+        finish = start + n;
+    }
+
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void
+    vector<T, Alloc, GrowthPolicy>::swap(vector &other) noexcept
     {
         stl::swap(start, other.start);
         stl::swap(finish, other.finish);
         stl::swap(end_of_storage, other.end_of_storage);
+        stl::swap(data_allocator::get_alloc(), other.get_alloc());
+    }
+
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    typename vector<T, Alloc, GrowthPolicy>::allocator_type
+    vector<T, Alloc, GrowthPolicy>::get_allocator() const noexcept
+    {
+        return data_allocator::get_alloc();
     }
 
     /* Non-member functions */
-    template <typename T, typename Alloc>
-    bool operator==(const stl::vector<T, Alloc> &lhs,
-                    const stl::vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    bool operator==(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+                    const stl::vector<T, Alloc, GrowthPolicy> &rhs)
     {
         return (lhs.size() == rhs.size() && stl::equal(lhs.begin(), lhs.end(), rhs.begin()));
     }
 
-    template <typename T, typename Alloc>
-    bool operator!=(const stl::vector<T, Alloc> &lhs,
-                    const stl::vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    bool operator!=(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+                    const stl::vector<T, Alloc, GrowthPolicy> &rhs)
     {
         return !(lhs == rhs);
     }
 
-    template <typename T, typename Alloc>
-    bool operator<(const stl::vector<T, Alloc> &lhs,
-                   const stl::vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    bool operator<(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+                   const stl::vector<T, Alloc, GrowthPolicy> &rhs)
     {
         return stl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
     }
 
-    template <typename T, typename Alloc>
-    bool operator<=(const stl::vector<T, Alloc> &lhs,
-                    const stl::vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    bool operator<=(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+                    const stl::vector<T, Alloc, GrowthPolicy> &rhs)
     {
         return !(lhs > rhs);
     }
 
-    template <typename T, typename Alloc>
-    bool operator>(const stl::vector<T, Alloc> &lhs,
-                   const stl::vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    bool operator>(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+                   const stl::vector<T, Alloc, GrowthPolicy> &rhs)
     {
         return rhs < lhs;
     }
 
-    template <typename T, typename Alloc>
-    bool operator>=(const stl::vector<T, Alloc> &lhs,
-                    const stl::vector<T, Alloc> &rhs)
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    bool operator>=(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+                    const stl::vector<T, Alloc, GrowthPolicy> &rhs)
     {
         return !(lhs < rhs);
     }
 
-    template <typename T, typename Alloc>
-    void swap(const stl::vector<T, Alloc> &lhs,
-              const stl::vector<T, Alloc> &rhs) noexcept(noexcept(lhs.swap(rhs)))
+    template <typename T, typename Alloc, typename GrowthPolicy>
+    void swap(const stl::vector<T, Alloc, GrowthPolicy> &lhs,
+              const stl::vector<T, Alloc, GrowthPolicy> &rhs) noexcept(noexcept(lhs.swap(rhs)))
     {
         lhs.swap(rhs);
     }
@@ -8,6 +8,7 @@
 #include <vector>
 #include <deque>
 #include <algorithm>
+#include <string>
 
 #include "list.hh"
 #include "vector.hh"
@@ -46,11 +47,58 @@ void test_search()
     }
 }
 
+void test_copy_fill()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    // 重叠区间：copy向前搬移，copy_backward向后搬移
+    int a[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int *end = stl::copy(a + 2, a + 10, a);
+    assert(end == a + 8 && a[0] == 2 && a[7] == 9);
+    int b[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int *begin = stl::copy_backward(b, b + 8, b + 10);
+    assert(begin == b + 2 && b[2] == 0 && b[9] == 7 && b[1] == 1);
+    const int *cb = b;
+    assert(stl::copy_n(cb, 3, a) == a + 3 && a[1] == 1 && a[2] == 0);
+
+    // 每个字节都相同的值按字节填充，其他值逐个赋值
+    int c[100];
+    stl::fill(c, c + 100, 0);
+    assert(std::count(c, c + 100, 0) == 100);
+    stl::fill(c, c + 100, -1);
+    assert(std::count(c, c + 100, -1) == 100);
+    assert(stl::fill_n(c, 50, 0x01020304) == c + 50);
+    assert(std::count(c, c + 100, 0x01020304) == 50 && c[50] == -1);
+    char s[8];
+    stl::fill_n(s, 8, 'x');
+    assert(std::string(s, 8) == "xxxxxxxx");
+
+    // 非平凡的类型逐个赋值
+    std::string src[3] = {"a", "bb", "ccc"}, dst[4];
+    assert(stl::copy(src, src + 3, dst + 1) == dst + 4);
+    assert(dst[0].empty() && dst[3] == "ccc");
+    assert(stl::copy_backward(dst + 1, dst + 3, dst + 4) == dst + 2);
+    assert(dst[2] == "a" && dst[3] == "bb");
+    stl::fill(dst, dst + 4, std::string("z"));
+    assert(dst[0] == "z" && dst[3] == "z");
+
+    // 迭代器区间
+    stl::vector<int> v(5, 1);
+    std::list<int> l(5, 2);
+    stl::copy(l.begin(), l.end(), v.begin());
+    assert(v[4] == 2);
+    stl::fill_n(v.begin(), 3, 7);
+    assert(v[2] == 7 && v[3] == 2);
+}
+
 int main()
 {
     test_search<stl::vector<int>, std::vector<int>>();
     test_search<stl::list<int>, std::list<int>>();
     test_search<stl::deque<int>, std::deque<int>>();
+    test_copy_fill();
+
+    std::cout << "Pass!\n";
 
     return 0;
 }
\ No newline at end of file
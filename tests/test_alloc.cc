@@ -0,0 +1,461 @@
+//
+// Created by rda on 2024/3/2.
+//
+
+/*
+ * 测试stl::Default_alloc
+ * 1. 单线程下的分配与回收
+ * 2. 多线程并发分配与回收，以及跨线程回收
+ * 3. 多线程同时从中心池切分新的chunk
+ * 4. 多线程下各自使用容器
+ * 5. trim归还空闲的chunk，包括与分配并发执行以及后台定期执行
+ * 6. 统计信息
+ * 7. 按指定对齐分配，以及容器按alignof(T)与Aligned_alloc对齐
+ * 8. 成批分配与回收，以及节点容器的区间插入
+ * */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "alloc.hh"
+#include "deque.hh"
+#include "hashtable.hh"
+#include "list.hh"
+#include "set.hh"
+#include "vector.hh"
+
+void test_single_thread()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::vector<std::pair<char *, size_t>> blocks;
+
+    // 每个size class都分配多于一批的区块，并写满各自的标记
+    for (size_t n = 1; n <= 256; ++n)
+    {
+        for (int i = 0; i < 3 * stl::BATCH_SIZE; ++i)
+        {
+            char *p = static_cast<char *>(stl::alloc::allocate(n));
+            memset(p, static_cast<int>(n & 0xff), n);
+            blocks.push_back({p, n});
+        }
+    }
+
+    // 较大的size class，以及超过MAX_BYTES交给第一级配置器的区块
+    for (size_t n = 257; n <= stl::MAX_BYTES + 1024; n += 97)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            char *p = static_cast<char *>(stl::alloc::allocate(n));
+            memset(p, static_cast<int>(n & 0xff), n);
+            blocks.push_back({p, n});
+        }
+    }
+
+    for (auto &b : blocks)
+        for (size_t i = 0; i < b.second; ++i)
+            assert(b.first[i] == static_cast<char>(b.second & 0xff));
+
+    for (auto &b : blocks)
+        stl::alloc::deallocate(b.first, b.second);
+
+    // 回收后的区块可以被再次分配
+    void *p = stl::alloc::allocate(24);
+    void *q = stl::alloc::allocate(24);
+    assert(p != q);
+    stl::alloc::deallocate(p, 24);
+    stl::alloc::deallocate(q, 24);
+
+    // reallocate保留原有内容
+    char *r = static_cast<char *>(stl::alloc::allocate(16));
+    memcpy(r, "0123456789abcde", 16);
+    r = static_cast<char *>(stl::alloc::reallocate(r, 16, 200));
+    assert(!strcmp(r, "0123456789abcde"));
+    r = static_cast<char *>(stl::alloc::reallocate(r, 200, 8));
+    assert(!strncmp(r, "01234567", 8));
+    stl::alloc::deallocate(r, 8);
+}
+
+void alloc_worker(int id, int rounds)
+{
+    std::vector<std::pair<long *, size_t>> blocks;
+
+    for (int r = 0; r < rounds; ++r)
+    {
+        // 小区块逐个size class地分配，较大的区块按几何级数跳跃
+        for (size_t n = sizeof(long); n <= stl::MAX_BYTES;
+             n += n < stl::SMALL_BYTES ? sizeof(long) : n / 2 / sizeof(long) * sizeof(long))
+        {
+            long *p = static_cast<long *>(stl::alloc::allocate(n));
+            for (size_t i = 0; i < n / sizeof(long); ++i)
+                p[i] = id;
+            blocks.push_back({p, n});
+        }
+
+        // 回收一半，留下一半到下一轮，使线程缓存反复地向中心池取回和归还
+        while (blocks.size() > 64)
+        {
+            auto b = blocks.back();
+            blocks.pop_back();
+            for (size_t i = 0; i < b.second / sizeof(long); ++i)
+                assert(b.first[i] == id);
+            stl::alloc::deallocate(b.first, b.second);
+        }
+    }
+
+    for (auto &b : blocks)
+        stl::alloc::deallocate(b.first, b.second);
+}
+
+void test_multi_thread()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int nthreads = 8;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < nthreads; ++i)
+        threads.emplace_back(alloc_worker, i, 2000);
+    for (auto &t : threads)
+        t.join();
+}
+
+void test_cross_thread_free()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int count = 10000;
+    std::vector<void *> blocks(count);
+
+    // 一个线程分配，另一个线程回收
+    std::thread producer([&]()
+                         {
+        for (int i = 0; i < count; ++i)
+            blocks[i] = stl::alloc::allocate(32); });
+    producer.join();
+
+    std::thread consumer([&]()
+                         {
+        for (int i = 0; i < count; ++i)
+            stl::alloc::deallocate(blocks[i], 32); });
+    consumer.join();
+
+    // 区块已经回到中心池，本线程可以取得它们
+    for (int i = 0; i < count; ++i)
+        blocks[i] = stl::alloc::allocate(32);
+    for (int i = 0; i < count; ++i)
+        stl::alloc::deallocate(blocks[i], 32);
+}
+
+void test_concurrent_refill()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int nthreads = 8;
+    const int count = 20000;
+    std::vector<std::vector<void *>> blocks(nthreads);
+    std::vector<std::thread> threads;
+
+    // 所有线程同时只分配不回收，反复地耗尽chunk并竞争换上新的chunk
+    for (int t = 0; t < nthreads; ++t)
+        threads.emplace_back([&blocks, t]()
+                             {
+            for (int i = 0; i < count; ++i)
+                blocks[t].push_back(stl::alloc::allocate(8 * (1 + i % 16))); });
+    for (auto &t : threads)
+        t.join();
+
+    // 任意两个区块都不相同
+    std::vector<void *> all;
+    for (auto &v : blocks)
+        all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+
+    for (auto &v : blocks)
+        for (int i = 0; i < count; ++i)
+            stl::alloc::deallocate(v[i], 8 * (1 + i % 16));
+}
+
+void test_containers()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([t]()
+                             {
+            for (int r = 0; r < 50; ++r)
+            {
+                stl::list<int> li;
+                stl::vector<int> vi;
+                for (int i = 0; i < 1000; ++i)
+                {
+                    li.push_back(i + t);
+                    vi.push_back(i + t);
+                }
+                int i = 0;
+                for (auto &x : li)
+                    assert(x == vi[i++]);
+            } });
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
+void test_trim()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int count = 200000;
+    std::vector<long *> blocks(count);
+
+    // 在另一个线程中分配并回收大量区块，线程退出后它们全部回到中心池
+    std::thread worker([&blocks]()
+                       {
+        for (int i = 0; i < count; ++i)
+        {
+            blocks[i] = static_cast<long *>(stl::alloc::allocate(64));
+            blocks[i][0] = i;
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            assert(blocks[i][0] == i);
+            stl::alloc::deallocate(blocks[i], 64);
+        } });
+    worker.join();
+
+    assert(stl::alloc::trim() > 0);
+    // 没有新的空闲chunk
+    assert(stl::alloc::trim() == 0);
+
+    // 被归还的chunk可以再次使用
+    for (int i = 0; i < count; ++i)
+    {
+        blocks[i] = static_cast<long *>(stl::alloc::allocate(64));
+        for (int j = 0; j < 8; ++j)
+            blocks[i][j] = i;
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+            assert(blocks[i][j] == i);
+        stl::alloc::deallocate(blocks[i], 64);
+    }
+}
+
+void test_concurrent_trim()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+
+    // trim与分配、回收并发执行
+    std::thread trimmer([&done]()
+                        {
+        while (!done.load())
+            stl::alloc::trim(); });
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back(alloc_worker, i, 300);
+    for (auto &t : threads)
+        t.join();
+    done.store(true);
+    trimmer.join();
+}
+
+void test_background_trim()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::alloc::start_background_trim(std::chrono::milliseconds(1));
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back(alloc_worker, i, 300);
+    for (auto &t : threads)
+        t.join();
+    stl::alloc::stop_background_trim();
+}
+
+void test_stats()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int count = 1000;
+    size_t index = 0;
+    std::vector<void *> blocks(count);
+
+    stl::alloc_stats before = stl::alloc::stats();
+    while (before.classes[index].size != 48)
+        ++index;
+
+    // 在另一个线程中分配，线程退出后计数仍然保留
+    std::thread worker([&blocks]()
+                       {
+        for (int i = 0; i < count; ++i)
+            blocks[i] = stl::alloc::allocate(48);
+        void *p = stl::alloc::allocate(stl::MAX_BYTES + 1);
+        stl::alloc::deallocate(p, stl::MAX_BYTES + 1); });
+    worker.join();
+
+    stl::alloc_stats mid = stl::alloc::stats();
+    assert(mid.classes[index].allocs - before.classes[index].allocs == count);
+    assert(mid.classes[index].frees == before.classes[index].frees);
+    assert(mid.classes[index].refills > before.classes[index].refills);
+    assert(mid.in_use_bytes() - before.in_use_bytes() == count * 48);
+    assert(mid.large_allocs - before.large_allocs == 1);
+    assert(mid.large_bytes_allocated - before.large_bytes_allocated == stl::MAX_BYTES + 1);
+    assert(mid.large_bytes_freed - before.large_bytes_freed == stl::MAX_BYTES + 1);
+    assert(mid.heap_size <= mid.peak_heap_size);
+    assert(mid.chunks > 0);
+
+    // 在本线程中回收
+    for (int i = 0; i < count; ++i)
+        stl::alloc::deallocate(blocks[i], 48);
+
+    stl::alloc_stats after = stl::alloc::stats();
+    assert(after.classes[index].frees - before.classes[index].frees == count);
+    assert(after.in_use_bytes() == before.in_use_bytes());
+    assert(after.cached_bytes() - mid.cached_bytes() == count * 48);
+
+    stl::alloc::trim();
+    assert(stl::alloc::stats().trimmed_bytes >= before.trimmed_bytes);
+}
+
+struct alignas(64) cache_line
+{
+    long value;
+};
+
+template<typename T>
+bool is_aligned(const T *p, size_t align)
+{
+    return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+void test_aligned()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::vector<std::pair<void *, size_t>> blocks;
+
+    // 两级配置器都能满足从ALIGN到页大小的对齐
+    for (size_t align = 1; align <= 4096; align *= 2)
+    {
+        for (size_t n : {size_t(1), size_t(24), size_t(300), size_t(stl::MAX_BYTES + 1)})
+        {
+            char *p = static_cast<char *>(stl::alloc::allocate(n, align));
+            char *q = static_cast<char *>(stl::Malloc_alloc::allocate(n, align));
+            assert(is_aligned(p, align < stl::ALIGN ? stl::ALIGN : align) && is_aligned(q, align));
+            memset(p, 0xab, n);
+            memset(q, 0xcd, n);
+            stl::alloc::deallocate(p, n, align);
+            stl::Malloc_alloc::deallocate(q, n, align);
+        }
+    }
+
+    // 元素类型要求的对齐
+    stl::vector<cache_line> vc;
+    stl::list<cache_line> lc;
+    stl::deque<cache_line> dc;
+    for (long i = 0; i < 100; ++i)
+    {
+        vc.push_back({i});
+        lc.push_back({i});
+        dc.push_back({i});
+        assert(is_aligned(vc.data(), 64));
+        assert(is_aligned(&lc.back(), 64));
+        assert(is_aligned(&dc.back(), 64));
+    }
+
+    // 额外指定的对齐
+    stl::vector<float, stl::Aligned_alloc<32>> vf;
+    for (int i = 0; i < 1000; ++i)
+    {
+        vf.push_back(float(i));
+        assert(is_aligned(vf.data(), 32));
+    }
+    stl::vector<cache_line, stl::Aligned_alloc<16>> vc16(10);
+    assert(is_aligned(vc16.data(), 64));
+    static_assert(sizeof(stl::vector<float, stl::Aligned_alloc<32>>) == sizeof(stl::vector<float>),
+                  "Aligned_alloc is stateless");
+}
+
+void test_batch()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    // 数量跨越线程缓存与中心池的若干批
+    for (size_t n : {size_t(8), size_t(40), size_t(1000), size_t(stl::MAX_BYTES + 1)})
+    {
+        for (size_t count : {size_t(1), size_t(7), size_t(3 * stl::BATCH_SIZE + 5)})
+        {
+            std::vector<char *> blocks;
+            for (void *p = stl::alloc::allocate_batch(n, count); p; p = *static_cast<void **>(p))
+                blocks.push_back(static_cast<char *>(p));
+            assert(blocks.size() == count);
+
+            std::vector<char *> sorted(blocks);
+            std::sort(sorted.begin(), sorted.end());
+            assert(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+
+            // 写满之后重新串起来归还
+            for (size_t i = 0; i < count; ++i)
+                memset(blocks[i], 0x5a, n);
+            for (size_t i = 0; i < count; ++i)
+                *reinterpret_cast<char **>(blocks[i]) = i + 1 < count ? blocks[i + 1] : nullptr;
+            stl::alloc::deallocate_batch(blocks[0], n, count);
+        }
+    }
+
+    // 节点容器的区间插入、复制与clear，所有节点最终都被归还
+    std::vector<int> src;
+    for (int i = 0; i < 10000; ++i)
+        src.push_back(i % 5000);
+
+    stl::alloc_stats before = stl::alloc::stats();
+    {
+        stl::list<int> li(src.begin(), src.end());
+        stl::multiset<int> ms(src.begin(), src.end());
+        stl::set<int> si(src.begin(), src.end());
+        stl::Hashtable<int, int, std::hash<int>, std::_Identity<int>> ht(0, std::hash<int>(), std::equal_to<int>());
+        ht.insert_unique(src.begin(), src.end());
+        ht.insert_equal(src.begin(), src.begin() + 100);
+
+        assert(li.size() == 10000 && ms.size() == 10000 && si.size() == 5000);
+        assert(ht.size() == 5100);
+        assert(*si.begin() == 0 && *--si.end() == 4999);
+
+        stl::list<int> lc(li);
+        assert(lc.size() == 10000 && lc.front() == 0 && lc.back() == 4999);
+        lc.insert(lc.begin(), 3, -1);
+        assert(lc.size() == 10003 && lc.front() == -1);
+        lc.clear();
+        assert(lc.empty());
+        lc.push_back(1);
+        assert(lc.size() == 1);
+
+        auto copy = ht;
+        assert(copy.size() == ht.size());
+    }
+    stl::alloc_stats after = stl::alloc::stats();
+    assert(after.in_use_bytes() == before.in_use_bytes());
+}
+
+int main()
+{
+    test_single_thread();
+    test_multi_thread();
+    test_cross_thread_free();
+    test_concurrent_refill();
+    test_containers();
+    test_trim();
+    test_concurrent_trim();
+    test_background_trim();
+    test_stats();
+    test_aligned();
+    test_batch();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
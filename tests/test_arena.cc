@@ -0,0 +1,156 @@
+//
+// Created by rda on 2024/3/9.
+//
+
+/*
+ * 测试stl::arena与stl::Arena_alloc
+ * 1. arena的分配、对齐、增长、reallocate以及reset
+ * 2. 容器使用Arena_alloc时不经过Default_alloc
+ * 3. arena_scope的嵌套
+ * */
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "arena.hh"
+#include "deque.hh"
+#include "list.hh"
+#include "set.hh"
+#include "vector.hh"
+
+void test_arena()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::arena a(256);
+
+    // 分配的区块互不重叠，且满足对齐要求
+    char *prev = nullptr;
+    for (size_t n = 1; n <= 1000; ++n)
+    {
+        char *p = static_cast<char *>(a.allocate(n));
+        assert(reinterpret_cast<uintptr_t>(p) % stl::ALIGN == 0);
+        memset(p, static_cast<int>(n & 0xff), n);
+        if (prev)
+            assert(prev[0] == static_cast<char>((n - 1) & 0xff));
+        prev = p;
+    }
+    void *p = a.allocate(3, 64);
+    assert(reinterpret_cast<uintptr_t>(p) % 64 == 0);
+    assert(a.used() == 1000 * 1001 / 2 + 3);
+    assert(a.capacity() >= a.used());
+
+    // 最近一次分配的区块可以就地扩展
+    char *q = static_cast<char *>(a.allocate(16));
+    memcpy(q, "0123456789abcde", 16);
+    char *r = static_cast<char *>(a.reallocate(q, 16, 32));
+    assert(r == q && !strcmp(r, "0123456789abcde"));
+    a.allocate(8);
+    r = static_cast<char *>(a.reallocate(q, 32, 64));
+    assert(r != q && !strcmp(r, "0123456789abcde"));
+
+    // reset之后只保留最大的内存块
+    size_t capacity = a.capacity();
+    a.reset();
+    assert(a.used() == 0);
+    assert(a.capacity() > 0 && a.capacity() < capacity);
+    capacity = a.capacity();
+    a.allocate(64);
+    assert(a.capacity() == capacity);
+
+    a.release();
+    assert(a.capacity() == 0);
+
+    // 内存块的末尾没有对齐，对齐之后越过末尾时要分配新的内存块
+    stl::arena b(64);
+    b.allocate(61);
+    b.allocate(4);
+    char *c = static_cast<char *>(b.allocate(1));
+    *c = 1;
+    assert(reinterpret_cast<uintptr_t>(c) % stl::ALIGN == 0);
+}
+
+void test_containers()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::arena a;
+    stl::alloc_stats before = stl::alloc::stats();
+
+    {
+        stl::arena_scope scope(a);
+        stl::vector<int, stl::Arena_alloc> vi;
+        stl::list<int, stl::Arena_alloc> li;
+        stl::deque<int, stl::Arena_alloc> di;
+        stl::set<int, std::less<int>, stl::Arena_alloc> si;
+
+        for (int i = 0; i < 10000; ++i)
+        {
+            vi.push_back(i);
+            li.push_front(i);
+            di.push_back(i);
+            si.insert(i % 100);
+        }
+        for (int i = 0; i < 10000; ++i)
+            assert(vi[i] == di[i]);
+        assert(li.front() == 9999 && li.back() == 0);
+        assert(si.size() == 100);
+    }
+
+    // 容器的分配与回收都没有经过Default_alloc
+    stl::alloc_stats after = stl::alloc::stats();
+    for (size_t i = 0; i < stl::NFREELISTS; ++i)
+    {
+        assert(after.classes[i].allocs == before.classes[i].allocs);
+        assert(after.classes[i].frees == before.classes[i].frees);
+    }
+    assert(a.used() > 10000 * sizeof(int));
+
+    // 容器全部销毁之后一次性释放
+    a.reset();
+    assert(a.used() == 0);
+}
+
+void test_scope()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::arena outer, inner;
+
+    assert(!stl::Arena_alloc::get_arena());
+    {
+        stl::arena_scope s1(outer);
+        assert(stl::Arena_alloc::get_arena() == &outer);
+        stl::Arena_alloc::allocate(100);
+        {
+            stl::arena_scope s2(inner);
+            assert(stl::Arena_alloc::get_arena() == &inner);
+            stl::Arena_alloc::allocate(200);
+        }
+        assert(stl::Arena_alloc::get_arena() == &outer);
+    }
+    assert(!stl::Arena_alloc::get_arena());
+    assert(outer.used() == 100 && inner.used() == 200);
+
+    // 作用域之外无处分配
+    bool thrown = false;
+    try
+    {
+        stl::Arena_alloc::allocate(8);
+    }
+    catch (std::bad_alloc &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+int main()
+{
+    test_arena();
+    test_containers();
+    test_scope();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
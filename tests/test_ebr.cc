@@ -0,0 +1,197 @@
+//
+// Created by rda on 2024/5/18.
+//
+
+/*
+ * 测试stl::epoch_domain与stl::epoch_limbo
+ * 1. 没有活跃线程时epoch可以前进，epoch_guard可以嵌套
+ * 2. 停留在旧epoch的线程阻止epoch前进
+ * 3. 节点在全局epoch前进两次之后才被释放
+ * 4. epoch_ptr替换值之后，旧值在读者离开之前保持有效
+ * */
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+#include "ebr.hh"
+
+struct node : stl::epoch_node
+{
+    static inline int alive = 0;
+    int v;
+
+    explicit node(int x) : v(x)
+    {
+        ++alive;
+    }
+
+    ~node()
+    {
+        --alive;
+    }
+};
+
+using node_alloc = stl::simple_alloc<node, stl::alloc>;
+
+node *make_node(node_alloc &a, int v)
+{
+    node *n = a.allocate();
+    stl::construct(n, v);
+    return n;
+}
+
+void test_advance()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    uint64_t e = stl::epoch_domain::current();
+    assert(stl::epoch_domain::try_advance() == e + 1);
+
+    // 自己处于当前epoch时不阻止前进
+    {
+        stl::epoch_guard outer;
+        stl::epoch_guard inner;
+        assert(stl::epoch_domain::try_advance() == e + 2);
+        // 自己仍停留在e + 1
+        assert(stl::epoch_domain::try_advance() == e + 2);
+    }
+    assert(stl::epoch_domain::try_advance() == e + 3);
+
+    // 另一个线程停留在旧epoch时无法前进
+    std::atomic<int> stage{0};
+    std::thread reader([&] {
+        stl::epoch_guard guard;
+        stage = 1;
+        while (stage != 2)
+            std::this_thread::yield();
+    });
+    while (stage != 1)
+        std::this_thread::yield();
+    uint64_t now = stl::epoch_domain::try_advance();
+    assert(stl::epoch_domain::try_advance() == now);
+    stage = 2;
+    reader.join();
+    assert(stl::epoch_domain::try_advance() == now + 1);
+}
+
+void test_limbo()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    node_alloc a;
+    {
+        stl::epoch_limbo<node, stl::alloc> limbo;
+        limbo.retire(make_node(a, 1), a);
+        limbo.retire(make_node(a, 2), a);
+        assert(node::alive == 2);
+
+        // 第一次只能前进一步，节点仍然可能被看到
+        limbo.collect(a);
+        assert(node::alive == 2);
+        limbo.collect(a);
+        assert(node::alive == 0);
+
+        // 达到阈值时自动回收
+        for (size_t i = 0; i < 3 * decltype(limbo)::THRESHOLD; ++i)
+            limbo.retire(make_node(a, int(i)), a);
+        assert(node::alive < int(3 * decltype(limbo)::THRESHOLD));
+
+        limbo.retire(make_node(a, 0), a);
+        limbo.drain(a);
+        assert(node::alive == 0);
+    }
+
+    // 读者持有的节点在读者离开之前不会被释放
+    stl::epoch_limbo<node, stl::alloc> limbo;
+    std::atomic<int> stage{0};
+    std::thread reader([&] {
+        stl::epoch_guard guard;
+        stage = 1;
+        while (stage != 2)
+            std::this_thread::yield();
+    });
+    while (stage != 1)
+        std::this_thread::yield();
+    limbo.retire(make_node(a, 7), a);
+    for (int i = 0; i < 5; ++i)
+        limbo.collect(a);
+    assert(node::alive == 1);
+    stage = 2;
+    reader.join();
+    limbo.collect(a);
+    limbo.collect(a);
+    assert(node::alive == 0);
+}
+
+struct tracked
+{
+    static inline int alive = 0;
+    int v;
+
+    explicit tracked(int x) : v(x)
+    {
+        ++alive;
+    }
+
+    ~tracked()
+    {
+        --alive;
+    }
+};
+
+void test_epoch_ptr()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    {
+        stl::epoch_ptr<tracked> p(1);
+        {
+            stl::epoch_guard guard;
+            assert(p.load().v == 1);
+        }
+
+        // 没有读者时旧值很快被释放
+        for (int i = 2; i <= 100; ++i)
+            p.store(i);
+        assert(tracked::alive <= 4 && p.pending_reclaim() <= 3);
+
+        // 读者持有的值在读者离开之前不会被释放
+        std::atomic<int> stage{0};
+        std::thread reader([&] {
+            stl::epoch_guard guard;
+            const tracked &t = p.load();
+            stage = 1;
+            while (stage != 2)
+                std::this_thread::yield();
+            assert(t.v == 100);
+        });
+        while (stage != 1)
+            std::this_thread::yield();
+        for (int i = 101; i <= 200; ++i)
+            p.store(i);
+        assert(p.pending_reclaim() >= 100);
+        stage = 2;
+        reader.join();
+
+        p.store(201);
+        p.store(202);
+        p.store(203);
+        assert(p.pending_reclaim() <= 3);
+
+        stl::epoch_ptr<tracked> q(0);
+        p.swap(q);
+        stl::epoch_guard guard;
+        assert(p.load().v == 0 && q.load().v == 203);
+    }
+    assert(tracked::alive == 0);
+}
+
+int main()
+{
+    test_advance();
+    test_limbo();
+    test_epoch_ptr();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+//
+// Created by rda on 2024/4/27.
+//
+
+/*
+ * 测试stl::forward_list
+ * 1. 节点只有一个指针
+ * 2. insert_after, erase_after, resize
+ * 3. splice_after, merge, sort, reverse, unique, remove_if
+ * 4. 复制、移动、交换
+ * */
+
+#include <cassert>
+#include <cstdlib>
+#include <forward_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "forward_list.hh"
+
+template <typename L1, typename L2>
+bool same(const L1 &l, const L2 &r)
+{
+    auto li = l.begin();
+    auto ri = r.begin();
+    for (; li != l.end() && ri != r.end(); ++li, ++ri)
+        if (!(*li == *ri))
+            return false;
+    return li == l.end() && ri == r.end();
+}
+
+void test_footprint()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    static_assert(sizeof(stl::forward_list_node<void *>) == 2 * sizeof(void *), "");
+    static_assert(sizeof(stl::forward_list_node<int>) == sizeof(void *) + sizeof(int) + 4, "");
+    static_assert(sizeof(stl::forward_list<int>) == sizeof(void *), "");
+}
+
+void test_modifiers()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::forward_list<int> l;
+    assert(l.empty() && l.begin() == l.end());
+
+    l.push_front(2);
+    l.emplace_front(1);
+    auto it = l.insert_after(l.begin(), 3);
+    assert(*it == 3 && same(l, std::vector<int>{1, 3, 2}));
+    it = l.insert_after(it, 2, 7);
+    assert(*it == 7 && same(l, std::vector<int>{1, 3, 7, 7, 2}));
+    it = l.insert_after(l.before_begin(), {-2, -1});
+    assert(*it == -1 && l.front() == -2);
+    it = l.emplace_after(it, 0);
+    assert(same(l, std::vector<int>{-2, -1, 0, 1, 3, 7, 7, 2}));
+
+    it = l.erase_after(it);
+    assert(*it == 3);
+    it = l.erase_after(it, l.end());
+    assert(it == l.end() && same(l, std::vector<int>{-2, -1, 0, 3}));
+    l.pop_front();
+    assert(l.front() == -1);
+
+    l.resize(6, 9);
+    assert(same(l, std::vector<int>{-1, 0, 3, 9, 9, 9}));
+    l.resize(2);
+    assert(same(l, std::vector<int>{-1, 0}));
+    l.resize(0);
+    assert(l.empty());
+
+    stl::forward_list<std::string> s(3, "ab");
+    assert(same(s, std::vector<std::string>{"ab", "ab", "ab"}));
+    s.assign({"x", "y"});
+    assert(s.begin()->size() == 1 && same(s, std::vector<std::string>{"x", "y"}));
+    s.clear();
+    assert(s.empty());
+}
+
+void test_operations()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::forward_list<int> a{1, 4, 6}, b{2, 3, 5, 7};
+    a.merge(b);
+    assert(b.empty() && same(a, std::vector<int>{1, 2, 3, 4, 5, 6, 7}));
+
+    b = {10, 11, 12};
+    a.splice_after(a.begin(), b, b.begin());
+    assert(same(a, std::vector<int>{1, 11, 2, 3, 4, 5, 6, 7}) && same(b, std::vector<int>{10, 12}));
+    auto last = a.begin();
+    for (int i = 0; i < 4; ++i)
+        ++last;
+    b.splice_after(b.before_begin(), a, a.begin(), last);
+    assert(same(a, std::vector<int>{1, 4, 5, 6, 7}) && same(b, std::vector<int>{11, 2, 3, 10, 12}));
+    a.splice_after(a.before_begin(), b);
+    assert(b.empty() && same(a, std::vector<int>{11, 2, 3, 10, 12, 1, 4, 5, 6, 7}));
+
+    a.sort();
+    assert(same(a, std::vector<int>{1, 2, 3, 4, 5, 6, 7, 10, 11, 12}));
+    a.reverse();
+    assert(same(a, std::vector<int>{12, 11, 10, 7, 6, 5, 4, 3, 2, 1}));
+    assert(a.remove_if([](int v) { return v % 2; }) == 5);
+    assert(same(a, std::vector<int>{12, 10, 6, 4, 2}));
+    a = {1, 1, 2, 2, 2, 3, 1};
+    assert(a.unique() == 3 && same(a, std::vector<int>{1, 2, 3, 1}));
+    assert(a.remove(1) == 2 && same(a, std::vector<int>{2, 3}));
+
+    // 要删除的值就是链表中的元素
+    a = {1, 2, 1, 3, 1};
+    assert(a.remove(a.front()) == 3 && same(a, std::vector<int>{2, 3}));
+    const std::string word(32, 'w');
+    stl::forward_list<std::string> words{word, "x", word, word};
+    assert(words.remove(*++words.begin()) == 1 && words.remove(words.front()) == 3 && words.empty());
+
+    // 排序是稳定的，且与std::forward_list一致
+    srand(2024);
+    std::vector<std::pair<int, int>> values;
+    for (int i = 0; i < 10000; ++i)
+        values.emplace_back(rand() % 100, i);
+    stl::forward_list<std::pair<int, int>> l(values.begin(), values.end());
+    std::forward_list<std::pair<int, int>> expect(values.begin(), values.end());
+    auto by_first = [](const std::pair<int, int> &x, const std::pair<int, int> &y) { return x.first < y.first; };
+    l.sort(by_first);
+    expect.sort(by_first);
+    assert(same(l, expect));
+}
+
+void test_copy_move()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::forward_list<std::string> l{"a", "b", "c"};
+    stl::forward_list<std::string> copy(l);
+    assert(copy == l);
+
+    stl::forward_list<std::string> moved(std::move(copy));
+    assert(moved == l && copy.empty());
+
+    copy = {"x"};
+    stl::swap(copy, moved);
+    assert(copy == l && moved != l && moved.front() == "x");
+
+    moved = l;
+    assert(moved == l);
+    moved = std::move(copy);
+    assert(moved == l);
+}
+
+int main()
+{
+    test_footprint();
+    test_modifiers();
+    test_operations();
+    test_copy_move();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
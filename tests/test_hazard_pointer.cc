@@ -0,0 +1,239 @@
+//
+// Created by rda on 2024/5/25.
+//
+
+/*
+ * 测试stl::hazard_domain与stl::hazard_limbo
+ * 1. 被槽位指向的节点不会被释放，其余节点在扫描时释放
+ * 2. 停住的读者只阻止它指向的节点，未回收的节点个数有上界；同样情况下EBR的未回收节点持续增长
+ * 3. 嵌套的hazard_guard使用各自的槽位，for_each的回调中调用contains、erase不会让当前节点失去保护
+ * 4. lockfree_list在EBR与hazard pointer下的吞吐量对比
+ * */
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ths_list.hh"
+
+struct node : stl::hazard_node
+{
+    static inline int alive = 0;
+    int v;
+
+    explicit node(int x) : v(x)
+    {
+        ++alive;
+    }
+
+    ~node()
+    {
+        --alive;
+    }
+};
+
+using node_alloc = stl::simple_alloc<node, stl::alloc>;
+
+node *make_node(node_alloc &a, int v)
+{
+    node *n = a.allocate();
+    stl::construct(n, v);
+    return n;
+}
+
+void test_scan()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    node_alloc a;
+    stl::hazard_limbo<node, stl::alloc> limbo;
+
+    node *kept = make_node(a, 1);
+    {
+        stl::hazard_guard guard;
+        guard.protect(0, kept);
+        limbo.retire(kept, a);
+        limbo.retire(make_node(a, 2), a);
+        limbo.scan(a);
+        assert(node::alive == 1 && limbo.pending() == 1);
+        assert(kept->v == 1);
+    }
+
+    // guard析构后槽位清空
+    limbo.scan(a);
+    assert(node::alive == 0 && limbo.pending() == 0);
+
+    // 达到阈值时自动扫描
+    for (size_t i = 0; i < 3 * stl::hazard_domain::scan_threshold(); ++i)
+        limbo.retire(make_node(a, int(i)), a);
+    assert(limbo.pending() < stl::hazard_domain::scan_threshold());
+
+    limbo.retire(make_node(a, 0), a);
+    limbo.drain(a);
+    assert(node::alive == 0);
+}
+
+void test_nested_guard()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    node_alloc a;
+    stl::hazard_limbo<node, stl::alloc> limbo;
+
+    node *outer = make_node(a, 1), *inner = make_node(a, 2);
+    {
+        stl::hazard_guard guard;
+        guard.protect(0, outer);
+        {
+            stl::hazard_guard nested;
+            nested.protect(0, inner);
+            limbo.retire(outer, a);
+            limbo.retire(inner, a);
+            limbo.scan(a);
+            assert(node::alive == 2);
+        }
+        // 内层guard析构只清空自己的槽位
+        limbo.scan(a);
+        assert(node::alive == 1 && outer->v == 1);
+    }
+    limbo.scan(a);
+    assert(node::alive == 0 && limbo.pending() == 0);
+}
+
+// for_each的回调中查找并删除当前元素，随后的删除触发扫描，当前节点仍受外层guard保护
+void test_nested_for_each()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::lockfree_list<int, std::less<int>, stl::alloc, stl::hazard_reclaimer> l;
+    for (int i = 0; i < 100; ++i)
+        l.insert(i);
+
+    std::vector<int> seen;
+    l.for_each([&](int v) {
+        assert(l.contains(v));
+        seen.push_back(v);
+        if (v == 50)
+        {
+            l.erase(v);
+            for (size_t i = 0; i < 4 * stl::hazard_domain::scan_threshold(); ++i)
+            {
+                l.insert(1000);
+                l.erase(1000);
+            }
+        }
+    });
+    assert(seen.size() == 100);
+    for (int i = 0; i < 100; ++i)
+        assert(seen[i] == i);
+    assert(!l.contains(50) && l.contains(51));
+}
+
+// 一个读者停在链表中间时，另一个线程反复插入和删除
+template <typename Reclaimer>
+size_t pending_with_stalled_reader()
+{
+    using list = stl::lockfree_list<int, std::less<int>, stl::alloc, Reclaimer>;
+    list l;
+    for (int i = 0; i < 100; ++i)
+        l.insert(i);
+
+    std::atomic<int> stage{0};
+    std::thread reader([&] {
+        l.for_each([&](int v) {
+            if (v == 50)
+            {
+                stage = 1;
+                while (stage != 2)
+                    std::this_thread::yield();
+            }
+        });
+    });
+    while (stage != 1)
+        std::this_thread::yield();
+
+    for (int round = 0; round < 100; ++round)
+        for (int i = 0; i < 100; ++i)
+        {
+            l.erase(i);
+            l.insert(i);
+        }
+    size_t pending = l.pending_reclaim();
+    stage = 2;
+    reader.join();
+    return pending;
+}
+
+void test_stalled_reader()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    size_t hp = pending_with_stalled_reader<stl::hazard_reclaimer>();
+    size_t ebr = pending_with_stalled_reader<stl::epoch_reclaimer>();
+    // 共删除10000个节点：hazard pointer只保留阈值以内的节点，EBR一个也不能释放
+    assert(hp <= stl::hazard_domain::scan_threshold() + stl::hazard_domain::SLOTS);
+    assert(ebr >= 10000);
+}
+
+// 每个线程按9:1:1的比例查找、插入、删除，返回单个线程每次操作的平均纳秒数
+template <typename Reclaimer>
+double bench(int threads, int ops)
+{
+    using list = stl::lockfree_list<int, std::less<int>, stl::alloc, Reclaimer>;
+    const int range = 512;
+    list l;
+    for (int i = 0; i < range; i += 2)
+        l.insert(i);
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            std::uniform_int_distribution<int> key(0, range - 1), op(0, 10);
+            while (!start.load())
+                std::this_thread::yield();
+            for (int i = 0; i < ops; ++i)
+            {
+                int k = key(gen), o = op(gen);
+                if (o == 0)
+                    l.insert(k);
+                else if (o == 1)
+                    l.erase(k);
+                else
+                    (void) l.contains(k);
+            }
+        });
+
+    auto begin = std::chrono::steady_clock::now();
+    start = true;
+    for (auto &w : workers)
+        w.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / ops;
+}
+
+void test_bench()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int ops = 20000;
+    for (int threads : {1, 4})
+    {
+        double ebr = bench<stl::epoch_reclaimer>(threads, ops);
+        double hp = bench<stl::hazard_reclaimer>(threads, ops);
+        printf("threads %d: ebr %.1f ns/op, hazard pointer %.1f ns/op\n", threads, ebr, hp);
+    }
+}
+
+int main()
+{
+    test_scan();
+    test_nested_guard();
+    test_nested_for_each();
+    test_stalled_reader();
+    test_bench();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
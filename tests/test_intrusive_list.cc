@@ -0,0 +1,180 @@
+//
+// Created by rda on 2024/4/20.
+//
+
+/*
+ * 测试stl::intrusive_list
+ * 1. 插入与删除不分配内存，迭代器直接指向元素本身
+ * 2. 元素通过hook自行摘下，析构时自动摘下
+ * 3. 同一个元素通过不同的hook同时位于多个链表
+ * 4. 拼接、反转、移动、交换
+ * */
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "intrusive_list.hh"
+
+static size_t allocations = 0;
+
+void *operator new(size_t n)
+{
+    ++allocations;
+    if (void *p = malloc(n))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+struct timer
+{
+    int id;
+    stl::list_hook hook;     // 所在的时间轮槽位
+    stl::list_hook all_hook; // 所有定时器
+
+    explicit timer(int i = 0) : id(i) {}
+};
+
+using timer_list = stl::intrusive_list<timer, &timer::hook>;
+using all_timers = stl::intrusive_list<timer, &timer::all_hook>;
+
+template <typename List>
+bool ids_are(const List &l, std::initializer_list<int> ids)
+{
+    auto it = l.begin();
+    for (int id : ids)
+    {
+        if (it == l.end() || (*it).id != id)
+            return false;
+        ++it;
+    }
+    return it == l.end();
+}
+
+void test_link()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    timer ts[5]{timer(0), timer(1), timer(2), timer(3), timer(4)};
+    timer_list l;
+    assert(l.empty() && l.size() == 0);
+
+    size_t before = allocations;
+    for (auto &t : ts)
+        l.push_back(t);
+    assert(allocations == before);
+    assert(l.size() == 5 && &l.front() == &ts[0] && &l.back() == &ts[4]);
+    assert(ids_are(l, {0, 1, 2, 3, 4}));
+
+    // 迭代器可以由元素直接得到，删除为O(1)
+    auto it = l.erase(l.iterator_to(ts[2]));
+    assert(&*it == &ts[3] && !ts[2].hook.is_linked());
+    l.insert(it, ts[2]);
+    assert(ids_are(l, {0, 1, 2, 3, 4}));
+
+    // 元素不经过链表自行摘下
+    ts[0].hook.unlink();
+    ts[4].hook.unlink();
+    assert(ids_are(l, {1, 2, 3}));
+    l.pop_front();
+    l.push_front(ts[4]);
+    l.pop_back();
+    assert(ids_are(l, {4, 2}) && !ts[1].hook.is_linked());
+    l.remove(ts[4]);
+    assert(ids_are(l, {2}));
+
+    // 元素析构时自动摘下
+    {
+        timer temp(9);
+        l.push_back(temp);
+        assert(ids_are(l, {2, 9}));
+    }
+    assert(ids_are(l, {2}));
+
+    // 复制元素不复制链接关系
+    timer copy = ts[2];
+    assert(!copy.hook.is_linked());
+
+    l.clear();
+    assert(l.empty() && !ts[2].hook.is_linked());
+    assert(allocations == before);
+}
+
+void test_multi_hook()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    timer ts[4]{timer(0), timer(1), timer(2), timer(3)};
+    timer_list even, odd;
+    all_timers all;
+    for (auto &t : ts)
+    {
+        all.push_back(t);
+        (t.id % 2 ? odd : even).push_back(t);
+    }
+    assert(ids_are(all, {0, 1, 2, 3}) && ids_are(even, {0, 2}) && ids_are(odd, {1, 3}));
+
+    even.erase(even.begin());
+    assert(ids_are(all, {0, 1, 2, 3}) && ids_are(even, {2}));
+    all.erase(all.iterator_to(ts[3]));
+    assert(ids_are(all, {0, 1, 2}) && ids_are(odd, {1, 3}));
+
+    const all_timers &call = all;
+    assert((*call.iterator_to(ts[1])).id == 1);
+    int expect = 2;
+    for (auto rit = all.rbegin(); rit != all.rend(); ++rit)
+        assert((*rit).id == expect--);
+}
+
+void test_splice()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    timer ts[6]{timer(0), timer(1), timer(2), timer(3), timer(4), timer(5)};
+    timer_list a, b;
+    for (int i = 0; i < 3; ++i)
+        a.push_back(ts[i]);
+    for (int i = 3; i < 6; ++i)
+        b.push_back(ts[i]);
+
+    size_t before = allocations;
+    a.splice(a.iterator_to(ts[1]), b, b.iterator_to(ts[4]));
+    assert(ids_are(a, {0, 4, 1, 2}) && ids_are(b, {3, 5}));
+    a.splice(a.end(), b);
+    assert(ids_are(a, {0, 4, 1, 2, 3, 5}) && b.empty());
+    b.splice(b.begin(), a, a.iterator_to(ts[1]), a.iterator_to(ts[5]));
+    assert(ids_are(a, {0, 4, 5}) && ids_are(b, {1, 2, 3}));
+
+    a.reverse();
+    assert(ids_are(a, {5, 4, 0}));
+
+    stl::swap(a, b);
+    assert(ids_are(a, {1, 2, 3}) && ids_are(b, {5, 4, 0}));
+
+    timer_list c(std::move(a));
+    assert(a.empty() && ids_are(c, {1, 2, 3}));
+    c = std::move(b);
+    assert(b.empty() && ids_are(c, {5, 4, 0}) && !ts[1].hook.is_linked());
+    c.erase(c.begin(), c.end());
+    assert(c.empty() && !ts[5].hook.is_linked());
+    assert(allocations == before);
+}
+
+int main()
+{
+    test_link();
+    test_multi_hook();
+    test_splice();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
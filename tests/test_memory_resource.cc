@@ -0,0 +1,211 @@
+//
+// Created by rda on 2024/3/16.
+//
+
+/*
+ * 测试容器持有配置器实例
+ * 1. 无状态的配置器不增加容器的大小
+ * 2. 同一类型的容器使用不同的内存资源
+ * 3. 复制、移动、交换时配置器的传递
+ * 4. 默认内存资源
+ * */
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+
+#include "deque.hh"
+#include "hashtable.hh"
+#include "list.hh"
+#include "memory_resource.hh"
+#include "set.hh"
+#include "vector.hh"
+
+// 统计分配与回收字节数的内存资源
+class counting_resource : public stl::memory_resource
+{
+public:
+    size_t allocated = 0;
+    size_t deallocated = 0;
+
+    size_t in_use() const
+    {
+        return allocated - deallocated;
+    }
+
+protected:
+    void *do_allocate(size_t bytes, size_t align) override
+    {
+        allocated += bytes;
+        return stl::alloc_resource_instance()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t align) override
+    {
+        deallocated += bytes;
+        stl::alloc_resource_instance()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const stl::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+using pvector = stl::vector<int, stl::polymorphic_alloc>;
+using plist = stl::list<int, stl::polymorphic_alloc>;
+using pdeque = stl::deque<int, stl::polymorphic_alloc>;
+using pset = stl::set<int, std::less<int>, stl::polymorphic_alloc>;
+using phashtable = stl::Hashtable<int, int, std::hash<int>, std::_Identity<int>, std::equal_to<int>,
+                                  stl::polymorphic_alloc>;
+
+void test_empty_base()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    assert(sizeof(stl::vector<int>) == 3 * sizeof(int *));
+    assert(sizeof(stl::list<int>) == sizeof(void *) + sizeof(size_t));
+    assert(sizeof(stl::vector<int, stl::Arena_alloc>) == 3 * sizeof(int *));
+    assert(sizeof(pvector) == 4 * sizeof(int *));
+}
+
+void test_per_container_resource()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    counting_resource r1, r2;
+
+    {
+        pvector v1(&r1), v2(&r2);
+        plist l1(&r1);
+        pdeque d2(&r2);
+        pset s1(&r1);
+        phashtable h2(0, std::hash<int>(), std::equal_to<int>(), &r2);
+        size_t r2_in_use = r2.in_use();
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            v1.push_back(i);
+            l1.push_back(i);
+            s1.insert(i);
+        }
+        assert(r1.in_use() > 0 && r2.in_use() == r2_in_use);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            v2.push_back(i);
+            d2.push_back(i);
+            h2.insert_unique(i);
+        }
+        assert(r2.in_use() > r2_in_use);
+        assert(v1.get_allocator() == stl::polymorphic_alloc(&r1));
+        assert(d2.get_allocator() == stl::polymorphic_alloc(&r2));
+        assert(h2.get_allocator() != s1.get_allocator());
+    }
+
+    // 所有内存都归还给了各自的内存资源
+    assert(r1.allocated > 0 && r1.in_use() == 0);
+    assert(r2.allocated > 0 && r2.in_use() == 0);
+}
+
+void test_propagation()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    counting_resource r1, r2;
+
+    {
+        pvector v1({1, 2, 3}, &r1);
+
+        // 复制构造复制配置器
+        pvector v2(v1);
+        assert(v2.get_allocator() == v1.get_allocator());
+
+        // 移动赋值时配置器随元素一起转移
+        pvector v3(&r2);
+        v3.push_back(4);
+        v3 = std::move(v2);
+        assert(v3.get_allocator().get_resource() == &r1);
+        assert(v3.size() == 3 && v3[2] == 3);
+
+        // 交换时配置器一起交换
+        pvector v4({5, 6}, &r2);
+        v4.swap(v3);
+        assert(v4.get_allocator().get_resource() == &r1);
+        assert(v3.get_allocator().get_resource() == &r2);
+
+        plist l1({1, 2, 3}, &r1), l2(&r2);
+        l2 = std::move(l1);
+        assert(l2.get_allocator().get_resource() == &r1 && l2.size() == 3);
+        assert(l1.get_allocator().get_resource() == &r2 && l1.empty());
+        l1.push_back(7);
+
+        pdeque d1({1, 2, 3}, &r1), d2(&r2);
+        d2 = std::move(d1);
+        assert(d2.get_allocator().get_resource() == &r1 && d2.size() == 3);
+        d2.swap(d1);
+        assert(d1.get_allocator().get_resource() == &r1 && d1.size() == 3);
+
+        pset s1({3, 2, 1}, std::less<int>(), &r1), s2(&r2);
+        s2 = std::move(s1);
+        assert(s2.get_allocator().get_resource() == &r1 && s2.size() == 3);
+
+        phashtable h1(0, std::hash<int>(), std::equal_to<int>(), &r1), h2(0, std::hash<int>(), std::equal_to<int>(), &r2);
+        h1.insert_unique(1);
+        h2 = std::move(h1);
+        assert(h2.get_allocator().get_resource() == &r1 && h2.size() == 1);
+        h1.insert_unique(2);
+    }
+
+    assert(r1.in_use() == 0 && r2.in_use() == 0);
+}
+
+void test_arena_resource()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::arena_resource tenant1, tenant2;
+
+    {
+        pvector v1(&tenant1), v2(&tenant2);
+        for (int i = 0; i < 1000; ++i)
+            v1.push_back(i);
+        v2.push_back(1);
+        assert(tenant1.get_arena().used() > tenant2.get_arena().used());
+    }
+    tenant1.reset();
+    assert(tenant1.get_arena().used() == 0);
+
+    // 超过ALIGN的对齐要求
+    void *p = stl::get_default_resource()->allocate(100, 64);
+    assert(reinterpret_cast<uintptr_t>(p) % 64 == 0);
+    stl::get_default_resource()->deallocate(p, 100, 64);
+}
+
+void test_default_resource()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    counting_resource r;
+    stl::memory_resource *old = stl::set_default_resource(&r);
+
+    {
+        pvector v;
+        v.push_back(1);
+        assert(v.get_allocator().get_resource() == &r);
+        assert(r.in_use() > 0);
+    }
+    assert(r.in_use() == 0);
+
+    assert(stl::set_default_resource(nullptr) == &r);
+    assert(stl::get_default_resource() == old);
+}
+
+int main()
+{
+    test_empty_base();
+    test_per_container_resource();
+    test_propagation();
+    test_arena_resource();
+    test_default_resource();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
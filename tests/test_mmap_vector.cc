@@ -0,0 +1,226 @@
+//
+// Created by rda on 2024/4/6.
+//
+
+/*
+ * 测试stl::mmap_vector
+ * 1. 追加模式写入，关闭时截断为实际大小
+ * 2. 只读模式映射已有的文件，多个映射共享同一份内容
+ * 3. 追加映射中自身的元素时，扩容移动映射后仍然读到正确的元素
+ * 4. 文件大小不是sizeof(T)的整数倍、文件不存在时抛出异常
+ * 5. 只读模式下修改元素个数、取得可写的引用都会抛出异常，不会写入只读的映射
+ * */
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mmap_vector.hh"
+
+struct record
+{
+    int id;
+    double value;
+};
+
+std::string temp_path(const char *name)
+{
+    return std::string("/tmp/test_mmap_vector_") + std::to_string(getpid()) + "_" + name;
+}
+
+size_t file_size(const std::string &path)
+{
+    struct stat st;
+    assert(stat(path.c_str(), &st) == 0);
+    return st.st_size;
+}
+
+void test_append_and_read()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::string path = temp_path("records");
+    unlink(path.c_str());
+
+    {
+        stl::mmap_vector<record> out(path.c_str(), stl::mmap_vector<record>::appendable);
+        assert(out.is_open() && out.empty());
+        for (int i = 0; i < 100000; ++i)
+            out.push_back(record{i, i * 0.5});
+        record more[3] = {{-1, 0}, {-2, 0}, {-3, 0}};
+        out.append(more, more + 3);
+        out.push_back(out[0]);
+        assert(out.size() == 100004 && out.capacity() >= out.size());
+        out[1].value = 42;
+    }
+    // 关闭时去掉预先扩展的部分
+    assert(file_size(path) == 100004 * sizeof(record));
+
+    // 只读模式的元素只能通过const引用访问
+    stl::mmap_vector<record> in(path.c_str());
+    const stl::mmap_vector<record> in2(path.c_str());
+    const stl::mmap_vector<record> &view = in;
+    assert(view.size() == 100004 && in2.size() == 100004 && view.data() != in2.data());
+    for (int i = 2; i < 100000; ++i)
+        assert(view[i].id == i && view[i].value == i * 0.5);
+    assert(view[1].value == 42 && view[100001].id == -2 && view.back().id == 0);
+
+    double sum = 0;
+    for (const record &r : in2)
+        sum += r.id;
+    assert(sum == 99999.0 * 100000 / 2 - 6);
+    assert((*view.rbegin()).id == 0 && (*(view.rbegin() + 1)).id == -3);
+
+    // 继续追加
+    {
+        stl::mmap_vector<record> out(path.c_str(), stl::mmap_vector<record>::appendable);
+        assert(out.size() == 100004 && out.capacity() == out.size());
+        out.push_back(record{7, 7});
+    }
+    assert(file_size(path) == 100005 * sizeof(record));
+
+    // 移动
+    stl::mmap_vector<record> moved(std::move(in));
+    assert(!in.is_open() && moved.size() == 100004);
+    in = std::move(moved);
+    assert(in.size() == 100004 && !moved.is_open());
+
+    unlink(path.c_str());
+}
+
+template <typename F>
+bool throws_logic_error(F f)
+{
+    try
+    {
+        f();
+    }
+    catch (std::logic_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+// 只读模式先pop_back或clear再push_back会写入只读的映射，必须在修改之前拒绝
+void test_read_only()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::string path = temp_path("read_only");
+    unlink(path.c_str());
+    {
+        stl::mmap_vector<record> out(path.c_str(), stl::mmap_vector<record>::appendable);
+        for (int i = 0; i < 10; ++i)
+            out.push_back(record{i, i * 0.5});
+    }
+
+    stl::mmap_vector<record> in(path.c_str());
+    record r{-1, 0};
+    assert(throws_logic_error([&] { in.reserve(in.size() + 1); }));
+    assert(throws_logic_error([&] { in.pop_back(); }));
+    assert(throws_logic_error([&] { in.clear(); }));
+    assert(throws_logic_error([&] { in.push_back(r); }));
+    assert(throws_logic_error([&] { in.append(&r, &r + 1); }));
+    assert(in.size() == 10);
+
+    // 非const的访问会得到可写的引用
+    assert(throws_logic_error([&] { in[0].id = 1; }));
+    assert(throws_logic_error([&] { in.at(0).id = 1; }));
+    assert(throws_logic_error([&] { in.front(); }));
+    assert(throws_logic_error([&] { in.back(); }));
+    assert(throws_logic_error([&] { in.data(); }));
+    assert(throws_logic_error([&] { in.begin(); }));
+    assert(throws_logic_error([&] { in.rend(); }));
+
+    const stl::mmap_vector<record> &view = in;
+    assert(view[0].id == 0 && view.back().id == 9 && view.end() - view.begin() == 10);
+
+    // 未打开时没有映射，非const访问照常可用
+    stl::mmap_vector<record> closed;
+    assert(closed.begin() == closed.end() && closed.data() == nullptr);
+
+    unlink(path.c_str());
+}
+
+// 追加映射中自身的元素，扩容时映射可能被移动
+void test_self_append()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::string path = temp_path("self");
+    unlink(path.c_str());
+
+    {
+        stl::mmap_vector<record> out(path.c_str(), stl::mmap_vector<record>::appendable);
+        out.push_back(record{0, 0});
+        for (int i = 1; out.size() < out.capacity(); ++i)
+            out.push_back(record{i, i * 0.5});
+        const size_t n = out.size();
+
+        // 容量已满，每次追加都要重新映射
+        for (int round = 0; round < 4; ++round)
+            out.append(out.data(), out.data() + out.size());
+        assert(out.size() == 16 * n);
+        for (size_t i = 0; i < out.size(); ++i)
+            assert(out[i].id == int(i % n) && out[i].value == int(i % n) * 0.5);
+    }
+
+    unlink(path.c_str());
+}
+
+void test_errors()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    std::string path = temp_path("bad");
+
+    // 大小不是sizeof(T)的整数倍
+    FILE *f = fopen(path.c_str(), "w");
+    fwrite("abc", 1, 3, f);
+    fclose(f);
+    bool thrown = false;
+    try
+    {
+        stl::mmap_vector<record> v(path.c_str());
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+    unlink(path.c_str());
+
+    // 文件不存在
+    thrown = false;
+    try
+    {
+        stl::mmap_vector<record> v(path.c_str());
+    }
+    catch (std::system_error &e)
+    {
+        thrown = e.code().value() == ENOENT;
+    }
+    assert(thrown);
+
+    // 空文件
+    f = fopen(path.c_str(), "w");
+    fclose(f);
+    const stl::mmap_vector<record> empty(path.c_str());
+    assert(empty.is_open() && empty.empty() && empty.begin() == empty.end());
+    unlink(path.c_str());
+}
+
+int main()
+{
+    test_append_and_read();
+    test_self_append();
+    test_errors();
+    test_read_only();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
@@ -0,0 +1,100 @@
+//
+// Created by rda on 2024/3/30.
+//
+
+/*
+ * 测试stl::pinned_vector
+ * 1. 追加元素时地址不变，按页提交
+ * 2. 超过保留的大小时抛出异常
+ * 3. shrink_to_fit归还多余的页
+ * 4. 复制、移动、交换
+ * */
+
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "pinned_vector.hh"
+
+void test_stable_growth()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::pinned_vector<int> v(1 << 20);
+    assert(v.empty() && v.capacity() == 0 && v.max_size() == (1 << 20));
+
+    v.push_back(0);
+    const int *first = &v.front();
+    size_t page_elems = sysconf(_SC_PAGESIZE) / sizeof(int);
+    assert(v.capacity() == page_elems);
+
+    // 元素始终留在原来的位置
+    for (int i = 1; i < 500000; ++i)
+    {
+        v.push_back(i);
+        assert(&v.front() == first);
+    }
+    assert(v.size() == 500000 && v.capacity() >= v.size() && v.capacity() <= v.max_size());
+    for (int i = 0; i < 500000; ++i)
+        assert(v[i] == i);
+
+    // 填满整个保留的地址空间
+    v.resize(v.max_size(), 7);
+    assert(v.back() == 7 && v.data() == first);
+    bool thrown = false;
+    try
+    {
+        v.push_back(1);
+    }
+    catch (std::length_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown && v.size() == v.max_size());
+
+    // 归还多余的页，之后仍然可以继续追加
+    v.resize(10);
+    v.shrink_to_fit();
+    assert(v.capacity() == page_elems && v[9] == 9);
+    v.emplace_back(10);
+    assert(v.size() == 11 && v.data() == first);
+}
+
+void test_non_trivial()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::pinned_vector<std::string> v(100000);
+    for (int i = 0; i < 100000; ++i)
+        v.emplace_back(std::to_string(i));
+    const std::string *p = &v[12345];
+    v.pop_back();
+    assert(&v[12345] == p && *p == "12345" && v.back() == "99998");
+
+    // 复制保留相同大小的地址空间
+    stl::pinned_vector<std::string> copy(v);
+    assert(copy == v && copy.max_size() == v.max_size() && copy.data() != v.data());
+
+    // 移动直接接管地址空间
+    const std::string *data = copy.data();
+    stl::pinned_vector<std::string> moved(std::move(copy));
+    assert(moved == v && copy.empty() && copy.max_size() == 0);
+
+    stl::pinned_vector<std::string> small{"a", "b"};
+    stl::swap(small, moved);
+    assert(small == v && moved.size() == 2 && moved[1] == "b");
+
+    moved = std::move(small);
+    assert(moved == v && moved.data() == data);
+    v.clear();
+    assert(v.empty() && v.capacity() > 0);
+}
+
+int main()
+{
+    test_stable_growth();
+    test_non_trivial();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
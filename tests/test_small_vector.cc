@@ -0,0 +1,147 @@
+//
+// Created by rda on 2024/3/23.
+//
+
+/*
+ * 测试stl::small_vector
+ * 1. 不超过N个元素时不经过配置器
+ * 2. 超过N个元素时搬到堆上，shrink_to_fit搬回内部缓冲区
+ * 3. 复制、移动、交换
+ * */
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "memory_resource.hh"
+#include "small_vector.hh"
+
+// 统计第二级配置器的分配次数
+size_t total_allocs()
+{
+    stl::alloc_stats stats = stl::alloc::stats();
+    size_t allocs = stats.large_allocs;
+    for (size_t i = 0; i < stl::NFREELISTS; ++i)
+        allocs += stats.classes[i].allocs;
+    return allocs;
+}
+
+void test_inline()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    size_t before = total_allocs();
+
+    {
+        stl::small_vector<int, 8> v;
+        for (int i = 0; i < 8; ++i)
+            v.push_back(i);
+        v.erase(v.begin() + 2);
+        v.insert(v.begin() + 2, 2);
+        assert(v.is_inline() && v.size() == 8 && v.capacity() == 8);
+        for (int i = 0; i < 8; ++i)
+            assert(v[i] == i);
+
+        stl::small_vector<int, 8> v2{1, 2, 3}, v3(5, 7);
+        assert(v2.is_inline() && v2.back() == 3);
+        assert(v3.is_inline() && v3.size() == 5 && v3[4] == 7);
+        v2 = v3;
+        assert(v2 == v3);
+    }
+
+    // 没有经过配置器
+    assert(total_allocs() == before);
+}
+
+void test_spill()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::small_vector<int, 4> v;
+    for (int i = 0; i < 100; ++i)
+        v.push_back(i);
+    assert(!v.is_inline() && v.size() == 100 && v.capacity() >= 100);
+    for (int i = 0; i < 100; ++i)
+        assert(v[i] == i);
+
+    // 元素减少后搬回内部缓冲区
+    v.resize(3);
+    v.shrink_to_fit();
+    assert(v.is_inline() && v.capacity() == 4);
+    assert(v[0] == 0 && v[2] == 2);
+
+    // 不能按字节搬移的元素
+    stl::small_vector<std::string, 2> vs;
+    for (int i = 0; i < 50; ++i)
+        vs.push_back(std::string(20, char('a' + i % 26)));
+    assert(!vs.is_inline());
+    vs.erase(vs.begin() + 1, vs.end());
+    vs.shrink_to_fit();
+    assert(vs.is_inline() && vs.size() == 1 && vs[0] == std::string(20, 'a'));
+}
+
+void test_move_swap()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    using svec = stl::small_vector<std::string, 4>;
+
+    // 移动内部缓冲区中的元素
+    svec a{"1", "2"};
+    svec b(std::move(a));
+    assert(b.is_inline() && b.size() == 2 && b[1] == "2");
+    assert(a.empty());
+
+    // 直接接管堆上的存储空间
+    svec c;
+    for (int i = 0; i < 10; ++i)
+        c.push_back(std::to_string(i));
+    const std::string *data = c.data();
+    svec d(std::move(c));
+    assert(!d.is_inline() && d.data() == data && d[9] == "9");
+    assert(c.empty() && c.is_inline() && c.capacity() == 4);
+    c.push_back("42");
+
+    // 移动赋值
+    b = std::move(d);
+    assert(!b.is_inline() && b.data() == data && d.empty());
+    d = std::move(c);
+    assert(d.is_inline() && d[0] == "42");
+
+    // 交换内部缓冲区与堆上的元素
+    stl::swap(b, d);
+    assert(b.is_inline() && b.size() == 1 && b[0] == "42");
+    assert(!d.is_inline() && d.size() == 10 && d[3] == "3");
+
+    // 复制
+    stl::small_vector<std::string, 3> s1{"a", "b"};
+    stl::small_vector<std::string, 3> s2(s1);
+    s1[0] = "z";
+    assert(s2.is_inline() && s2[0] == "a" && s2[1] == "b");
+}
+
+void test_resource()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::arena_resource r;
+
+    using pvector = stl::small_vector<int, 16, stl::polymorphic_alloc>;
+    pvector v(&r);
+    for (int i = 0; i < 16; ++i)
+        v.push_back(i);
+    assert(r.get_arena().used() == 0);
+    v.push_back(16);
+    assert(r.get_arena().used() > 0);
+
+    pvector v2(std::move(v));
+    assert(v2.get_allocator().get_inner().get_resource() == &r && v2.size() == 17);
+}
+
+int main()
+{
+    test_inline();
+    test_spill();
+    test_move_swap();
+    test_resource();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+//
+// Created by rda on 2024/5/4.
+//
+
+/*
+ * 测试stl::ths_list
+ * 1. 单线程下的有序集合语义
+ * 2. 多个线程在不同位置并发插入与删除
+ * 3. 读者在修改期间不加锁地查找与遍历
+ * 4. lockfree_list的相同语义
+ * 5. 删除的节点在析构之前就被回收
+ * 6. 使用hazard pointer回收的lockfree_list
+ * */
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ths_list.hh"
+
+template <typename T, typename Compare = std::less<T>>
+using hp_list = stl::lockfree_list<T, Compare, stl::alloc, stl::hazard_reclaimer>;
+
+template <template <typename...> class List>
+void test_sequential()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    List<int> l{5, 1, 3};
+    assert(l.size() == 3 && !l.empty());
+    assert(l.contains(1) && l.contains(3) && l.contains(5) && !l.contains(2));
+
+    assert(l.insert(2) && !l.insert(3));
+    std::vector<int> seen;
+    l.for_each([&](int v) { seen.push_back(v); });
+    assert((seen == std::vector<int>{1, 2, 3, 5}));
+
+    assert(l.erase(1) && !l.erase(1) && !l.erase(4));
+    assert(l.erase(5) && l.size() == 2 && !l.contains(5));
+    l.clear();
+    assert(l.empty() && l.size() == 0);
+
+    List<std::string, std::greater<std::string>> s;
+    s.insert("b");
+    std::string a = "a";
+    s.insert(std::move(a));
+    s.insert("c");
+    std::string joined;
+    s.for_each([&](const std::string &v) { joined += v; });
+    assert(joined == "cba");
+}
+
+template <template <typename...> class List>
+void test_concurrent()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    const int threads = 4, per_thread = 2000;
+    List<int> l;
+    std::atomic<bool> done{false};
+
+    // 读者：元素始终有序且不重复
+    std::thread reader([&] {
+        while (!done.load())
+        {
+            int prev = -1;
+            l.for_each([&](int v) {
+                assert(v > prev);
+                prev = v;
+            });
+            (void) l.contains(prev);
+        }
+    });
+
+    // 各线程交错地插入，使修改分散在整个链表中
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i)
+                assert(l.insert(i * threads + t));
+        });
+    for (auto &w : workers)
+        w.join();
+    workers.clear();
+    assert(l.size() == size_t(threads * per_thread));
+
+    // 并发删除偶数，同时插入重复元素必然失败
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            for (int i = t; i < threads * per_thread; i += threads)
+            {
+                if (i % 2 == 0)
+                    assert(l.erase(i));
+                else
+                    assert(!l.insert(i));
+            }
+        });
+    for (auto &w : workers)
+        w.join();
+    done = true;
+    reader.join();
+
+    assert(l.size() == size_t(threads * per_thread / 2));
+    for (int i = 0; i < threads * per_thread; ++i)
+        assert(l.contains(i) == (i % 2 == 1));
+}
+
+// 记录存活的对象个数
+struct counted
+{
+    static inline std::atomic<int> alive{0};
+    int v;
+
+    counted(int x) : v(x)
+    {
+        ++alive;
+    }
+
+    counted(const counted &other) : v(other.v)
+    {
+        ++alive;
+    }
+
+    ~counted()
+    {
+        --alive;
+    }
+
+    bool operator<(const counted &other) const
+    {
+        return v < other.v;
+    }
+};
+
+template <template <typename...> class List>
+void test_reclaim()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    {
+        List<counted> l;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t)
+            workers.emplace_back([&, t] {
+                for (int round = 0; round < 500; ++round)
+                    for (int i = 0; i < 20; ++i)
+                    {
+                        counted c(i * 4 + t);
+                        assert(l.insert(c));
+                        assert(l.contains(c));
+                        assert(l.erase(c));
+                    }
+            });
+        for (auto &w : workers)
+            w.join();
+
+        // 共删除40000个节点，只有最近的少量节点仍在等待回收
+        assert(l.empty());
+        assert(counted::alive.load() < 4000);
+    }
+    assert(counted::alive.load() == 0);
+}
+
+int main()
+{
+    test_sequential<stl::ths_list>();
+    test_concurrent<stl::ths_list>();
+    test_sequential<stl::lockfree_list>();
+    test_concurrent<stl::lockfree_list>();
+    test_reclaim<stl::ths_list>();
+    test_reclaim<stl::lockfree_list>();
+    test_sequential<hp_list>();
+    test_concurrent<hp_list>();
+    test_reclaim<hp_list>();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
@@ -5,6 +5,7 @@
 
 #include "ths_vector.hh"
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <iostream>
@@ -44,8 +45,152 @@ void reader()
     std::cout << "Pass!\n";
 }
 
+void test_modifiers()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::ths_vector<int> v{1, 2, 3};
+    auto                 old = v.begin();
+
+    v.insert(v.begin(), 0);
+    v.erase(--v.end());
+    v.emplace_back(9);
+    assert(v.size() == 4 && v[0] == 0 && v.back() == 9);
+
+    // 修改之前取得的迭代器仍然看到旧快照
+    assert(*old == 1 && old.index() == 0);
+
+    stl::ths_vector<int> copy = v;
+    v.pop_back();
+    assert(copy.size() == 4 && v.size() == 3 && copy != v);
+
+    copy.swap(v);
+    assert(copy.size() == 3 && v.size() == 4);
+    assert(*v.rbegin() == 9 && *--v.rend() == 0);
+
+    // data()与元素的值在快照被替换、旧快照被回收之后仍然有效
+    auto p     = v.data();
+    int  front = v.front();
+    for (int i = 0; i < 10; ++i)
+        v.push_back(i);
+    v.clear();
+    assert(v.empty() && !copy.empty());
+    assert(p.get()[0] == 0 && p.get()[3] == 9 && front == 0);
+
+    // at越界时按值抛出异常
+    bool thrown = false;
+    try {
+        (void)copy.at(3);
+    }
+    catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown && copy.at(2) == 2);
+
+    // 移动赋值交换两边的快照
+    stl::ths_vector<int> moved(std::move(copy));
+    assert(moved.size() == 3 && moved[0] == 0);
+    v = std::move(moved);
+    assert(v.size() == 3 && v[2] == 2 && moved.empty());
+}
+
+// 写者不断追加元素，读者在任意时刻看到的快照都满足vec[i] == i
+void test_concurrent_snapshot()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::ths_vector<int> v;
+    std::atomic<bool>    done{false};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                int i = 0;
+                for (auto it = v.begin(), end = v.end(); it != end; ++it)
+                    assert(*it == i++);
+            }
+        });
+    }
+    for (int i = 0; i < 2000; ++i)
+        v.push_back(i);
+    done = true;
+    for (auto& r : readers)
+        r.join();
+    assert(v.size() == 2000 && v[1999] == 1999);
+}
+
+// 读操作全部加锁的对照组，与修改之前的ths_vector相同
+struct locked_vector {
+    std::vector<int>   vec;
+    mutable std::mutex mtx;
+
+    int operator[](size_t pos) const
+    {
+        std::lock_guard<std::mutex> guard(mtx);
+        return vec[pos];
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> guard(mtx);
+        return vec.size();
+    }
+};
+
+// 多个读者不断读取size与元素，返回所有读者每毫秒完成的读操作总数
+template <typename Vector> double read_throughput(const Vector& v, int readers)
+{
+    const auto       duration = std::chrono::milliseconds(100);
+    std::atomic<int> ready{0};
+    std::atomic<bool> stop{false};
+    std::atomic<long> total{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; ++t) {
+        threads.emplace_back([&] {
+            long ops = 0, sum = 0;
+            ++ready;
+            while (!stop.load(std::memory_order_relaxed)) {
+                size_t n = v.size();
+                sum += v[ops % n];
+                ops += 2;
+            }
+            total += ops;
+            assert(sum >= 0);
+        });
+    }
+    while (ready.load() != readers)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& t : threads)
+        t.join();
+    return double(total.load()) / duration.count();
+}
+
+void test_read_scaling()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::ths_vector<int> v(1024, 1);
+    locked_vector        locked;
+    locked.vec.assign(1024, 1);
+
+    for (int readers : {1, 2, 4, 8}) {
+        double lock_free = read_throughput(v, readers);
+        double mutex     = read_throughput(locked, readers);
+        printf(
+            "readers %d: snapshot %.0f reads/ms, mutex %.0f reads/ms\n",
+            readers,
+            lock_free,
+            mutex);
+    }
+}
+
 int main()
 {
+    test_modifiers();
+    test_concurrent_snapshot();
+    test_read_scaling();
+
     std::thread writer_thread(writer);
 
     // 创建多个读者线程
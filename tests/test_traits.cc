@@ -10,14 +10,64 @@ struct Item
 {
 };
 
+struct Point
+{
+    int x;
+    double y;
+};
+
+struct Resource
+{
+    int *p;
+
+    Resource() : p(new int(0)) {}
+    Resource(const Resource &other) : p(new int(*other.p)) {}
+    ~Resource()
+    {
+        delete p;
+    }
+};
+
+struct Handle
+{
+    int *p;
+
+    ~Handle() {}
+};
+
+template <>
+struct stl::is_trivially_relocatable<Handle> : std::true_type
+{
+};
+
 void test_self_define_type_traits()
 {
     printf("===========%s===========\n", __FUNCTION__);
-    assert(typeid(stl::type_traits<Item>::has_trivial_default_constructor) == typeid(stl::__false_type));
-    assert(typeid(stl::type_traits<Item>::has_trivial_copy_constructor) == typeid(stl::__false_type));
-    assert(typeid(stl::type_traits<Item>::has_trivial_assignment_operator) == typeid(stl::__false_type));
-    assert(typeid(stl::type_traits<Item>::has_trivial_destructor) == typeid(stl::__false_type));
-    assert(typeid(stl::type_traits<Item>::is_POD_type) == typeid(stl::__false_type));
+    // 简单的结构体由编译器推导为POD
+    assert(typeid(stl::type_traits<Item>::has_trivial_default_constructor) == typeid(stl::__true_type));
+    assert(typeid(stl::type_traits<Item>::has_trivial_copy_constructor) == typeid(stl::__true_type));
+    assert(typeid(stl::type_traits<Item>::has_trivial_assignment_operator) == typeid(stl::__true_type));
+    assert(typeid(stl::type_traits<Item>::has_trivial_destructor) == typeid(stl::__true_type));
+    assert(typeid(stl::type_traits<Item>::is_POD_type) == typeid(stl::__true_type));
+    assert(typeid(stl::type_traits<Point>::is_POD_type) == typeid(stl::__true_type));
+
+    // 自定义了构造、复制与析构函数
+    assert(typeid(stl::type_traits<Resource>::has_trivial_default_constructor) == typeid(stl::__false_type));
+    assert(typeid(stl::type_traits<Resource>::has_trivial_copy_constructor) == typeid(stl::__false_type));
+    assert(typeid(stl::type_traits<Resource>::has_trivial_assignment_operator) == typeid(stl::__true_type));
+    assert(typeid(stl::type_traits<Resource>::has_trivial_destructor) == typeid(stl::__false_type));
+    assert(typeid(stl::type_traits<Resource>::is_POD_type) == typeid(stl::__false_type));
+}
+
+void test_relocatable()
+{
+    printf("===========%s===========\n", __FUNCTION__);
+    assert(typeid(stl::relocatable_type<int>) == typeid(stl::__true_type));
+    assert(typeid(stl::relocatable_type<Point>) == typeid(stl::__true_type));
+    assert(typeid(stl::relocatable_type<Resource>) == typeid(stl::__false_type));
+    // 显式声明可以平凡重定位
+    assert(typeid(stl::type_traits<Handle>::is_POD_type) == typeid(stl::__false_type));
+    assert(typeid(stl::relocatable_type<Handle>) == typeid(stl::__true_type));
 }
 
 template <typename T>
@@ -45,6 +95,7 @@ void test_pointer_type_traits()
 int main()
 {
     test_self_define_type_traits();
+    test_relocatable();
 
     test_basic_type_traits<int>();
     test_basic_type_traits<char>();
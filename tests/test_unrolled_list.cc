@@ -0,0 +1,219 @@
+//
+// Created by rda on 2024/4/13.
+//
+
+/*
+ * 测试stl::unrolled_list
+ * 1. 顺序追加时节点被填满
+ * 2. 在中间插入与删除，节点的分裂与合并
+ * 3. 双向遍历
+ * 4. 复制、移动、交换
+ * 5. 与std::list对比随机的操作序列
+ * */
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <string>
+
+#include "unrolled_list.hh"
+
+template <typename L1, typename L2>
+bool same(const L1 &l, const L2 &r)
+{
+    if (l.size() != r.size())
+        return false;
+    auto ri = r.begin();
+    for (auto li = l.begin(); li != l.end(); ++li, ++ri)
+        if (!(*li == *ri))
+            return false;
+    return true;
+}
+
+void test_density()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::unrolled_list<int, 8> l;
+    assert(l.empty() && l.node_count() == 0 && l.begin() == l.end());
+
+    for (int i = 0; i < 100; ++i)
+        l.push_back(i);
+    assert(l.size() == 100 && l.node_count() == 13);
+    assert(l.front() == 0 && l.back() == 99);
+
+    int expect = 0;
+    for (int v : l)
+        assert(v == expect++);
+
+    // 反向遍历
+    expect = 99;
+    for (auto it = l.rbegin(); it != l.rend(); ++it)
+        assert(*it == expect--);
+    auto it = l.end();
+    for (expect = 99; it != l.begin(); --expect)
+        assert(*--it == expect);
+
+    // 默认容量约为256字节
+    static_assert(stl::unrolled_list<int>::node_capacity() == 64, "");
+    static_assert(stl::unrolled_list<char[200]>::node_capacity() == 4, "");
+}
+
+void test_insert_erase()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::unrolled_list<int, 4> l{0, 1, 2, 3};
+    assert(l.node_count() == 1);
+
+    // 节点已满，分裂为两个节点
+    auto it = l.begin();
+    ++it;
+    it = l.insert(it, 10);
+    assert(*it == 10 && l.node_count() == 2);
+    assert(same(l, std::list<int>{0, 10, 1, 2, 3}));
+
+    // 在节点开头插入时放到前一个节点的空位
+    it = l.end();
+    --it;
+    --it;
+    assert(*it == 2);
+    it = l.emplace(it, 20);
+    assert(*it == 20 && l.node_count() == 2);
+    assert(same(l, std::list<int>{0, 10, 1, 20, 2, 3}));
+
+    l.push_front(-1);
+    assert(l.front() == -1 && same(l, std::list<int>{-1, 0, 10, 1, 20, 2, 3}));
+
+    // 删除返回下一个元素
+    it = l.begin();
+    ++it;
+    ++it;
+    it = l.erase(it);
+    assert(*it == 1);
+    it = l.erase(it, l.end());
+    assert(it == l.end() && same(l, std::list<int>{-1, 0}));
+    assert(l.node_count() == 1);
+
+    l.pop_back();
+    l.pop_front();
+    assert(l.empty() && l.node_count() == 0);
+
+    // 删除使节点变稀疏时与后继合并
+    stl::unrolled_list<int, 8> m;
+    for (int i = 0; i < 16; ++i)
+        m.push_back(i);
+    assert(m.node_count() == 2);
+    for (int i = 0; i < 5; ++i)
+        m.erase(m.begin());
+    assert(m.node_count() == 2);
+    m.erase(m.begin());
+    assert(m.node_count() == 2 && m.size() == 10);
+    auto mit = m.erase(m.begin());
+    assert(m.node_count() == 2 && *mit == 7);
+    // 第一个节点只剩一个元素，且可以容纳后继节点的全部元素
+    mit = m.begin();
+    ++mit;
+    mit = m.erase(mit);
+    assert(m.node_count() == 2 && *mit == 9);
+    for (int i = 0; i < 4; ++i)
+        mit = m.erase(mit);
+    assert(m.node_count() == 1 && *mit == 13 && same(m, std::list<int>{7, 13, 14, 15}));
+}
+
+void test_copy_move()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    stl::unrolled_list<std::string, 4> l;
+    for (int i = 0; i < 50; ++i)
+        l.emplace_back(std::to_string(i));
+
+    stl::unrolled_list<std::string, 4> copy(l);
+    assert(copy == l && copy.node_count() == l.node_count());
+
+    stl::unrolled_list<std::string, 4> moved(std::move(copy));
+    assert(moved == l && copy.empty() && copy.node_count() == 0);
+    copy.push_back("x");
+    assert(copy.size() == 1 && copy.back() == "x");
+
+    stl::swap(copy, moved);
+    assert(copy == l && moved.size() == 1 && moved.front() == "x");
+
+    moved = l;
+    assert(moved == l);
+    moved = {"a", "b"};
+    assert(moved.size() == 2 && moved != l);
+    moved = std::move(copy);
+    assert(moved == l && copy.empty());
+
+    const auto &cl = l;
+    stl::unrolled_list<std::string, 4>::const_iterator cit = cl.begin();
+    assert(*cit == "0" && cit->size() == 1);
+    l.clear();
+    assert(l.empty() && l.node_count() == 0);
+}
+
+void test_random_ops()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+    srand(2024);
+    stl::unrolled_list<std::string, 6> l;
+    std::list<std::string> expect;
+
+    for (int round = 0; round < 20000; ++round)
+    {
+        size_t pos = expect.empty() ? 0 : rand() % (expect.size() + 1);
+        auto it = l.begin();
+        auto eit = expect.begin();
+        for (size_t i = 0; i < pos; ++i, ++it, ++eit)
+            ;
+
+        int op = rand() % 10;
+        if (op < 6 || expect.empty())
+        {
+            std::string s = std::to_string(round);
+            it = l.insert(it, s);
+            eit = expect.insert(eit, s);
+        }
+        else if (pos < expect.size())
+        {
+            it = l.erase(it);
+            eit = expect.erase(eit);
+        }
+        assert(l.size() == expect.size());
+        assert((it == l.end()) == (eit == expect.end()));
+        if (eit != expect.end())
+            assert(*it == *eit);
+
+        // 保持规模有界，使插入与删除交替进行
+        if (expect.size() > 300)
+        {
+            auto first = l.begin();
+            for (int i = 0; i < 100; ++i)
+                ++first;
+            auto efirst = expect.begin();
+            std::advance(efirst, 100);
+            auto last = first;
+            for (int i = 0; i < 150; ++i)
+                ++last;
+            auto elast = efirst;
+            std::advance(elast, 150);
+            l.erase(first, last);
+            expect.erase(efirst, elast);
+        }
+    }
+    assert(same(l, expect));
+    // 合并保证节点不会过于稀疏
+    assert(l.node_count() <= 2 * (l.size() / (l.node_capacity() / 2) + 1));
+}
+
+int main()
+{
+    test_density();
+    test_insert_erase();
+    test_copy_move();
+    test_random_ops();
+
+    std::cout << "Pass!\n";
+
+    return 0;
+}
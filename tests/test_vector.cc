@@ -2,6 +2,10 @@
 #include <algorithm>
 #include <vector>
 #include <cassert>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <sstream>
 #include "type.hh"
 #include "complex.hh"
 #include "string.hh"
@@ -176,6 +180,278 @@ void test_capacity()
     assert(vs1.capacity() == vs1.size() && vs1.size() == 5);
 }
 
+void test_realloc_growth()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    // 内置类型的扩容经过配置器的reallocate，容量跨越第二级与第一级配置器的边界
+    stl::vector<long> vl;
+    for (long i = 0; i < (1 << 20); ++i)
+    {
+        vl.push_back(i);
+        assert(vl.back() == i);
+    }
+    for (long i = 0; i < (1 << 20); ++i)
+        assert(vl[i] == i);
+
+    vl.reserve(vl.capacity() * 3);
+    assert(vl.size() == (1 << 20) && vl[12345] == 12345);
+    vl.shrink_to_fit();
+    assert(vl.capacity() == vl.size() && vl.back() == (1 << 20) - 1);
+
+    // 追加本vector中的元素
+    stl::vector<int> vi{7};
+    for (int i = 0; i < 10; ++i)
+        vi.push_back(std::move(vi[0]));
+    vi.insert(vi.end(), vi.capacity(), vi[0]);
+    assert(size_t(std::count(vi.begin(), vi.end(), 7)) == vi.size());
+    vi.resize(vi.capacity() + 10, vi.back());
+    assert(size_t(std::count(vi.begin(), vi.end(), 7)) == vi.size());
+
+    vi.resize(3);
+    vi.insert(vi.end(), 4, 1);
+    assert(vi.size() == 7 && vi[2] == 7 && vi[3] == 1 && vi[6] == 1);
+
+    stl::vector<double> vd;
+    vd.resize(5000, 2.5);
+    assert(vd.size() == 5000 && vd[4999] == 2.5);
+}
+
+// 统计复制与移动次数的类型，Noexcept决定移动构造是否声明为noexcept
+template <bool Noexcept>
+struct counted
+{
+    static int copies, moves;
+    static int throw_after; // 再复制这么多次之后抛出异常，-1表示从不抛出
+    int value;
+
+    counted(int v = 0) : value(v) {}
+    counted(const counted &other) : value(other.value)
+    {
+        if (throw_after == 0)
+            throw std::runtime_error("copy");
+        if (throw_after > 0)
+            --throw_after;
+        ++copies;
+    }
+    counted(counted &&other) noexcept(Noexcept) : value(other.value)
+    {
+        ++moves;
+    }
+    counted &operator=(const counted &) = default;
+};
+
+template <bool Noexcept>
+int counted<Noexcept>::copies = 0;
+template <bool Noexcept>
+int counted<Noexcept>::moves = 0;
+template <bool Noexcept>
+int counted<Noexcept>::throw_after = -1;
+
+void test_move_growth()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    // 移动构造为noexcept时扩容只移动不复制
+    stl::vector<counted<true>> v1;
+    for (int i = 0; i < 1000; ++i)
+        v1.emplace_back(i);
+    v1.shrink_to_fit();
+    v1.insert(v1.begin() + 10, 3, counted<true>(-1));
+    v1.reserve(5000);
+    assert(counted<true>::copies == 3);
+    assert(counted<true>::moves > 1000);
+    for (int i = 0; i < 10; ++i)
+        assert(v1[i].value == i);
+    assert(v1[10].value == -1 && v1[13].value == 10 && v1.back().value == 999);
+
+    // 移动构造可能抛出异常时扩容改为复制
+    stl::vector<counted<false>> v2;
+    for (int i = 0; i < 100; ++i)
+        v2.emplace_back(i);
+    assert(counted<false>::copies > 100);
+
+    // 复制失败时原有的元素保持不变
+    stl::vector<counted<false>> v3(4, counted<false>(7));
+    v3.shrink_to_fit();
+    counted<false>::throw_after = 2;
+    bool thrown = false;
+    try
+    {
+        v3.push_back(counted<false>(8));
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+    counted<false>::throw_after = -1;
+    assert(thrown && v3.size() == 4 && v3.capacity() == 4);
+    for (auto &c : v3)
+        assert(c.value == 7);
+
+    // 字符串的扩容不再复制内容
+    stl::vector<std::string> vs;
+    for (int i = 0; i < 1000; ++i)
+        vs.push_back(std::string(100, char('a' + i % 26)));
+    for (int i = 0; i < 1000; ++i)
+        assert(vs[i].size() == 100 && vs[i][0] == char('a' + i % 26));
+}
+
+// 只持有一个堆指针的消息，不能平凡复制，但可以按字节搬到新的位置
+struct message
+{
+    static int moves, live;
+    int *payload;
+
+    message(int v = 0) : payload(new int(v))
+    {
+        ++live;
+    }
+    message(const message &other) : payload(new int(*other.payload))
+    {
+        ++live;
+    }
+    message(message &&other) noexcept : payload(other.payload)
+    {
+        other.payload = nullptr;
+        ++moves;
+        ++live;
+    }
+    message &operator=(const message &other)
+    {
+        *payload = *other.payload;
+        return *this;
+    }
+    ~message()
+    {
+        delete payload;
+        --live;
+    }
+};
+
+int message::moves = 0;
+int message::live = 0;
+
+template <>
+struct stl::is_trivially_relocatable<message> : std::true_type
+{
+};
+
+void test_relocatable_growth()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    struct plain
+    {
+        int a;
+        double b;
+    };
+    static_assert(std::is_same<stl::relocatable_type<plain>, stl::__true_type>::value, "");
+    stl::vector<plain> vp;
+    for (int i = 0; i < 1000; ++i)
+        vp.push_back(plain{i, i * 0.5});
+    assert(vp[999].a == 999 && vp[999].b == 499.5);
+
+    // 扩容时按字节搬移，不调用移动构造与析构函数
+    {
+        stl::vector<message> v;
+        for (int i = 0; i < 1000; ++i)
+            v.emplace_back(i);
+        v.insert(v.begin() + 1, message(-1));
+        message::moves = 0;
+        v.reserve(5000);
+        v.shrink_to_fit();
+        v.resize(3000);
+        assert(message::moves == 0);
+        assert(message::live == 3000);
+        for (int i = 1; i < 1000; ++i)
+            assert(*v[i + 1].payload == i);
+        assert(*v[1].payload == -1 && *v[2999].payload == 0);
+    }
+    assert(message::live == 0);
+}
+
+void test_growth_policy()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    // 每次扩容后的容量
+    stl::vector<int> v2;
+    stl::vector<int, stl::alloc, stl::half_growth> v15;
+    stl::vector<int, stl::alloc, stl::fixed_growth<100>> vf;
+    size_t cap2 = 0, cap15 = 0, capf = 0, grows2 = 0, grows15 = 0, growsf = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        v2.push_back(i);
+        v15.push_back(i);
+        vf.push_back(i);
+        if (v2.capacity() != cap2)
+        {
+            assert(!cap2 || v2.capacity() == 2 * cap2);
+            cap2 = v2.capacity();
+            ++grows2;
+        }
+        if (v15.capacity() != cap15)
+        {
+            assert(cap15 < 2 || v15.capacity() == cap15 + cap15 / 2);
+            cap15 = v15.capacity();
+            ++grows15;
+        }
+        if (vf.capacity() != capf)
+        {
+            assert(vf.capacity() == capf + 100);
+            capf = vf.capacity();
+            ++growsf;
+        }
+    }
+    assert(grows2 < grows15 && growsf == 10);
+    assert(v15[999] == 999 && vf[999] == 999);
+
+    // 一次插入的元素多于扩容的增量时按需扩容
+    vf.insert(vf.begin(), 500, -1);
+    assert(vf.size() == 1500 && vf.capacity() == 1500 && vf[499] == -1 && vf[500] == 0);
+}
+
+void test_bulk_append()
+{
+    printf("=============%s=================\n", __FUNCTION__);
+
+    // 前向迭代器只扩容一次
+    std::list<int> l{1, 2, 3, 4, 5};
+    stl::vector<int, stl::alloc, stl::fixed_growth<1>> v{0};
+    v.append_range(l.begin(), l.end());
+    assert(v.size() == 6 && v.capacity() == 6 && v[5] == 5);
+    v.insert_range(v.begin() + 1, l.begin(), l.end());
+    assert(v.size() == 11 && v.capacity() == 11 && v[1] == 1 && v[5] == 5 && v[6] == 1);
+
+    // 输入迭代器只能遍历一次
+    std::istringstream in1("10 20 30 40");
+    stl::vector<int> vi(std::istream_iterator<int>(in1), std::istream_iterator<int>{});
+    assert(vi.size() == 4 && vi[3] == 40);
+    std::istringstream in2("1 2 3");
+    auto it = vi.insert_range(vi.begin() + 1, std::istream_iterator<int>(in2), std::istream_iterator<int>{});
+    assert(it == vi.begin() + 1 && vi.size() == 7);
+    const int expected[] = {10, 1, 2, 3, 20, 30, 40};
+    for (int i = 0; i < 7; ++i)
+        assert(vi[i] == expected[i]);
+    std::istringstream in3("50 60");
+    vi.append_range(std::istream_iterator<int>(in3), std::istream_iterator<int>{});
+    assert(vi.size() == 9 && vi.back() == 60);
+
+    // 不初始化新增的元素，直接写入data()
+    stl::vector<char> buf;
+    const char msg[] = "hello, world";
+    buf.resize_uninitialized(sizeof(msg));
+    memcpy(buf.data(), msg, sizeof(msg));
+    assert(buf.size() == sizeof(msg) && !strcmp(buf.data(), msg));
+    size_t old_size = buf.size();
+    buf.resize_uninitialized(old_size + 3);
+    memcpy(buf.data() + old_size - 1, "!!!", 4);
+    assert(!strcmp(buf.data(), "hello, world!!!"));
+    buf.resize_uninitialized(5);
+    assert(buf.size() == 5 && buf[4] == 'o');
+}
+
 void test_modifiers_built_in_types()
 {
     printf("=============%s=================\n", __FUNCTION__);
@@ -411,6 +687,11 @@ int main()
     test_constructors();
     test_assignment();
     test_capacity();
+    test_realloc_growth();
+    test_move_growth();
+    test_relocatable_growth();
+    test_growth_policy();
+    test_bulk_append();
     test_modifiers_built_in_types();
     test_modifiers_complex();
     test_modifiers_string();